@@ -0,0 +1,132 @@
+#
+# @module thread
+#
+# This module allows running Blade code on several operating system threads
+# within the same process. Each thread runs in its own isolated virtual machine
+# with its own heap and globals, so threads never share objects. They talk to
+# each other by sending values over channels.
+#
+# A thread can be started from a file or from a function. A function must be
+# declared at the top level of its module because the new thread loads that
+# module again before calling it. Code at the top level of the module runs in
+# the new thread too, so it should be guarded with `thread.is_main` when it
+# should only run once.
+#
+# Values sent to a thread or over a channel are copied. Nil, booleans, numbers,
+# strings, bytes, lists, dictionaries and channels can be sent.
+#
+# Example Usage:
+#
+# ```blade
+# import thread
+#
+# def square(jobs, results) {
+#   var job
+#   while (job = jobs.receive()) != nil {
+#     results.send(job * job)
+#   }
+# }
+#
+# if thread.is_main {
+#   var jobs = thread.Channel(), results = thread.Channel()
+#   var worker = thread.Thread(square, jobs, results)
+#   worker.start()
+#
+#   for i in 1..4 jobs.send(i)
+#   jobs.close()
+#
+#   for i in 1..4 echo results.receive()
+#   worker.join()
+# }
+# ```
+#
+# Output:
+#
+# ```sh
+# 1
+# 4
+# 9
+# ```
+#
+# @copyright 2022, Ore Richard Muyiwa and Blade contributors
+#
+
+import _thread
+
+/**
+ * `true` in the main thread of the program and `false` in threads started
+ * by it.
+ * @type boolean
+ */
+var is_main = _thread.is_main
+
+/**
+ * The list of values a thread was started with. It is empty in the main
+ * thread.
+ * @type list
+ */
+var args = _thread.args
+
+
+/**
+ * class Channel is a queue of values that can be shared between threads.
+ *
+ * - `send(value)` copies the value into the channel.
+ * - `receive()` waits for the next value and returns it, or returns `nil`
+ *   once the channel is closed and empty.
+ * - `close()` closes the channel. Sending on a closed channel raises an
+ *   exception.
+ */
+var Channel = _thread.Channel
+
+
+/**
+ * This class runs a file or function in a new thread.
+ */
+class Thread {
+  var _target
+  var _args
+  var _ptr
+
+  /**
+   * Thread(target: string | function, ...)
+   *
+   * Creates a new thread that runs the file at the path _`target`_ or calls
+   * the function _`target`_. Any other arguments are copied into the thread.
+   * A function is called with them while a file can read them from
+   * `thread.args`.
+   * @constructor
+   */
+  Thread(target, ...) {
+    if !is_string(target) and !is_function(target)
+      die Exception('string or function expected in argument 1 (target)')
+
+    self._target = target
+    self._args = __args__
+  }
+
+  /**
+   * start()
+   *
+   * Starts the thread.
+   */
+  start() {
+    if self._ptr
+      die Exception('thread already started')
+    self._ptr = _thread.start(self._target, self._args)
+  }
+
+  /**
+   * join()
+   *
+   * Waits for the thread to finish and returns `true` if it ran without
+   * errors or `false` otherwise.
+   *
+   * @return boolean
+   */
+  join() {
+    if !self._ptr
+      die Exception('thread not started')
+    return _thread.join(self._ptr)
+  }
+}
@@ -170,6 +170,16 @@ def file(value) {
   return is_file(value)
 }
 
+/**
+ * fiber(value: any)
+ *
+ * returns true if the value is a fiber or false otherwise
+ * @return bool
+ */
+def fiber(value) {
+  return is_fiber(value)
+}
+
 /**
  * iterable(value: any)
  *
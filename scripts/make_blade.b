@@ -38,6 +38,7 @@ var header_list = [
   'value',
   'table',  
   'object', 
+  'arena',
   'vm',
   'memory',
   'native',
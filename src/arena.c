@@ -0,0 +1,204 @@
+#include "arena.h"
+#include "memory.h"
+#include "object.h"
+#include "vm.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SANITIZE_ADDRESS__)
+#define ARENA_ASAN 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define ARENA_ASAN 1
+#endif
+#endif
+
+#ifdef ARENA_ASAN
+#include <sanitizer/asan_interface.h>
+// free slots stay poisoned so that dangling pointers into a page are
+// caught the same as ones into freed memory.
+#define POISON_SLOT(slot, size) ASAN_POISON_MEMORY_REGION(slot, size)
+#define UNPOISON_SLOT(slot, size) ASAN_UNPOISON_MEMORY_REGION(slot, size)
+#else
+#define POISON_SLOT(slot, size) ((void) 0)
+#define UNPOISON_SLOT(slot, size) ((void) 0)
+#endif
+
+// slots start at the first granule after the page header.
+#define ARENA_FIRST_SLOT                                                       \
+  ((sizeof(b_arena_page) + ARENA_GRANULE - 1) / ARENA_GRANULE * ARENA_GRANULE)
+
+#define FOR_EACH_SLOT(page, slot)                                              \
+  for (char *slot = (char *) (page) + ARENA_FIRST_SLOT;                        \
+       slot + (page)->slot_size <= (char *) (page) + ARENA_PAGE_SIZE;          \
+       slot += (page)->slot_size)
+
+void init_arena(b_arena *arena) {
+  memset(arena, 0, sizeof(b_arena));
+}
+
+static b_arena_page *allocate_page() {
+  void *page = NULL;
+#ifdef _WIN32
+  page = _aligned_malloc(ARENA_PAGE_SIZE, ARENA_PAGE_SIZE);
+#else
+  if (posix_memalign(&page, ARENA_PAGE_SIZE, ARENA_PAGE_SIZE) != 0) {
+    page = NULL;
+  }
+#endif
+
+  // just in case allocation fails... computers ain't infinite!
+  if (page == NULL) {
+    fflush(stdout); // flush out anything on stdout first
+    fprintf(stderr, "Exit: device out of memory\n");
+    exit(EXIT_TERMINAL);
+  }
+  return (b_arena_page *) page;
+}
+
+static void free_page(b_arena_page *page) {
+#ifdef _WIN32
+  _aligned_free(page);
+#else
+  free(page);
+#endif
+}
+
+static void push_slot(b_arena_class *klass, void *pointer, size_t size) {
+  b_arena_slot *slot = (b_arena_slot *) pointer;
+  slot->next = klass->free;
+  klass->free = slot;
+  POISON_SLOT(slot, size);
+}
+
+static void add_page(b_arena_class *klass, size_t slot_size) {
+  b_arena_page *page = allocate_page();
+  memset(page, 0, ARENA_FIRST_SLOT);
+  page->slot_size = slot_size;
+
+  // new pages go in front of the sweep cursor. they have nothing to sweep.
+  page->next = klass->pages;
+  klass->pages = page;
+
+  // pushed from the back so that slots are handed out in address order.
+  size_t count = (ARENA_PAGE_SIZE - ARENA_FIRST_SLOT) / slot_size;
+  for (size_t i = count; i > 0; i--) {
+    push_slot(klass, (char *) page + ARENA_FIRST_SLOT + (i - 1) * slot_size, slot_size);
+  }
+}
+
+// frees the old objects of the page the last marking did not reach. young
+// ones were allocated after it and are left to the minor collections.
+static void sweep_page(b_vm *vm, b_arena_page *page) {
+  // module unloaders run while objects are freed and may allocate.
+  bool busy = vm->gc_busy;
+  vm->gc_busy = true;
+
+  FOR_EACH_SLOT(page, slot) {
+    b_obj *object = (b_obj *) slot;
+    if (!arena_get_bit(page->allocated, object) || !object->old || object->stale
+        || arena_get_bit(page->marks, object) == vm->arena.live_color) {
+      continue;
+    }
+
+    vm->arena.garbage = vm->arena.garbage > page->slot_size
+        ? vm->arena.garbage - page->slot_size : 0;
+    free_object(vm, object);
+  }
+
+  vm->gc_busy = busy;
+}
+
+b_obj *arena_allocate(b_vm *vm, size_t size) {
+  int index = (int) ((size - 1) / ARENA_GRANULE);
+  size_t slot_size = (size_t) (index + 1) * ARENA_GRANULE;
+  b_arena_class *klass = &vm->arena.classes[index];
+
+  vm->bytes_allocated += slot_size;
+  collect_if_needed(vm);
+
+  while (klass->free == NULL) {
+    if (klass->sweep_cursor != NULL) {
+      b_arena_page *page = klass->sweep_cursor;
+      klass->sweep_cursor = page->next;
+      sweep_page(vm, page);
+    } else {
+      add_page(klass, slot_size);
+    }
+  }
+
+  b_arena_slot *slot = klass->free;
+  UNPOISON_SLOT(slot, slot_size);
+  klass->free = slot->next;
+
+  arena_set_bit(ARENA_PAGE(slot)->allocated, slot, true);
+  vm->arena.bytes += slot_size;
+  return (b_obj *) slot;
+}
+
+void arena_release(b_vm *vm, b_obj *object) {
+  b_arena_page *page = ARENA_PAGE(object);
+  arena_set_bit(page->allocated, object, false);
+  vm->bytes_allocated -= page->slot_size;
+  vm->arena.bytes -= page->slot_size;
+  push_slot(&vm->arena.classes[page->slot_size / ARENA_GRANULE - 1], object, page->slot_size);
+}
+
+b_obj *arena_allocate_large(b_vm *vm, size_t size) {
+  b_large_link *link = (b_large_link *) reallocate(vm, NULL, 0, sizeof(b_large_link) + size);
+  link->next = NULL;
+  return (b_obj *) (link + 1);
+}
+
+void arena_release_large(b_vm *vm, b_obj *object, size_t size) {
+  reallocate(vm, (b_large_link *) object - 1, sizeof(b_large_link) + size, 0);
+}
+
+void arena_start_sweeping(b_vm *vm) {
+  b_arena *arena = &vm->arena;
+  for (int i = 0; i < ARENA_CLASSES; i++) {
+    arena->classes[i].sweep_cursor = arena->classes[i].pages;
+  }
+  arena->live_color = vm->mark_value;
+  arena->garbage = arena->bytes > arena->marked ? arena->bytes - arena->marked : 0;
+  arena->marked = 0;
+}
+
+void arena_finish_sweeping(b_vm *vm) {
+  for (int i = 0; i < ARENA_CLASSES; i++) {
+    b_arena_class *klass = &vm->arena.classes[i];
+    while (klass->sweep_cursor != NULL) {
+      b_arena_page *page = klass->sweep_cursor;
+      klass->sweep_cursor = page->next;
+      sweep_page(vm, page);
+    }
+  }
+  vm->arena.garbage = 0;
+  vm->arena.marked = 0;
+}
+
+void free_arena(b_vm *vm) {
+  // every object is freed before any page goes, since freeing one may
+  // still allocate.
+  for (int i = 0; i < ARENA_CLASSES; i++) {
+    for (b_arena_page *page = vm->arena.classes[i].pages; page != NULL; page = page->next) {
+      FOR_EACH_SLOT(page, slot) {
+        if (arena_get_bit(page->allocated, slot)) {
+          free_object(vm, (b_obj *) slot);
+        }
+      }
+    }
+  }
+
+  for (int i = 0; i < ARENA_CLASSES; i++) {
+    b_arena_page *page = vm->arena.classes[i].pages;
+    while (page != NULL) {
+      b_arena_page *next = page->next;
+      free_page(page);
+      page = next;
+    }
+  }
+  init_arena(&vm->arena);
+}
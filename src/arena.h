@@ -0,0 +1,91 @@
+#ifndef BLADE_ARENA_H
+#define BLADE_ARENA_H
+
+#include "common.h"
+#include "config.h"
+#include "value.h"
+
+// size classes are ARENA_GRANULE bytes apart and a page only ever holds
+// objects of one class.
+#define ARENA_GRANULE 16
+#define ARENA_CLASSES (ARENA_MAX_SIZE / ARENA_GRANULE)
+// one bit for every granule of a page.
+#define ARENA_BITMAP_WORDS (ARENA_PAGE_SIZE / ARENA_GRANULE / 64)
+
+typedef struct s_arena_page {
+  struct s_arena_page *next;
+  size_t slot_size;
+  uint64_t marks[ARENA_BITMAP_WORDS];
+  uint64_t allocated[ARENA_BITMAP_WORDS];
+} b_arena_page;
+
+typedef struct s_arena_slot {
+  struct s_arena_slot *next;
+} b_arena_slot;
+
+typedef struct {
+  b_arena_page *pages;
+  // pages from here on still hold the garbage of the last collection.
+  b_arena_page *sweep_cursor;
+  b_arena_slot *free;
+} b_arena_class;
+
+typedef struct {
+  b_arena_class classes[ARENA_CLASSES];
+  size_t bytes; // held by arena objects, swept or not
+  size_t marked; // reached by the running collection
+  size_t garbage; // not reached by the last collection and not swept yet
+  bool live_color; // the mark the last collection left on what it reached
+} b_arena;
+
+// objects too big for the arena get an allocation of their own, which
+// starts with the link that keeps them on the list of the old generation.
+typedef struct {
+  b_obj *next;
+} b_large_link;
+
+#define LARGE_NEXT(object) (((b_large_link *) (object) - 1)->next)
+
+// pages are aligned to their size, so an object finds the header of its
+// page by masking its address.
+#define ARENA_PAGE(object)                                                     \
+  ((b_arena_page *) ((uintptr_t) (object) & ~((uintptr_t) ARENA_PAGE_SIZE - 1)))
+#define ARENA_BIT(object)                                                      \
+  (((uintptr_t) (object) & ((uintptr_t) ARENA_PAGE_SIZE - 1)) / ARENA_GRANULE)
+
+static inline bool arena_get_bit(const uint64_t *bits, const void *object) {
+  uintptr_t bit = ARENA_BIT(object);
+  return (bits[bit / 64] >> (bit % 64)) & 1;
+}
+
+static inline void arena_set_bit(uint64_t *bits, const void *object, bool value) {
+  uintptr_t bit = ARENA_BIT(object);
+  if (value) {
+    bits[bit / 64] |= (uint64_t) 1 << (bit % 64);
+  } else {
+    bits[bit / 64] &= ~((uint64_t) 1 << (bit % 64));
+  }
+}
+
+void init_arena(b_arena *arena);
+
+// takes a slot of at least size bytes, sweeping the next page of its class
+// when no swept slot is left.
+b_obj *arena_allocate(b_vm *vm, size_t size);
+
+void arena_release(b_vm *vm, b_obj *object);
+
+b_obj *arena_allocate_large(b_vm *vm, size_t size);
+
+void arena_release_large(b_vm *vm, b_obj *object, size_t size);
+
+// called once a collection finished marking. the old objects of every page
+// it did not reach are freed as the page comes up for allocation.
+void arena_start_sweeping(b_vm *vm);
+
+// sweeps what is left before the next collection marks over it.
+void arena_finish_sweeping(b_vm *vm);
+
+void free_arena(b_vm *vm);
+
+#endif
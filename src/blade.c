@@ -222,15 +222,25 @@ static void run_code(b_vm *vm, char *source) {
 
 void show_usage(char *argv[], bool fail) {
   FILE *out = fail ? stderr : stdout;
-  fprintf(out, "Usage: %s [-[h | c | d | e | v | g | w]] [filename]\n", argv[0]);
+  fprintf(out, "Usage: %s [-[h | c | d | e | O | r | j | v | g | i | t | w]] [filename]\n", argv[0]);
   fprintf(out, "   -h       Show this help message.\n");
   fprintf(out, "   -v       Show version string.\n");
   fprintf(out, "   -b arg   Buffer terminal outputs with the given size.\n");
   fprintf(out, "   -d       Print bytecode.\n");
   fprintf(out, "   -e       Print bytecode and exit.\n");
+  fprintf(out, "   -O       Optimize bytecode before running it.\n");
+  fprintf(out, "   -r       Run arithmetic on locals as register instructions.\n");
+  fprintf(out, "   -j, --jit\n"
+               "            Compile hot functions to native code (x86-64 Linux only).\n");
   fprintf(out, "   -g arg   Sets the minimum heap size in kilobytes before the GC\n"
                "            can start. [Default = %d (%dmb)]\n", DEFAULT_GC_START / 1024,
           DEFAULT_GC_START / (1024 * 1024));
+  fprintf(out, "   -i arg   Sets how many objects the GC marks or sweeps per allocation\n"
+               "            while collecting, 0 to collect all at once. [Default = %d]\n",
+          GC_STEP_BUDGET);
+  fprintf(out, "   -t arg   Sets how many threads mark the heap while the GC pauses the\n"
+               "            program. Also read from $%s. [Default = %d]\n",
+          BLADE_GC_THREADS_ENV, GC_THREADS);
   fprintf(out, "   -c arg   Runs the give code.\n");
   fprintf(out, "   -w       Show runtime warnings.\n");
   exit(fail ? EXIT_FAILURE : EXIT_SUCCESS);
@@ -240,14 +250,36 @@ int main(int argc, char *argv[]) {
 
   bool show_warnings = false;
   bool should_print_bytecode = false;
+  bool should_optimize = false;
+  bool should_use_registers = false;
+  bool should_jit = false;
   long stdout_buffer_size = 0L;
   bool should_exit_after_bytecode = false;
   char *source = NULL;
   int next_gc_start = DEFAULT_GC_START;
+  int gc_step_budget = GC_STEP_BUDGET;
+  int gc_threads = GC_THREADS;
+
+  // the flag wins over the environment.
+  char *gc_threads_env = getenv(BLADE_GC_THREADS_ENV);
+  if (gc_threads_env != NULL) {
+    gc_threads = (int) strtol(gc_threads_env, NULL, 10);
+  }
+
+  // getopt has no long options, so --jit is taken out of the options
+  // before it runs.
+  for (int i = 1; i < argc && argv[i][0] == '-'; i++) {
+    if (strcmp(argv[i], "--jit") == 0) {
+      should_jit = true;
+      memmove(&argv[i], &argv[i + 1], sizeof(char *) * (argc - i));
+      argc--;
+      break;
+    }
+  }
 
   if (argc > 1) {
     int opt;
-    while ((opt = getopt(argc, argv, "hdeb:vg:wc:--")) != -1) {
+    while ((opt = getopt(argc, argv, "hdeOrjb:vg:i:t:wc:--")) != -1) {
       switch (opt) {
         case 'h':
           show_usage(argv, false); // exits
@@ -258,6 +290,15 @@ int main(int argc, char *argv[]) {
           should_print_bytecode = true;
           should_exit_after_bytecode = true;
           break;
+        case 'O':
+          should_optimize = true;
+          break;
+        case 'r':
+          should_use_registers = true;
+          break;
+        case 'j':
+          should_jit = true;
+          break;
         case 'b':
           stdout_buffer_size = strtol(optarg, NULL, 10);
           if (stdout_buffer_size < 0) {
@@ -275,6 +316,17 @@ int main(int argc, char *argv[]) {
           }
           break;
         }
+        case 'i': {
+          int budget = (int) strtol(optarg, NULL, 10);
+          if (budget >= 0) {
+            gc_step_budget = budget;
+          }
+          break;
+        }
+        case 't': {
+          gc_threads = (int) strtol(optarg, NULL, 10);
+          break;
+        }
         case 'c': {
           source = optarg;
           break;
@@ -298,7 +350,12 @@ int main(int argc, char *argv[]) {
     vm->show_warnings = show_warnings;
     vm->should_print_bytecode = should_print_bytecode;
     vm->should_exit_after_bytecode = should_exit_after_bytecode;
+    vm->should_optimize = should_optimize;
+    vm->should_use_registers = should_use_registers;
+    vm->should_jit = should_jit;
     vm->next_gc = next_gc_start;
+    vm->gc_step_budget = gc_step_budget;
+    vm->gc_threads = gc_threads < 1 ? 1 : gc_threads > GC_MAX_THREADS ? GC_MAX_THREADS : gc_threads;
 
     if (stdout_buffer_size) {
       // forcing printf buffering for TTYs and terminals
@@ -10,6 +10,12 @@ void init_blob(b_blob *blob) {
   blob->code = NULL;
   blob->lines = NULL;
   init_value_arr(&blob->constants);
+  blob->cache_count = 0;
+  blob->cache_capacity = 0;
+  blob->caches = NULL;
+  blob->handler_count = 0;
+  blob->handler_capacity = 0;
+  blob->handlers = NULL;
 }
 
 void write_blob(b_vm *vm, b_blob *blob, uint8_t byte, int line) {
@@ -32,6 +38,12 @@ void free_blob(b_vm *vm, b_blob *blob) {
   if (blob->lines != NULL) {
     FREE_ARRAY(int, blob->lines, blob->capacity);
   }
+  if (blob->caches != NULL) {
+    FREE_ARRAY(b_inline_cache, blob->caches, blob->cache_capacity);
+  }
+  if (blob->handlers != NULL) {
+    FREE_ARRAY(b_handler, blob->handlers, blob->handler_capacity);
+  }
   free_value_arr(vm, &blob->constants);
   init_blob(blob);
 }
@@ -42,3 +54,24 @@ int add_constant(b_vm *vm, b_blob *blob, b_value value) {
   pop(vm); // fixing gc corruption
   return blob->constants.count - 1;
 }
+
+int add_inline_cache(b_vm *vm, b_blob *blob) {
+  if (blob->cache_capacity < blob->cache_count + 1) {
+    int old_capacity = blob->cache_capacity;
+    blob->cache_capacity = GROW_CAPACITY(old_capacity);
+    blob->caches = GROW_ARRAY(b_inline_cache, blob->caches, old_capacity, blob->cache_capacity);
+  }
+
+  blob->caches[blob->cache_count].count = 0;
+  return blob->cache_count++;
+}
+
+void add_handler(b_vm *vm, b_blob *blob, b_handler handler) {
+  if (blob->handler_capacity < blob->handler_count + 1) {
+    int old_capacity = blob->handler_capacity;
+    blob->handler_capacity = GROW_CAPACITY(old_capacity);
+    blob->handlers = GROW_ARRAY(b_handler, blob->handlers, old_capacity, blob->handler_capacity);
+  }
+
+  blob->handlers[blob->handler_count++] = handler;
+}
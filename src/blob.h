@@ -57,6 +57,7 @@ typedef enum {
 
   OP_CLOSURE,
   OP_CALL,
+  OP_TAIL_CALL,
   OP_INVOKE,
   OP_INVOKE_SELF,
   OP_RETURN,
@@ -85,25 +86,101 @@ typedef enum {
   OP_EJECT_NATIVE_IMPORT,
   OP_IMPORT_ALL,
 
-  OP_TRY,
-  OP_POP_TRY,
   OP_PUBLISH_TRY,
 
   OP_STRINGIFY,
   OP_SWITCH,
   OP_CHOICE,
+  OP_ITER_PREP,
+  OP_ITER_NEXT,
+  OP_GET_ARGS,    // __args__, turned into a list the first time
+  OP_ARGS_LENGTH, // __args__.length() without a list
+
+  // quickened instructions. the vm rewrites the generic instruction into
+  // these after seeing its operand types and back when the guard fails.
+  // they are never emitted by the compiler.
+  OP_ADD_NUM,
+  OP_SUBTRACT_NUM,
+  OP_MULTIPLY_NUM,
+  OP_DIVIDE_NUM,
+  OP_GREATER_NUM,
+  OP_LESS_NUM,
+
+  // superinstructions. the optimizer fuses common instruction sequences
+  // into these when running with -O.
+  OP_GET_LOCALS,         // get_local, get_local
+  OP_GET_LOCAL_CONSTANT, // get_local, constant
+  OP_SET_LOCAL_POP,      // set_local, pop
+  OP_POP_JUMP_IF_FALSE,  // jump_if_false, pop
+  OP_LESS_JUMP,          // less, jump_if_false, pop
+  OP_GREATER_JUMP,       // greater, jump_if_false, pop
+  OP_INVOKE_LOCAL,       // get_local, invoke
+
+  // register instructions. with -r, statements that only read and write
+  // locals and constants are run by one of these addressing the frame
+  // slots directly. each is followed by the stack instructions it stands
+  // for, which it skips while its operands are numbers and falls back to
+  // otherwise.
+  OP_REG_MOVE,           // dst, src, skip
+  OP_REG_ADD,            // dst, a, b, skip
+  OP_REG_SUBTRACT,       // dst, a, b, skip
+  OP_REG_MULTIPLY,       // dst, a, b, skip
+  OP_REG_DIVIDE,         // dst, a, b, skip
+  OP_REG_LESS_JUMP,      // a, b, skip, jump
+  OP_REG_GREATER_JUMP,   // a, b, skip, jump
 
   // the break placeholder... it never gets to the vm
   // care should be taken to
   OP_BREAK_PL,
 } b_code;
 
+// a register operand with this bit set is a constant rather than a slot.
+#define REG_CONSTANT 0x8000
+// a destination register that pushes the result onto the stack instead.
+#define REG_PUSH 0xffff
+
+// number of receiver classes a single call site remembers
+// before it starts recycling entries.
+#define INLINE_CACHE_SIZE 4
+
+typedef struct {
+  struct b_obj_class *klass; // NULL for methods of the built-in types
+  struct b_shape *shape; // receiver shape or NULL for class-only lookups
+  uint32_t version;
+  int slot; // field slot in the instance, -1 for methods or the object type for built-ins
+  b_value value;
+} b_cache_entry;
+
+typedef struct {
+  int count;
+  b_cache_entry entries[INLINE_CACHE_SIZE];
+} b_inline_cache;
+
+// a try block. the vm only looks at these once something is thrown, so
+// entering and leaving a try costs nothing.
+typedef struct {
+  int start;           // offset of the first instruction in the try body
+  int end;             // offset just past the try body
+  int locals;          // stack slots used by locals when the try starts
+  int type;            // constant holding the name of the class caught
+  int address;         // catch block or 0 if there is none
+  int finally_address; // finally block or 0 if there is none
+} b_handler;
+
 typedef struct {
   int count;
   int capacity;
   uint8_t *code;
   int *lines;
   b_value_arr constants;
+  int cache_count;
+  int cache_capacity;
+  b_inline_cache *caches;
+
+  // inner try blocks always come before the ones around them.
+  int handler_count;
+  int handler_capacity;
+  b_handler *handlers;
 } b_blob;
 
 void init_blob(b_blob *blob);
@@ -114,4 +191,8 @@ void write_blob(b_vm *vm, b_blob *blob, uint8_t byte, int line);
 
 int add_constant(b_vm *vm, b_blob *blob, b_value value);
 
+int add_inline_cache(b_vm *vm, b_blob *blob);
+
+void add_handler(b_vm *vm, b_blob *blob, b_handler handler);
+
 #endif
\ No newline at end of file
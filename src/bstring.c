@@ -125,7 +125,7 @@ char *remove_regex_delimiter(b_vm *vm, b_obj_string *string) {
 DECLARE_STRING_METHOD(length) {
   ENFORCE_ARG_COUNT(length, 0);
   b_obj_string* string = AS_STRING(METHOD_OBJECT);
-  RETURN_NUMBER(string->is_ascii ? string->length : string->utf8_length);
+  RETURN_LONG(string->is_ascii ? string->length : string->utf8_length);
 }
 
 DECLARE_STRING_METHOD(upper) {
@@ -28,7 +28,7 @@ DECLARE_NATIVE(bytes) {
 
 DECLARE_BYTES_METHOD(length) {
   ENFORCE_ARG_COUNT(length, 0);
-  RETURN_NUMBER(AS_BYTES(METHOD_OBJECT)->bytes.count);
+  RETURN_LONG(AS_BYTES(METHOD_OBJECT)->bytes.count);
 }
 
 DECLARE_BYTES_METHOD(append) {
@@ -37,6 +37,13 @@
 #include "config.h"
 #include "bendian.h"
 
+// computed goto (labels as values) is a GNU extension also supported by clang.
+#if defined(__GNUC__) || defined(__clang__)
+#define USE_COMPUTED_GOTO 1
+#else
+#define USE_COMPUTED_GOTO 0
+#endif
+
 // --> debug mode options starts here...
 #if DEBUG_MODE == 1
 
@@ -50,7 +57,6 @@
 
 #define UINT8_COUNT (UINT8_MAX + 1)
 #define UINT16_COUNT (UINT16_MAX + 1)
-#define STACK_MAX (FRAMES_MAX * UINT8_COUNT)
 
 #if defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
 #define IS_UNIX
@@ -3,6 +3,7 @@
 #include "config.h"
 #include "memory.h"
 #include "object.h"
+#include "optimizer.h"
 #include "pathinfo.h"
 #include "scanner.h"
 #include "utf8.h"
@@ -138,8 +139,7 @@ static void ignore_whitespace(b_parser *p) {
   while (match(p, NEWLINE_TOKEN));
 }
 
-static int get_code_args_count(const uint8_t *bytecode,
-                               const b_value *constants, int ip) {
+int get_code_args_count(const uint8_t *bytecode, const b_value *constants, int ip) {
   b_code code = (b_code) bytecode[ip];
 
   switch (code) {
@@ -175,27 +175,33 @@ static int get_code_args_count(const uint8_t *bytecode,
     case OP_SET_INDEX:
     case OP_ASSERT:
     case OP_DIE:
-    case OP_POP_TRY:
     case OP_RANGE:
     case OP_STRINGIFY:
     case OP_CHOICE:
+    case OP_ADD_NUM:
+    case OP_SUBTRACT_NUM:
+    case OP_MULTIPLY_NUM:
+    case OP_DIVIDE_NUM:
+    case OP_GREATER_NUM:
+    case OP_LESS_NUM:
     case OP_EMPTY:
     case OP_IMPORT_ALL_NATIVE:
     case OP_IMPORT_ALL:
     case OP_PUBLISH_TRY:
+    case OP_ITER_PREP:
       return 0;
 
     case OP_CALL:
+    case OP_TAIL_CALL:
     case OP_SUPER_INVOKE_SELF:
     case OP_GET_INDEX:
     case OP_GET_RANGED_INDEX:
       return 1;
 
-    case OP_DEFINE_GLOBAL:
-    case OP_GET_GLOBAL:
-    case OP_SET_GLOBAL:
     case OP_GET_LOCAL:
     case OP_SET_LOCAL:
+    case OP_GET_ARGS:
+    case OP_ARGS_LENGTH:
     case OP_GET_UP_VALUE:
     case OP_SET_UP_VALUE:
     case OP_JUMP_IF_FALSE:
@@ -205,8 +211,6 @@ static int get_code_args_count(const uint8_t *bytecode,
     case OP_CONSTANT:
     case OP_POP_N:
     case OP_CLASS:
-    case OP_GET_PROPERTY:
-    case OP_GET_SELF_PROPERTY:
     case OP_SET_PROPERTY:
     case OP_LIST:
     case OP_DICT:
@@ -218,17 +222,44 @@ static int get_code_args_count(const uint8_t *bytecode,
     case OP_EJECT_IMPORT:
     case OP_EJECT_NATIVE_IMPORT:
     case OP_SELECT_IMPORT:
+    case OP_SET_LOCAL_POP:
+    case OP_POP_JUMP_IF_FALSE:
+    case OP_LESS_JUMP:
+    case OP_GREATER_JUMP:
       return 2;
 
+    case OP_CLASS_PROPERTY:
+      return 3;
+
+    case OP_DEFINE_GLOBAL:
+    case OP_GET_GLOBAL:
+    case OP_SET_GLOBAL:
+    case OP_GET_PROPERTY:
+    case OP_GET_SELF_PROPERTY:
+    case OP_GET_LOCALS:
+    case OP_GET_LOCAL_CONSTANT:
+      return 4;
+
     case OP_INVOKE:
     case OP_INVOKE_SELF:
     case OP_SUPER_INVOKE:
-    case OP_CLASS_PROPERTY:
-      return 3;
+      return 5;
 
-    case OP_TRY:
+    case OP_ITER_NEXT:
+    case OP_REG_MOVE:
       return 6;
 
+    case OP_INVOKE_LOCAL:
+      return 7;
+
+    case OP_REG_ADD:
+    case OP_REG_SUBTRACT:
+    case OP_REG_MULTIPLY:
+    case OP_REG_DIVIDE:
+    case OP_REG_LESS_JUMP:
+    case OP_REG_GREATER_JUMP:
+      return 8;
+
     case OP_CLOSURE: {
       int constant = (bytecode[ip + 1] << 8) | bytecode[ip + 2];
       b_obj_func *fn = AS_FUNCTION(constants[constant]);
@@ -263,6 +294,23 @@ static void emit_byte_and_short(b_parser *p, uint8_t byte, uint16_t byte2) {
   write_blob(p->vm, current_blob(p), byte2 & 0xff, p->previous.line);
 }
 
+static void emit_inline_cache(b_parser *p) {
+  int cache = add_inline_cache(p->vm, current_blob(p));
+  if (cache >= UINT16_MAX) {
+    error(p, "too many property lookups in current scope");
+  }
+  emit_short(p, (uint16_t) cache);
+}
+
+static void emit_global_slot(b_parser *p, int name) {
+  b_obj_string *string = AS_STRING(current_blob(p)->constants.values[name]);
+  int slot = module_global_slot(p->vm, p->module, string);
+  if (slot >= UINT16_MAX) {
+    error(p, "too many global variables in module");
+  }
+  emit_short(p, (uint16_t) slot);
+}
+
 /* static void emit_byte_and_long(b_parser *p, uint8_t byte, uint16_t byte2) {
   write_blob(p->vm, current_blob(p), byte, p->previous.line);
   write_blob(p->vm, current_blob(p), (byte2 >> 16) & 0xff, p->previous.line);
@@ -282,10 +330,6 @@ static void emit_loop(b_parser *p, int loop_start) {
 }
 
 static void emit_return(b_parser *p) {
-  if(p->is_trying) {
-    emit_byte(p, OP_POP_TRY);
-  }
-
   if (p->vm->compiler->type == TYPE_INITIALIZER) {
     emit_byte_and_short(p, OP_GET_LOCAL, 0);
   } else {
@@ -305,9 +349,89 @@ static int make_constant(b_parser *p, b_value value) {
 
 static void emit_constant(b_parser *p, b_value value) {
   int constant = make_constant(p, value);
+  p->vm->compiler->last_constant = current_blob(p)->count;
   emit_byte_and_short(p, OP_CONSTANT, (uint16_t) constant);
 }
 
+// a point in the current blob that everything emitted after it can be
+// rolled back to.
+typedef struct {
+  int code;
+  int constants;
+  int handlers;
+} b_code_mark;
+
+static b_code_mark mark_code(b_parser *p) {
+  b_code_mark mark = {
+      current_blob(p)->count,
+      current_blob(p)->constants.count,
+      current_blob(p)->handler_count,
+  };
+  return mark;
+}
+
+// drops the code and constants emitted since mark.
+static void rollback_code(b_parser *p, b_code_mark mark) {
+  current_blob(p)->count = mark.code;
+  current_blob(p)->constants.count = mark.constants;
+  current_blob(p)->handler_count = mark.handlers;
+  p->vm->compiler->last_constant = -1;
+  p->vm->compiler->last_call = -1;
+  p->vm->compiler->last_args = -1;
+}
+
+// returns true if the code from offset to the end of the blob is a single
+// literal load, storing the literal in value.
+static bool constant_at(b_parser *p, int offset, b_value *value) {
+  b_blob *blob = current_blob(p);
+  if (offset < 0 || offset >= blob->count || offset != p->vm->compiler->last_constant) {
+    return false;
+  }
+
+  switch (blob->code[offset]) {
+    case OP_CONSTANT:
+      if (offset + 3 != blob->count) return false;
+      *value = blob->constants.values[(blob->code[offset + 1] << 8) | blob->code[offset + 2]];
+      return true;
+    case OP_NIL:
+      if (offset + 1 != blob->count) return false;
+      *value = NIL_VAL;
+      return true;
+    case OP_TRUE:
+    case OP_FALSE:
+      if (offset + 1 != blob->count) return false;
+      *value = BOOL_VAL(blob->code[offset] == OP_TRUE);
+      return true;
+    default:
+      return false;
+  }
+}
+
+// removes the literal load at offset along with its constant, if nothing
+// else can be referring to it.
+static void discard_constant(b_parser *p, int offset) {
+  b_blob *blob = current_blob(p);
+  if (blob->code[offset] == OP_CONSTANT
+      && ((blob->code[offset + 1] << 8) | blob->code[offset + 2]) == blob->constants.count - 1) {
+    blob->constants.count--;
+  }
+  blob->count = offset;
+  p->vm->compiler->last_constant = -1;
+}
+
+// checks if the expression just compiled is a literal. if it is, the load
+// is removed and the result is its truthiness. otherwise, the result is -1
+// and the value will only be known at runtime.
+static int constant_condition(b_parser *p) {
+  b_value value;
+  int offset = p->vm->compiler->last_constant;
+  if (!constant_at(p, offset, &value)) {
+    return -1;
+  }
+  discard_constant(p, offset);
+  return is_false(value) ? 0 : 1;
+}
+
 static int emit_jump(b_parser *p, uint8_t instruction) {
   emit_byte(p, instruction);
 
@@ -328,44 +452,18 @@ static int emit_switch(b_parser *p) {
   return current_blob(p)->count - 2;
 }
 
-static int emit_try(b_parser *p) {
-  emit_byte(p, OP_TRY);
-  // type placeholders
-  emit_byte(p, 0xff);
-  emit_byte(p, 0xff);
-
-  // handler placeholders
-  emit_byte(p, 0xff);
-  emit_byte(p, 0xff);
-
-  // finally placeholders
-  emit_byte(p, 0xff);
-  emit_byte(p, 0xff);
-
-  return current_blob(p)->count - 6;
-}
-
 static void patch_switch(b_parser *p, int offset, int constant) {
   current_blob(p)->code[offset] = (constant >> 8) & 0xff;
   current_blob(p)->code[offset + 1] = constant & 0xff;
 }
 
-static void patch_try(b_parser *p, int offset, int type, int address, int finally) {
-  // patch type
-  current_blob(p)->code[offset] = (type >> 8) & 0xff;
-  current_blob(p)->code[offset + 1] = type & 0xff;
-  // patch address
-  current_blob(p)->code[offset + 2] = (address >> 8) & 0xff;
-  current_blob(p)->code[offset + 3] = address & 0xff;
-  // patch finally
-  current_blob(p)->code[offset + 4] = (finally >> 8) & 0xff;
-  current_blob(p)->code[offset + 5] = finally & 0xff;
-}
-
 static void patch_jump(b_parser *p, int offset) {
   // -2 to adjust the bytecode for the offset itself
   int jump = current_blob(p)->count - offset - 2;
 
+  // the code before here is now a jump target and must stay as it is.
+  p->vm->compiler->last_constant = -1;
+
   if (jump > UINT16_MAX) {
     error(p, "body of conditional block too large");
   }
@@ -374,13 +472,31 @@ static void patch_jump(b_parser *p, int offset) {
   current_blob(p)->code[offset + 1] = jump & 0xff;
 }
 
+// patches a jump of an OP_ITER_NEXT. both of them are relative to the end
+// of the instruction.
+static void patch_iter_jump(b_parser *p, int offset, int end) {
+  int jump = current_blob(p)->count - end;
+
+  p->vm->compiler->last_constant = -1;
+
+  if (jump > UINT16_MAX) {
+    error(p, "loop body too large");
+  }
+
+  current_blob(p)->code[offset] = (jump >> 8) & 0xff;
+  current_blob(p)->code[offset + 1] = jump & 0xff;
+}
+
 static void init_compiler(b_parser *p, b_compiler *compiler, b_func_type type) {
   compiler->enclosing = p->vm->compiler;
   compiler->function = NULL;
   compiler->type = type;
   compiler->local_count = 0;
   compiler->scope_depth = 0;
-  compiler->handler_count = 0;
+  compiler->try_depth = 0;
+  compiler->last_constant = -1;
+  compiler->last_call = -1;
+  compiler->last_args = -1;
 
   compiler->function = new_function(p->vm, p->module, type);
   p->vm->compiler = compiler;
@@ -528,6 +644,7 @@ static void define_variable(b_parser *p, int global) {
   }
 
   emit_byte_and_short(p, OP_DEFINE_GLOBAL, global);
+  emit_global_slot(p, global);
 }
 
 static b_token synthetic_token(const char *name) {
@@ -541,6 +658,14 @@ static b_obj_func *end_compiler(b_parser *p) {
   emit_return(p);
   b_obj_func *function = p->vm->compiler->function;
 
+  if (!p->had_error && p->vm->should_use_registers) {
+    lower_blob(p->vm, current_blob(p));
+  }
+
+  if (!p->had_error && p->vm->should_optimize) {
+    optimize_blob(p->vm, current_blob(p));
+  }
+
   if (!p->had_error && p->vm->should_print_bytecode) {
     disassemble_blob(current_blob(p), function->name == NULL
                                       ? p->module->file
@@ -548,6 +673,9 @@ static b_obj_func *end_compiler(b_parser *p) {
   }
 
   p->vm->compiler = p->vm->compiler->enclosing;
+  // collections only barrier the functions still being compiled, and this
+  // one may have been promoted or marked before its last constants.
+  write_barrier_all(p->vm, &function->obj);
   return function;
 }
 
@@ -619,13 +747,103 @@ static b_parse_rule *get_rule(b_tkn_type type);
 static void parse_precedence(b_parser *p, b_precedence precedence);
 // --> Forward declarations end
 
+// emits the result of an expression folded at compile time.
+static void emit_folded(b_parser *p, b_value value) {
+  if (IS_BOOL(value)) {
+    p->vm->compiler->last_constant = current_blob(p)->count;
+    emit_byte(p, AS_BOOL(value) ? OP_TRUE : OP_FALSE);
+  } else {
+    emit_constant(p, value);
+  }
+}
+
+// computes op on two literals the same way the vm would at runtime.
+// returns false if the operation has to be left to the vm.
+static bool fold_binary(b_parser *p, b_tkn_type op, b_value a, b_value b, b_value *result) {
+  if (op == EQUAL_EQ_TOKEN || op == BANG_EQ_TOKEN) {
+    bool equal = values_equal(a, b);
+    *result = BOOL_VAL(op == EQUAL_EQ_TOKEN ? equal : !equal);
+    return true;
+  }
+
+  if (op == PLUS_TOKEN && IS_STRING(a) && IS_STRING(b)) {
+    b_vm *vm = p->vm;
+    b_obj_string *x = AS_STRING(a), *y = AS_STRING(b);
+
+    int length = x->length + y->length;
+    char *chars = ALLOCATE(char, length + 1);
+    memcpy(chars, x->chars, x->length);
+    memcpy(chars + x->length, y->chars, y->length);
+    chars[length] = '\0';
+
+    b_obj_string *string = take_string(vm, chars, length);
+    string->utf8_length = x->utf8_length + y->utf8_length;
+    *result = OBJ_VAL(string);
+    return true;
+  }
+
+  if (!IS_NUMBER(a) || !IS_NUMBER(b)) {
+    return false;
+  }
+
+  double x = AS_NUMBER(a), y = AS_NUMBER(b);
+  switch (op) {
+    case PLUS_TOKEN: *result = add_numbers(a, b); return true;
+    case MINUS_TOKEN: *result = subtract_numbers(a, b); return true;
+    case MULTIPLY_TOKEN: *result = multiply_numbers(a, b); return true;
+    case DIVIDE_TOKEN: *result = divide_numbers(a, b); return true;
+    case PERCENT_TOKEN: *result = NUMBER_VAL(modulo(x, y)); return true;
+    case POW_TOKEN: *result = NUMBER_VAL(pow(x, y)); return true;
+    case FLOOR_TOKEN:
+      if ((int) y == 0) return false;
+      *result = NUMBER_VAL(floor_div(x, y));
+      return true;
+
+    case GREATER_TOKEN: *result = BOOL_VAL(x > y); return true;
+    case GREATER_EQ_TOKEN: *result = BOOL_VAL(!(x < y)); return true;
+    case LESS_TOKEN: *result = BOOL_VAL(x < y); return true;
+    case LESS_EQ_TOKEN: *result = BOOL_VAL(!(x > y)); return true;
+
+    case AMP_TOKEN: *result = INTEGER_VAL((long) x & (long) y); return true;
+    case BAR_TOKEN: *result = INTEGER_VAL((long) x | (long) y); return true;
+    case XOR_TOKEN: *result = INTEGER_VAL((long) x ^ (long) y); return true;
+    case LSHIFT_TOKEN:
+    case RSHIFT_TOKEN: {
+      long shift = (long) y;
+      if (shift < 0 || shift >= (long) sizeof(long) * 8) return false;
+      *result = INTEGER_VAL(op == LSHIFT_TOKEN ? (long) x << shift : (long) x >> shift);
+      return true;
+    }
+
+    default:
+      return false;
+  }
+}
+
 static void binary(b_parser *p, b_token previous, bool can_assign) {
   b_tkn_type op = p->previous.type;
 
+  b_value left, right;
+  int left_offset = p->vm->compiler->last_constant;
+  bool left_constant = constant_at(p, left_offset, &left);
+  int right_offset = current_blob(p)->count;
+
   // compile the right operand
   b_parse_rule *rule = get_rule(op);
   parse_precedence(p, (b_precedence) (rule->precedence + 1));
 
+  // both operands are literals, replace their loads with the result
+  b_value result;
+  if (left_constant && constant_at(p, right_offset, &right)
+      && fold_binary(p, op, left, right, &result)) {
+    push(p->vm, result);
+    discard_constant(p, right_offset);
+    discard_constant(p, left_offset);
+    emit_folded(p, result);
+    pop(p->vm);
+    return;
+  }
+
   // emit the operator instruction
   switch (op) {
     case PLUS_TOKEN:
@@ -721,10 +939,12 @@ static uint8_t argument_list(b_parser *p) {
 
 static void call(b_parser *p, b_token previous, bool can_assign) {
   uint8_t arg_count = argument_list(p);
+  p->vm->compiler->last_call = current_blob(p)->count;
   emit_bytes(p, OP_CALL, arg_count);
 }
 
 static void literal(b_parser *p, bool can_assign) {
+  p->vm->compiler->last_constant = current_blob(p)->count;
   switch (p->previous.type) {
     case NIL_TOKEN:
       emit_byte(p, OP_NIL);
@@ -740,6 +960,23 @@ static void literal(b_parser *p, bool can_assign) {
   }
 }
 
+// emits the trailing operand of named get/set instructions.
+static void emit_named_operand(b_parser *p, uint8_t op, int arg) {
+  switch (op) {
+    case OP_GET_PROPERTY:
+    case OP_GET_SELF_PROPERTY:
+      emit_inline_cache(p);
+      break;
+    case OP_DEFINE_GLOBAL:
+    case OP_GET_GLOBAL:
+    case OP_SET_GLOBAL:
+      emit_global_slot(p, arg);
+      break;
+    default:
+      break;
+  }
+}
+
 static void parse_assignment(b_parser *p, uint8_t real_op, uint8_t get_op, uint8_t set_op, int arg) {
   p->repl_can_echo = false;
   if (get_op == OP_GET_PROPERTY || get_op == OP_GET_SELF_PROPERTY) {
@@ -748,6 +985,7 @@ static void parse_assignment(b_parser *p, uint8_t real_op, uint8_t get_op, uint8
 
   if (arg != -1) {
     emit_byte_and_short(p, get_op, arg);
+    emit_named_operand(p, get_op, arg);
   } else {
     emit_bytes(p, get_op, 1);
   }
@@ -756,6 +994,7 @@ static void parse_assignment(b_parser *p, uint8_t real_op, uint8_t get_op, uint8
   emit_byte(p, real_op);
   if (arg != -1) {
     emit_byte_and_short(p, set_op, (uint16_t) arg);
+    emit_named_operand(p, set_op, arg);
   } else {
     emit_byte(p, set_op);
   }
@@ -768,6 +1007,7 @@ static void assignment(b_parser *p, uint8_t get_op, uint8_t set_op, int arg, boo
     expression(p);
     if (arg != -1) {
       emit_byte_and_short(p, set_op, (uint16_t) arg);
+      emit_named_operand(p, set_op, arg);
     } else {
       emit_byte(p, set_op);
     }
@@ -805,12 +1045,18 @@ static void assignment(b_parser *p, uint8_t get_op, uint8_t set_op, int arg, boo
 
     if (arg != -1) {
       emit_byte_and_short(p, get_op, arg);
+      emit_named_operand(p, get_op, arg);
     } else {
       emit_bytes(p, get_op, 1);
     }
 
     emit_bytes(p, OP_ONE, OP_ADD);
-    emit_byte_and_short(p, set_op, (uint16_t) arg);
+    if (arg != -1) {
+      emit_byte_and_short(p, set_op, (uint16_t) arg);
+      emit_named_operand(p, set_op, arg);
+    } else {
+      emit_byte(p, set_op);
+    }
   } else if (can_assign && match(p, DECREMENT_TOKEN)) {
     p->repl_can_echo = false;
     if (get_op == OP_GET_PROPERTY || get_op == OP_GET_SELF_PROPERTY) {
@@ -819,18 +1065,25 @@ static void assignment(b_parser *p, uint8_t get_op, uint8_t set_op, int arg, boo
 
     if (arg != -1) {
       emit_byte_and_short(p, get_op, arg);
+      emit_named_operand(p, get_op, arg);
     } else {
       emit_bytes(p, get_op, 1);
     }
 
     emit_bytes(p, OP_ONE, OP_SUBTRACT);
-    emit_byte_and_short(p, set_op, (uint16_t) arg);
+    if (arg != -1) {
+      emit_byte_and_short(p, set_op, (uint16_t) arg);
+      emit_named_operand(p, set_op, arg);
+    } else {
+      emit_byte(p, set_op);
+    }
   } else {
     if (arg != -1) {
       if (get_op == OP_GET_INDEX || get_op == OP_GET_RANGED_INDEX) {
         emit_bytes(p, get_op, (uint8_t) 0);
       } else {
         emit_byte_and_short(p, get_op, (uint16_t) arg);
+        emit_named_operand(p, get_op, arg);
       }
     } else {
       emit_bytes(p, get_op, (uint8_t) 0);
@@ -838,10 +1091,38 @@ static void assignment(b_parser *p, uint8_t get_op, uint8_t set_op, int arg, boo
   }
 }
 
+// returns the offset of the OP_GET_ARGS the blob ends with, or -1.
+static int trailing_args(b_parser *p) {
+  b_blob *blob = current_blob(p);
+  int offset = p->vm->compiler->last_args;
+  if (offset >= 0 && offset == blob->count - 3 && blob->code[offset] == OP_GET_ARGS) {
+    return offset;
+  }
+  return -1;
+}
+
 static void dot(b_parser *p, b_token previous, bool can_assign) {
+  int args = trailing_args(p);
   ignore_whitespace(p);
   consume(p, IDENTIFIER_TOKEN, "expected property name after '.'");
-  int name = identifier_constant(p, &p->previous);
+  b_token property = p->previous;
+
+  if (args >= 0 && property.length == 6 && memcmp(property.start, "length", 6) == 0
+      && match(p, LPAREN_TOKEN)) {
+    if (match(p, RPAREN_TOKEN)) {
+      current_blob(p)->code[args] = OP_ARGS_LENGTH;
+      return;
+    }
+    // not the call we can do without a list after all.
+    int name = identifier_constant(p, &property);
+    uint8_t arg_count = argument_list(p);
+    emit_byte_and_short(p, OP_INVOKE, name);
+    emit_byte(p, arg_count);
+    emit_inline_cache(p);
+    return;
+  }
+
+  int name = identifier_constant(p, &property);
 
   if (match(p, LPAREN_TOKEN)) {
     uint8_t arg_count = argument_list(p);
@@ -852,6 +1133,7 @@ static void dot(b_parser *p, b_token previous, bool can_assign) {
       emit_byte_and_short(p, OP_INVOKE, name);
     }
     emit_byte(p, arg_count);
+    emit_inline_cache(p);
   } else {
     b_code get_op = OP_GET_PROPERTY, set_op = OP_SET_PROPERTY;
 
@@ -866,8 +1148,17 @@ static void dot(b_parser *p, b_token previous, bool can_assign) {
 
 static void named_variable(b_parser *p, b_token name, bool can_assign) {
   uint8_t get_op, set_op;
+  b_obj_func *function = p->vm->compiler->function;
   int arg = resolve_local(p, p->vm->compiler, &name);
-  if (arg != -1) {
+  if (arg != -1 && function->is_variadic && arg == function->arity) {
+    // __args__ stays on the stack until it is used as a list.
+    int start = current_blob(p)->count;
+    assignment(p, OP_GET_ARGS, OP_SET_LOCAL, arg, can_assign);
+    if (current_blob(p)->count == start + 3 && current_blob(p)->code[start] == OP_GET_ARGS) {
+      p->vm->compiler->last_args = start;
+    }
+    return;
+  } else if (arg != -1) {
     get_op = OP_GET_LOCAL;
     set_op = OP_SET_LOCAL;
   } else if ((arg = resolve_up_value(p, p->vm->compiler, &name)) != -1) {
@@ -890,7 +1181,9 @@ static void created_variable(b_parser *p, b_token name) {
     mark_initialized(p);
     emit_byte_and_short(p, OP_SET_LOCAL, (uint16_t)local);
   } else {
-    emit_byte_and_short(p, OP_DEFINE_GLOBAL, (uint16_t) identifier_constant(p, &name));
+    int global = identifier_constant(p, &name);
+    emit_byte_and_short(p, OP_DEFINE_GLOBAL, (uint16_t) global);
+    emit_global_slot(p, global);
   }
 }
 
@@ -958,6 +1251,7 @@ static void dictionary(b_parser *p, bool can_assign) {
 }
 
 static void indexing(b_parser *p, b_token previous, bool can_assign) {
+  int args = trailing_args(p);
   bool assignable = true, comma_match = false;
   uint8_t get_op = OP_GET_INDEX;
   if (match(p, COMMA_TOKEN)) {
@@ -986,7 +1280,14 @@ static void indexing(b_parser *p, b_token previous, bool can_assign) {
     }
   }
 
+  int start = current_blob(p)->count;
   assignment(p, get_op, OP_SET_INDEX, -1, assignable);
+
+  // reading an item does not need __args__ to be a list. the variadic
+  // arguments are read in place when the value indexed is still EMPTY.
+  if (args >= 0 && current_blob(p)->count == start + 2 && current_blob(p)->code[start] == OP_GET_INDEX) {
+    current_blob(p)->code[args] = OP_GET_LOCAL;
+  }
 }
 
 static void variable(b_parser *p, bool can_assign) {
@@ -1027,6 +1328,7 @@ static void parent(b_parser *p, bool can_assign) {
     if (!invoke_self) {
       emit_byte_and_short(p, OP_SUPER_INVOKE, name);
       emit_byte(p, arg_count);
+      emit_inline_cache(p);
     } else {
       emit_bytes(p, OP_SUPER_INVOKE_SELF, arg_count);
     }
@@ -1046,15 +1348,23 @@ static void grouping(b_parser *p, bool can_assign) {
 static b_value compile_number(b_parser *p) {
   if (p->previous.type == BIN_NUMBER_TOKEN) {
     long long value = strtoll(p->previous.start + 2, NULL, 2);
-    return NUMBER_VAL(value);
+    return LONG_VAL(value);
   } else if (p->previous.type == OCT_NUMBER_TOKEN) {
     long value = strtol(p->previous.start + 2, NULL, 8);
-    return NUMBER_VAL(value);
+    return LONG_VAL(value);
   } else if (p->previous.type == HEX_NUMBER_TOKEN) {
     long value = strtol(p->previous.start, NULL, 16);
-    return NUMBER_VAL(value);
+    return LONG_VAL(value);
   } else {
-    double value = strtod(p->previous.start, NULL);
+    char *end;
+    double value = strtod(p->previous.start, &end);
+    // whole numbers written without a fraction or exponent are integers.
+    for (const char *c = p->previous.start; c < end; c++) {
+      if (*c == '.' || *c == 'e' || *c == 'E') return NUMBER_VAL(value);
+    }
+    if (value >= (double) INTEGER_MIN && value <= (double) INTEGER_MAX) {
+      return LONG_VAL((int64_t) value);
+    }
     return NUMBER_VAL(value);
   }
 }
@@ -1230,10 +1540,25 @@ static void string_interpolation(b_parser *p, bool can_assign) {
 
 static void unary(b_parser *p, bool can_assign) {
   b_tkn_type op = p->previous.type;
+  int offset = current_blob(p)->count;
 
   // compile the expression
   parse_precedence(p, PREC_UNARY);
 
+  b_value value;
+  if (constant_at(p, offset, &value)) {
+    if (op == BANG_TOKEN) {
+      discard_constant(p, offset);
+      emit_folded(p, BOOL_VAL(is_false(value)));
+      return;
+    } else if (IS_NUMBER(value) && (op == MINUS_TOKEN || op == TILDE_TOKEN)) {
+      discard_constant(p, offset);
+      emit_folded(p, op == MINUS_TOKEN ? negate_number(value)
+                                       : INTEGER_VAL(~((int) AS_NUMBER(value))));
+      return;
+    }
+  }
+
   // emit instruction
   switch (op) {
     case MINUS_TOKEN:
@@ -1458,8 +1783,25 @@ static void expression(b_parser *p) { parse_precedence(p, PREC_ASSIGNMENT); }
 static void block(b_parser *p) {
   p->block_count++;
   ignore_whitespace(p);
+
+  // anything after a statement that always leaves the block can never run,
+  // so it is still compiled for errors but then thrown away.
+  bool unreachable = false;
+  b_code_mark mark;
+
   while (!check(p, RBRACE_TOKEN) && !check(p, EOF_TOKEN)) {
+    bool leaves = check(p, RETURN_TOKEN) || check(p, DIE_TOKEN)
+                  || check(p, BREAK_TOKEN) || check(p, CONTINUE_TOKEN);
     declaration(p);
+
+    if (leaves && !unreachable) {
+      unreachable = true;
+      mark = mark_code(p);
+    }
+  }
+
+  if (unreachable) {
+    rollback_code(p, mark);
   }
   p->block_count--;
   consume(p, RBRACE_TOKEN, "expected '}' after block");
@@ -1744,15 +2086,20 @@ static void iter_statement(b_parser *p) {
   p->innermost_loop_start = current_blob(p)->count;
   p->innermost_loop_scope_depth = p->vm->compiler->scope_depth;
 
-  int exit_jump = -1;
+  b_code_mark mark = mark_code(p);
+  int exit_jump = -1, condition = 1;
   if (!match(p, SEMICOLON_TOKEN)) { // the condition is optional
     expression(p);
     consume(p, SEMICOLON_TOKEN, "expected ';' after condition");
     ignore_whitespace(p);
 
-    // jump out of the loop if the condition is false...
-    exit_jump = emit_jump(p, OP_JUMP_IF_FALSE);
-    emit_byte(p, OP_POP); // pop the condition
+    // a literal true condition is the same as none at all.
+    condition = constant_condition(p);
+    if (condition == -1) {
+      // jump out of the loop if the condition is false...
+      exit_jump = emit_jump(p, OP_JUMP_IF_FALSE);
+      emit_byte(p, OP_POP); // pop the condition
+    }
   }
 
   // the iterator...
@@ -1771,14 +2118,19 @@ static void iter_statement(b_parser *p) {
 
   statement(p);
 
-  emit_loop(p, p->innermost_loop_start);
+  if (condition == 0) {
+    // the loop never runs, but the initializer still does.
+    rollback_code(p, mark);
+  } else {
+    emit_loop(p, p->innermost_loop_start);
 
-  if (exit_jump != -1) {
-    patch_jump(p, exit_jump);
-    emit_byte(p, OP_POP);
-  }
+    if (exit_jump != -1) {
+      patch_jump(p, exit_jump);
+      emit_byte(p, OP_POP);
+    }
 
-  end_loop(p);
+    end_loop(p);
+  }
 
   // reset the loop start and scope depth to the surrounding value
   p->innermost_loop_start = surrounding_loop_start;
@@ -1865,7 +2217,7 @@ static void for_statement(b_parser *p) {
   // Evaluate the sequence expression and store it in a hidden local variable.
   expression(p);
 
-  if (p->vm->compiler->local_count + 3 > UINT8_COUNT) {
+  if (p->vm->compiler->local_count + 4 > UINT8_COUNT) {
     error(p, "cannot declare more than %d variables in one scope", UINT8_COUNT);
     return;
   }
@@ -1874,16 +2226,19 @@ static void for_statement(b_parser *p) {
   int iterator_slot = add_local(p, iterator_token) - 1;
   define_variable(p, 0);
 
-  // Create the key local variable.
-  emit_byte(p, OP_NIL);
+  // OP_ITER_PREP creates the key, the value and a hidden cursor that
+  // built-in iterables use to remember where they are.
+  emit_byte(p, OP_ITER_PREP);
+
   int key_slot = add_local(p, key_token) - 1;
   define_variable(p, key_slot);
 
-  // create the local value slot
-  emit_byte(p, OP_NIL);
   int value_slot = add_local(p, value_token) - 1;
   define_variable(p, 0);
 
+  add_local(p, synthetic_token(" cursor "));
+  define_variable(p, 0);
+
   int surrounding_loop_start = p->innermost_loop_start;
   int surrounding_scope_depth = p->innermost_loop_scope_depth;
 
@@ -1892,11 +2247,20 @@ static void for_statement(b_parser *p) {
   p->innermost_loop_start = current_blob(p)->count;
   p->innermost_loop_scope_depth = p->vm->compiler->scope_depth;
 
+  // the vm steps lists, ranges, strings, bytes and dictionaries itself
+  // and jumps straight into the body or out of the loop. everything else
+  // falls through to @itern and @iter.
+  emit_byte_and_short(p, OP_ITER_NEXT, iterator_slot);
+  emit_short(p, 0xffff);
+  emit_short(p, 0xffff);
+  int iter_next_end = current_blob(p)->count;
+
   // key = iterable.iter_n__(key)
   emit_byte_and_short(p, OP_GET_LOCAL, iterator_slot);
   emit_byte_and_short(p, OP_GET_LOCAL, key_slot);
   emit_byte_and_short(p, OP_INVOKE, iter_n__);
   emit_byte(p, 1);
+  emit_inline_cache(p);
   emit_byte_and_short(p, OP_SET_LOCAL, key_slot);
 
   int false_jump = emit_jump(p, OP_JUMP_IF_FALSE);
@@ -1907,15 +2271,16 @@ static void for_statement(b_parser *p) {
   emit_byte_and_short(p, OP_GET_LOCAL, key_slot);
   emit_byte_and_short(p, OP_INVOKE, iter__);
   emit_byte(p, 1);
+  emit_inline_cache(p);
+  emit_byte_and_short(p, OP_SET_LOCAL, value_slot);
+  emit_byte(p, OP_POP);
+
+  patch_iter_jump(p, iter_next_end - 4, iter_next_end);
 
   // Bind the loop value in its own scope. This ensures we get a fresh
   // variable each iteration so that closures for it don't all see the same one.
   begin_scope(p);
 
-  // update the value
-  emit_byte_and_short(p, OP_SET_LOCAL, value_slot);
-  emit_byte(p, OP_POP);
-
   statement(p);
 
   end_scope(p);
@@ -1924,6 +2289,7 @@ static void for_statement(b_parser *p) {
 
   patch_jump(p, false_jump);
   emit_byte(p, OP_POP);
+  patch_iter_jump(p, iter_next_end - 2, iter_next_end);
 
   end_loop(p);
 
@@ -1990,6 +2356,7 @@ static void using_statement(b_parser *p) {
             b_obj_string *string = take_string(p->vm, str, length);
             push(p->vm, OBJ_VAL(string)); // gc fix
             table_set(p->vm, &sw->table, OBJ_VAL(string), jump);
+            write_barrier(p->vm, &sw->obj, OBJ_VAL(string));
             pop(p->vm); // gc fix
           } else if (check_number(p)) {
             table_set(p->vm, &sw->table, compile_number(p), jump);
@@ -2031,6 +2398,25 @@ static void using_statement(b_parser *p) {
 static void if_statement(b_parser *p) {
   expression(p);
 
+  // a literal condition leaves only one of the branches reachable.
+  int condition = constant_condition(p);
+  if (condition != -1) {
+    b_code_mark mark = mark_code(p);
+    statement(p);
+    if (condition == 0) {
+      rollback_code(p, mark);
+    }
+
+    if (match(p, ELSE_TOKEN)) {
+      mark = mark_code(p);
+      statement(p);
+      if (condition == 1) {
+        rollback_code(p, mark);
+      }
+    }
+    return;
+  }
+
   int then_jump = emit_jump(p, OP_JUMP_IF_FALSE);
   emit_byte(p, OP_POP);
   statement(p);
@@ -2054,7 +2440,6 @@ static void echo_statement(b_parser *p) {
 }
 
 static void die_statement(b_parser *p) {
-  discard_locals(p, p->vm->compiler->scope_depth - 1);
   expression(p);
   emit_byte(p, OP_DIE);
   consume_statement_end(p);
@@ -2251,20 +2636,20 @@ static void assert_statement(b_parser *p) {
 }
 
 static void try_statement(b_parser *p) {
-
-  if (p->vm->compiler->handler_count == MAX_EXCEPTION_HANDLERS) {
-    error(p, "maximum exception handler in scope exceeded");
-  }
-  p->vm->compiler->handler_count++;
-  p->is_trying = true;
+  p->vm->compiler->try_depth++;
 
   ignore_whitespace(p);
-  int try_begins = emit_try(p);
+
+  // nothing marks the start of the body in the code, so it must not be
+  // folded into whatever comes before it.
+  p->vm->compiler->last_constant = -1;
+  int try_begins = current_blob(p)->count;
+  int locals = p->vm->compiler->local_count;
 
   statement(p); // compile the try body
-  emit_byte(p, OP_POP_TRY);
+  int try_ends = current_blob(p)->count;
   int exit_jump = emit_jump(p, OP_JUMP);
-  p->is_trying = false;
+  p->vm->compiler->try_depth--;
 
   // we can safely use 0 because a program cannot start with a
   // catch or finally block
@@ -2287,8 +2672,6 @@ static void try_statement(b_parser *p) {
       emit_byte(p, OP_POP);
     }
 
-    emit_byte(p, OP_POP_TRY);
-
     ignore_whitespace(p);
     statement(p);
 
@@ -2301,10 +2684,18 @@ static void try_statement(b_parser *p) {
 
   if (match(p, FINALLY_TOKEN)) {
     final_exists = true;
-    // if we arrived here from either the try or handler block,
-    // we don't want to continue propagating the exception
+    // an exception arrives here with itself and true on the stack. if we
+    // arrived here from either the try or handler block, there is no
+    // exception and we don't want to continue propagating it. the two are
+    // locals so that the finally block finds its own ones where it expects.
+    begin_scope(p);
+    emit_byte(p, OP_NIL);
     emit_byte(p, OP_FALSE);
     finally = current_blob(p)->count;
+    add_local(p, synthetic_token(" exception "));
+    mark_initialized(p);
+    add_local(p, synthetic_token(" propagate "));
+    mark_initialized(p);
 
     ignore_whitespace(p);
     statement(p);
@@ -2313,14 +2704,15 @@ static void try_statement(b_parser *p) {
     emit_byte(p, OP_POP); // pop the bool off the stack
     emit_byte(p, OP_PUBLISH_TRY);
     patch_jump(p, continue_execution_address);
-    emit_byte(p, OP_POP);
+    end_scope(p);
   }
 
   if (!final_exists && !catch_exists) {
     error(p, "try block must contain at least one of catch or finally");
   }
 
-  patch_try(p, try_begins, type, address, finally);
+  b_handler handler = {try_begins, try_ends, locals, type, address, finally};
+  add_handler(p->vm, current_blob(p), handler);
 }
 
 static void return_statement(b_parser *p) {
@@ -2336,11 +2728,17 @@ static void return_statement(b_parser *p) {
       error(p, "cannot return value from constructor");
     }
 
-    if(p->is_trying) {
-      emit_byte(p, OP_POP_TRY);
+    expression(p);
+
+    // a call that is the last thing the function does can take over its
+    // frame, unless a try around it still has to see what it throws.
+    b_blob *blob = current_blob(p);
+    int last_call = p->vm->compiler->last_call;
+    if (last_call >= 0 && last_call == blob->count - 2 && blob->code[last_call] == OP_CALL
+        && p->vm->compiler->try_depth == 0) {
+      blob->code[last_call] = OP_TAIL_CALL;
     }
 
-    expression(p);
     emit_byte(p, OP_RETURN);
     consume_statement_end(p);
   }
@@ -2356,19 +2754,33 @@ static void while_statement(b_parser *p) {
   p->innermost_loop_start = current_blob(p)->count;
   p->innermost_loop_scope_depth = p->vm->compiler->scope_depth;
 
+  b_code_mark mark = mark_code(p);
   expression(p);
 
-  int exit_jump = emit_jump(p, OP_JUMP_IF_FALSE);
-  emit_byte(p, OP_POP);
+  // a literal condition either never enters the loop or never leaves it
+  // other than through a break.
+  int condition = constant_condition(p);
+
+  int exit_jump = -1;
+  if (condition == -1) {
+    exit_jump = emit_jump(p, OP_JUMP_IF_FALSE);
+    emit_byte(p, OP_POP);
+  }
 
   statement(p);
 
-  emit_loop(p, p->innermost_loop_start);
+  if (condition == 0) {
+    rollback_code(p, mark);
+  } else {
+    emit_loop(p, p->innermost_loop_start);
 
-  patch_jump(p, exit_jump);
-  emit_byte(p, OP_POP);
+    if (exit_jump != -1) {
+      patch_jump(p, exit_jump);
+      emit_byte(p, OP_POP);
+    }
 
-  end_loop(p);
+    end_loop(p);
+  }
 
   p->innermost_loop_start = surrounding_loop_start;
   p->innermost_loop_scope_depth = surrounding_scope_depth;
@@ -2389,13 +2801,18 @@ static void do_while_statement(b_parser *p) {
 
   expression(p);
 
-  int exit_jump = emit_jump(p, OP_JUMP_IF_FALSE);
-  emit_byte(p, OP_POP);
+  int condition = constant_condition(p);
+  if (condition == -1) {
+    int exit_jump = emit_jump(p, OP_JUMP_IF_FALSE);
+    emit_byte(p, OP_POP);
 
-  emit_loop(p, p->innermost_loop_start);
+    emit_loop(p, p->innermost_loop_start);
 
-  patch_jump(p, exit_jump);
-  emit_byte(p, OP_POP);
+    patch_jump(p, exit_jump);
+    emit_byte(p, OP_POP);
+  } else if (condition == 1) {
+    emit_loop(p, p->innermost_loop_start);
+  }
 
   end_loop(p);
 
@@ -2562,7 +2979,6 @@ b_obj_func *compile(b_vm *vm, b_obj_module *module, const char *source, b_blob *
   parser.block_count = 0;
   parser.repl_can_echo = false;
   parser.is_returning = false;
-  parser.is_trying = false;
   parser.innermost_loop_start = -1;
   parser.innermost_loop_scope_depth = 0;
   parser.current_class = NULL;
@@ -2587,6 +3003,8 @@ void mark_compiler_roots(b_vm *vm) {
   b_compiler *compiler = vm->compiler;
   while (compiler != NULL) {
     mark_object(vm, (b_obj *) compiler->function);
+    // constants are added without a write barrier while compiling.
+    write_barrier_all(vm, (b_obj *) compiler->function);
     compiler = compiler->enclosing;
   }
 }
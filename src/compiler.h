@@ -48,7 +48,18 @@ struct s_compiler {
   int local_count;
   b_up_value up_values[UINT8_COUNT];
   int scope_depth;
-  int handler_count;
+  int try_depth; // try blocks around the code being compiled
+
+  // offset of the last literal load emitted or -1 if the code since then
+  // cannot be folded into a constant.
+  int last_constant;
+
+  // offset of the last OP_CALL emitted, used to spot calls in tail position.
+  int last_call;
+
+  // offset of the last OP_GET_ARGS emitted, used to read __args__ without
+  // making it a list where that is enough.
+  int last_args;
 };
 
 typedef struct b_class_compiler {
@@ -67,7 +78,6 @@ typedef struct {
   bool panic_mode;
   int block_count;
   bool is_returning;
-  bool is_trying;
   bool repl_can_echo;
   b_class_compiler *current_class;
   const char *current_file;
@@ -90,6 +100,8 @@ typedef struct {
 
 b_obj_func *compile(b_vm *vm, b_obj_module *module, const char *source, b_blob *blob);
 
+int get_code_args_count(const uint8_t *bytecode, const b_value *constants, int ip);
+
 void mark_compiler_roots(b_vm *vm);
 
 #endif
\ No newline at end of file
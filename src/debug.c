@@ -10,6 +10,12 @@ void disassemble_blob(b_blob *blob, const char *name) {
   for (int offset = 0; offset < blob->count;) {
     offset = disassemble_instruction(blob, offset);
   }
+
+  for (int i = 0; i < blob->handler_count; i++) {
+    b_handler *handler = &blob->handlers[i];
+    printf("try %04d-%04d %8d -> %d, %d\n", handler->start, handler->end,
+           handler->type, handler->address, handler->finally_address);
+  }
 }
 
 int simple_instruction(const char *name, int offset) {
@@ -55,15 +61,15 @@ static int jump_instruction(const char *name, int sign, b_blob *blob,
   return offset + 3;
 }
 
-static int try_instruction(const char *name, b_blob *blob, int offset) {
-  uint16_t type = (uint16_t) (blob->code[offset + 1] << 8);
-  type |= blob->code[offset + 2];
-  uint16_t address = (uint16_t) (blob->code[offset + 3] << 8);
-  address |= blob->code[offset + 4];
-  uint16_t finally = (uint16_t) (blob->code[offset + 5] << 8);
-  finally |= blob->code[offset + 6];
+static int iter_next_instruction(const char *name, b_blob *blob, int offset) {
+  uint16_t slot = (uint16_t) (blob->code[offset + 1] << 8);
+  slot |= blob->code[offset + 2];
+  uint16_t body = (uint16_t) (blob->code[offset + 3] << 8);
+  body |= blob->code[offset + 4];
+  uint16_t exit = (uint16_t) (blob->code[offset + 5] << 8);
+  exit |= blob->code[offset + 6];
 
-  printf("%-16s %8d -> %d, %d\n", name, type, address, finally);
+  printf("%-16s %8d -> %d, %d\n", name, slot, offset + 7 + body, offset + 7 + exit);
   return offset + 7;
 }
 
@@ -71,11 +77,98 @@ static int invoke_instruction(const char *name, b_blob *blob, int offset) {
   uint16_t constant = (uint16_t) (blob->code[offset + 1] << 8);
   constant |= blob->code[offset + 2];
   uint8_t arg_count = blob->code[offset + 3];
+  uint16_t cache = (uint16_t) (blob->code[offset + 4] << 8);
+  cache |= blob->code[offset + 5];
 
   printf("%-16s (%d args) %8d '", name, arg_count, constant);
   print_value(blob->constants.values[constant]);
+  printf("' @%d\n", cache);
+  return offset + 6;
+}
+
+static int cached_constant_instruction(const char *name, b_blob *blob, int offset) {
+  uint16_t constant = (blob->code[offset + 1] << 8) | blob->code[offset + 2];
+  uint16_t cache = (blob->code[offset + 3] << 8) | blob->code[offset + 4];
+  printf("%-16s %8d '", name, constant);
+  print_value(blob->constants.values[constant]);
+  printf("' @%d\n", cache);
+  return offset + 5;
+}
+
+static int global_instruction(const char *name, b_blob *blob, int offset) {
+  uint16_t constant = (blob->code[offset + 1] << 8) | blob->code[offset + 2];
+  uint16_t slot = (blob->code[offset + 3] << 8) | blob->code[offset + 4];
+  printf("%-16s %8d '", name, constant);
+  print_value(blob->constants.values[constant]);
+  printf("' #%d\n", slot);
+  return offset + 5;
+}
+
+static int locals_instruction(const char *name, b_blob *blob, int offset) {
+  uint16_t first = (blob->code[offset + 1] << 8) | blob->code[offset + 2];
+  uint16_t second = (blob->code[offset + 3] << 8) | blob->code[offset + 4];
+  printf("%-16s %8d, %d\n", name, first, second);
+  return offset + 5;
+}
+
+static int local_constant_instruction(const char *name, b_blob *blob, int offset) {
+  uint16_t slot = (blob->code[offset + 1] << 8) | blob->code[offset + 2];
+  uint16_t constant = (blob->code[offset + 3] << 8) | blob->code[offset + 4];
+  printf("%-16s %8d, %d '", name, slot, constant);
+  print_value(blob->constants.values[constant]);
   printf("'\n");
-  return offset + 4;
+  return offset + 5;
+}
+
+static int invoke_local_instruction(const char *name, b_blob *blob, int offset) {
+  uint16_t slot = (blob->code[offset + 1] << 8) | blob->code[offset + 2];
+  uint16_t constant = (blob->code[offset + 3] << 8) | blob->code[offset + 4];
+  uint8_t arg_count = blob->code[offset + 5];
+  uint16_t cache = (blob->code[offset + 6] << 8) | blob->code[offset + 7];
+
+  printf("%-16s (%d args) %8d, %d '", name, arg_count, slot, constant);
+  print_value(blob->constants.values[constant]);
+  printf("' @%d\n", cache);
+  return offset + 8;
+}
+
+static void print_register(b_blob *blob, uint16_t operand) {
+  if (operand & REG_CONSTANT) {
+    printf("'");
+    print_value(blob->constants.values[operand & ~REG_CONSTANT]);
+    printf("'");
+  } else {
+    printf("r%d", operand);
+  }
+}
+
+static int register_instruction(const char *name, b_blob *blob, int offset, int sources) {
+  uint8_t *code = blob->code;
+  int operand = offset + 1;
+
+  printf("%-16s ", name);
+  if (code[offset] != OP_REG_LESS_JUMP && code[offset] != OP_REG_GREATER_JUMP) {
+    uint16_t dst = (code[operand] << 8) | code[operand + 1];
+    if (dst == REG_PUSH) printf("push <- ");
+    else printf("r%d <- ", dst);
+    operand += 2;
+  }
+
+  for (int i = 0; i < sources; i++, operand += 2) {
+    if (i > 0) printf(", ");
+    print_register(blob, (code[operand] << 8) | code[operand + 1]);
+  }
+
+  uint16_t skip = (code[operand] << 8) | code[operand + 1];
+  operand += 2;
+  if (code[offset] == OP_REG_LESS_JUMP || code[offset] == OP_REG_GREATER_JUMP) {
+    uint16_t jump = (code[operand] << 8) | code[operand + 1];
+    operand += 2;
+    printf(" -> %d, %d\n", operand + skip, operand + jump);
+  } else {
+    printf(" -> %d\n", operand + skip);
+  }
+  return operand;
 }
 
 int disassemble_instruction(b_blob *blob, int offset) {
@@ -92,27 +185,33 @@ int disassemble_instruction(b_blob *blob, int offset) {
       return jump_instruction("fjump", 1, blob, offset);
     case OP_JUMP:
       return jump_instruction("jump", 1, blob, offset);
-    case OP_TRY:
-      return try_instruction("itry", blob, offset);
     case OP_LOOP:
       return jump_instruction("loop", -1, blob, offset);
+    case OP_ITER_PREP:
+      return simple_instruction("iterp", offset);
+    case OP_ITER_NEXT:
+      return iter_next_instruction("itern", blob, offset);
 
     case OP_DEFINE_GLOBAL:
-      return constant_instruction("dglob", blob, offset);
+      return global_instruction("dglob", blob, offset);
     case OP_GET_GLOBAL:
-      return constant_instruction("gglob", blob, offset);
+      return global_instruction("gglob", blob, offset);
     case OP_SET_GLOBAL:
-      return constant_instruction("sglob", blob, offset);
+      return global_instruction("sglob", blob, offset);
 
     case OP_GET_LOCAL:
       return short_instruction("gloc", blob, offset);
     case OP_SET_LOCAL:
       return short_instruction("sloc", blob, offset);
+    case OP_GET_ARGS:
+      return short_instruction("gargs", blob, offset);
+    case OP_ARGS_LENGTH:
+      return short_instruction("largs", blob, offset);
 
     case OP_GET_PROPERTY:
-      return constant_instruction("gprop", blob, offset);
+      return cached_constant_instruction("gprop", blob, offset);
     case OP_GET_SELF_PROPERTY:
-      return constant_instruction("gprops", blob, offset);
+      return cached_constant_instruction("gprops", blob, offset);
     case OP_SET_PROPERTY:
       return constant_instruction("sprop", blob, offset);
 
@@ -121,8 +220,6 @@ int disassemble_instruction(b_blob *blob, int offset) {
     case OP_SET_UP_VALUE:
       return short_instruction("supv", blob, offset);
 
-    case OP_POP_TRY:
-      return simple_instruction("ptry", offset);
     case OP_PUBLISH_TRY:
       return simple_instruction("pubtry", offset);
 
@@ -200,6 +297,48 @@ int disassemble_instruction(b_blob *blob, int offset) {
       return simple_instruction("str", offset);
     case OP_CHOICE:
       return simple_instruction("cho", offset);
+
+    case OP_ADD_NUM:
+      return simple_instruction("addn", offset);
+    case OP_SUBTRACT_NUM:
+      return simple_instruction("subn", offset);
+    case OP_MULTIPLY_NUM:
+      return simple_instruction("muln", offset);
+    case OP_DIVIDE_NUM:
+      return simple_instruction("divn", offset);
+    case OP_GREATER_NUM:
+      return simple_instruction("gtn", offset);
+    case OP_LESS_NUM:
+      return simple_instruction("lessn", offset);
+
+    case OP_GET_LOCALS:
+      return locals_instruction("glocs", blob, offset);
+    case OP_GET_LOCAL_CONSTANT:
+      return local_constant_instruction("glocl", blob, offset);
+    case OP_SET_LOCAL_POP:
+      return short_instruction("slocp", blob, offset);
+    case OP_POP_JUMP_IF_FALSE:
+      return jump_instruction("pfjump", 1, blob, offset);
+    case OP_LESS_JUMP:
+      return jump_instruction("lessj", 1, blob, offset);
+    case OP_GREATER_JUMP:
+      return jump_instruction("gtj", 1, blob, offset);
+    case OP_INVOKE_LOCAL:
+      return invoke_local_instruction("invl", blob, offset);
+    case OP_REG_MOVE:
+      return register_instruction("rmov", blob, offset, 1);
+    case OP_REG_ADD:
+      return register_instruction("radd", blob, offset, 2);
+    case OP_REG_SUBTRACT:
+      return register_instruction("rsub", blob, offset, 2);
+    case OP_REG_MULTIPLY:
+      return register_instruction("rmul", blob, offset, 2);
+    case OP_REG_DIVIDE:
+      return register_instruction("rdiv", blob, offset, 2);
+    case OP_REG_LESS_JUMP:
+      return register_instruction("rlessj", blob, offset, 2);
+    case OP_REG_GREATER_JUMP:
+      return register_instruction("rgtj", blob, offset, 2);
     case OP_DIE:
       return simple_instruction("die", offset);
     case OP_POP:
@@ -252,6 +391,8 @@ int disassemble_instruction(b_blob *blob, int offset) {
     }
     case OP_CALL:
       return byte_instruction("call", blob, offset);
+    case OP_TAIL_CALL:
+      return byte_instruction("tcall", blob, offset);
     case OP_INVOKE:
       return invoke_instruction("invk", blob, offset);
     case OP_INVOKE_SELF:
@@ -9,7 +9,7 @@
 
 DECLARE_DICT_METHOD(length) {
   ENFORCE_ARG_COUNT(dictionary.length, 0);
-  RETURN_NUMBER(AS_DICT(METHOD_OBJECT)->names.count);
+  RETURN_LONG(AS_DICT(METHOD_OBJECT)->names.count);
 }
 
 DECLARE_DICT_METHOD(add) {
@@ -60,6 +60,7 @@ DECLARE_DICT_METHOD(clone) {
   for (int i = 0; i < dict->names.count; i++) {
     write_value_arr(vm, &n_dict->names, dict->names.values[i]);
   }
+  write_barrier_all(vm, &n_dict->obj);
 
   RETURN_OBJ(n_dict);
 }
@@ -103,6 +104,7 @@ DECLARE_DICT_METHOD(extend) {
     }
   }
   table_add_all(vm, &dict_cpy->items, &dict->items);
+  write_barrier_all(vm, &dict->obj);
   RETURN;
 }
 
@@ -0,0 +1,40 @@
+#include "fiber.h"
+
+DECLARE_NATIVE(fiber) {
+  ENFORCE_ARG_COUNT(fiber, 1);
+  ENFORCE_ARG_TYPE(fiber, 0, IS_CLOSURE);
+  RETURN_OBJ(new_fiber(vm, AS_CLOSURE(args[0])));
+}
+
+DECLARE_NATIVE(yield) {
+  ENFORCE_ARG_RANGE(yield, 0, 1);
+  if (vm->fiber == NULL) {
+    RETURN_ERROR("cannot yield outside of a fiber");
+  }
+
+  // the stack has changed, so the result is already where it belongs.
+  yield_fiber(vm, arg_count > 0 ? args[0] : NIL_VAL, arg_count);
+  return false;
+}
+
+DECLARE_FIBER_METHOD(resume) {
+  b_obj_fiber *fiber = AS_FIBER(METHOD_OBJECT);
+
+  switch (fiber->state) {
+    case FIBER_DONE: RETURN_ERROR("cannot resume a finished fiber");
+    case FIBER_RUNNING: RETURN_ERROR("cannot resume a running fiber");
+    case FIBER_SUSPENDED: {
+      ENFORCE_ARG_RANGE(resume, 0, 1);
+      break;
+    }
+    default: break;
+  }
+
+  resume_fiber(vm, fiber, arg_count);
+  return false;
+}
+
+DECLARE_FIBER_METHOD(is_done) {
+  ENFORCE_ARG_COUNT(is_done, 0);
+  RETURN_BOOL(AS_FIBER(METHOD_OBJECT)->state == FIBER_DONE);
+}
@@ -0,0 +1,44 @@
+#ifndef BLADE_FIBER_H
+#define BLADE_FIBER_H
+
+#include "common.h"
+#include "native.h"
+#include "vm.h"
+
+#define DECLARE_FIBER_METHOD(name) DECLARE_METHOD(fiber##name)
+
+/**
+ * fiber(fn: function)
+ *
+ * creates a new fiber that runs the function fn with its own stack the
+ * first time it is resumed
+ */
+DECLARE_NATIVE(fiber);
+
+/**
+ * yield([value: any])
+ *
+ * suspends the running fiber and returns the value from the call to
+ * resume() that ran it. returns the value the fiber is resumed with next.
+ */
+DECLARE_NATIVE(yield);
+
+/**
+ * fiber.resume(...)
+ *
+ * runs the fiber until it yields or returns and gives back the value it
+ * yielded or returned. the first call passes its arguments to the
+ * function of the fiber, later ones hand their argument to yield().
+ * exceptions the fiber does not handle are raised here.
+ */
+DECLARE_FIBER_METHOD(resume);
+
+/**
+ * fiber.is_done()
+ *
+ * returns true if the function of the fiber has returned or raised an
+ * exception and false otherwise
+ */
+DECLARE_FIBER_METHOD(is_done);
+
+#endif
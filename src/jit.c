@@ -0,0 +1,1062 @@
+#include "jit.h"
+#include "compiler.h"
+#include "memory.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if JIT_SUPPORTED
+
+#include <sys/mman.h>
+
+/**
+ * a baseline template compiler. every instruction is translated on its
+ * own into a fixed sequence of x86-64 code that works directly on the vm
+ * stack, so the native code and the interpreter can hand a frame to each
+ * other at any instruction.
+ *
+ * registers held across the whole function:
+ *    rbx = vm, r12 = frame slots, r13 = stack top, r14 = frame, r15 = QNAN
+ */
+
+enum {
+  RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI,
+  R8, R9, R10, R11, R12, R13, R14, R15,
+};
+
+enum {
+  XMM0, XMM1,
+};
+
+// condition codes
+enum {
+  CC_B = 0x2,
+  CC_AE = 0x3,
+  CC_E = 0x4,
+  CC_NE = 0x5,
+  CC_BE = 0x6,
+  CC_A = 0x7,
+  CC_O = 0x0,
+  CC_S = 0x8,
+  CC_NP = 0xb,
+  CC_L = 0xc,
+  CC_G = 0xf,
+};
+
+#define REG_VM RBX
+#define REG_SLOTS R12
+#define REG_TOP R13
+#define REG_FRAME R14
+#define REG_QNAN R15
+
+// entering native code costs about as much as interpreting a few
+// instructions, so it is only done where at least this many instructions
+// run before control goes back to the interpreter.
+#define MIN_NATIVE_RUN 4
+
+typedef struct {
+  int patch;  // position of the rel32 to patch
+  int target; // bytecode offset it jumps to
+} b_jit_fix;
+
+typedef struct {
+  b_vm *vm;
+  b_obj_func *function;
+
+  uint8_t *code;
+  int count;
+  int capacity;
+  bool failed;
+
+  int exit; // the shared exit sequence
+
+  b_jit_fix *jumps;
+  int jump_count;
+  int jump_capacity;
+
+  // guards that send the instruction at target back to the interpreter
+  b_jit_fix *exits;
+  int exit_count;
+  int exit_capacity;
+
+  int pushes; // values the templates emitted so far push
+} b_jit_asm;
+
+static void emit8(b_jit_asm *a, uint8_t byte) {
+  if (a->count + 1 > a->capacity) {
+    int capacity = a->capacity < 256 ? 256 : a->capacity * 2;
+    uint8_t *code = realloc(a->code, capacity);
+    if (code == NULL) {
+      a->failed = true;
+      return;
+    }
+    a->code = code;
+    a->capacity = capacity;
+  }
+  a->code[a->count++] = byte;
+}
+
+static void emit32(b_jit_asm *a, uint32_t value) {
+  for (int i = 0; i < 4; i++) {
+    emit8(a, (value >> (i * 8)) & 0xff);
+  }
+}
+
+static void emit64(b_jit_asm *a, uint64_t value) {
+  for (int i = 0; i < 8; i++) {
+    emit8(a, (value >> (i * 8)) & 0xff);
+  }
+}
+
+static void patch32(b_jit_asm *a, int position, int target) {
+  if (a->failed) return;
+  int32_t relative = target - (position + 4);
+  memcpy(a->code + position, &relative, sizeof(int32_t));
+}
+
+static void add_fix(b_jit_asm *a, b_jit_fix **fixes, int *count, int *capacity, int patch, int target) {
+  if (*count + 1 > *capacity) {
+    int new_capacity = *capacity < 16 ? 16 : *capacity * 2;
+    b_jit_fix *array = realloc(*fixes, sizeof(b_jit_fix) * new_capacity);
+    if (array == NULL) {
+      a->failed = true;
+      return;
+    }
+    *fixes = array;
+    *capacity = new_capacity;
+  }
+  (*fixes)[*count].patch = patch;
+  (*fixes)[*count].target = target;
+  (*count)++;
+}
+
+// --> instruction encoding
+
+static void emit_rex(b_jit_asm *a, bool wide, int reg, int rm) {
+  uint8_t rex = 0x40 | (wide ? 0x08 : 0) | ((reg >> 3) << 2) | (rm >> 3);
+  if (rex != 0x40) {
+    emit8(a, rex);
+  }
+}
+
+// [base + disp32] operand
+static void emit_mem(b_jit_asm *a, int reg, int base, int32_t disp) {
+  emit8(a, 0x80 | ((reg & 7) << 3) | (base & 7));
+  if ((base & 7) == RSP) {
+    emit8(a, 0x24);
+  }
+  emit32(a, (uint32_t) disp);
+}
+
+// mov reg, [base + disp]
+static void emit_load(b_jit_asm *a, int reg, int base, int32_t disp) {
+  emit_rex(a, true, reg, base);
+  emit8(a, 0x8b);
+  emit_mem(a, reg, base, disp);
+}
+
+// mov reg32, [base + disp], zero extended
+static void emit_load32(b_jit_asm *a, int reg, int base, int32_t disp) {
+  emit_rex(a, false, reg, base);
+  emit8(a, 0x8b);
+  emit_mem(a, reg, base, disp);
+}
+
+// cmp reg, [base + disp]
+static void emit_cmp_mem(b_jit_asm *a, int reg, int base, int32_t disp) {
+  emit_rex(a, true, reg, base);
+  emit8(a, 0x3b);
+  emit_mem(a, reg, base, disp);
+}
+
+// mov [base + disp], reg
+static void emit_store(b_jit_asm *a, int base, int32_t disp, int reg) {
+  emit_rex(a, true, reg, base);
+  emit8(a, 0x89);
+  emit_mem(a, reg, base, disp);
+}
+
+// mov reg, imm64
+static void emit_mov_imm(b_jit_asm *a, int reg, uint64_t value) {
+  emit_rex(a, true, 0, reg);
+  emit8(a, 0xb8 | (reg & 7));
+  emit64(a, value);
+}
+
+// <op> dst, src for the register forms of mov, add, and, or, xor and cmp
+static void emit_alu(b_jit_asm *a, uint8_t op, int dst, int src) {
+  emit_rex(a, true, src, dst);
+  emit8(a, op);
+  emit8(a, 0xc0 | ((src & 7) << 3) | (dst & 7));
+}
+
+#define ALU_ADD 0x01
+#define ALU_OR 0x09
+#define ALU_AND 0x21
+#define ALU_SUB 0x29
+#define ALU_XOR 0x31
+#define ALU_CMP 0x39
+#define ALU_MOV 0x89
+
+// add reg, imm32
+static void emit_add_imm(b_jit_asm *a, int reg, int32_t value) {
+  emit_rex(a, true, 0, reg);
+  emit8(a, 0x81);
+  emit8(a, 0xc0 | (reg & 7));
+  emit32(a, (uint32_t) value);
+}
+
+// shl, shr or sar reg, imm8
+static void emit_shift(b_jit_asm *a, int kind, int reg, uint8_t count) {
+  emit_rex(a, true, 0, reg);
+  emit8(a, 0xc1);
+  emit8(a, 0xc0 | (kind << 3) | (reg & 7));
+  emit8(a, count);
+}
+
+#define SHIFT_SHL 4
+#define SHIFT_SHR 5
+#define SHIFT_SAR 7
+
+// cmp reg, imm32
+static void emit_cmp_imm(b_jit_asm *a, int reg, int32_t value) {
+  emit_rex(a, true, 0, reg);
+  emit8(a, 0x81);
+  emit8(a, 0xf8 | (reg & 7));
+  emit32(a, (uint32_t) value);
+}
+
+// imul dst, src
+static void emit_imul(b_jit_asm *a, int dst, int src) {
+  emit_rex(a, true, dst, src);
+  emit8(a, 0x0f);
+  emit8(a, 0xaf);
+  emit8(a, 0xc0 | ((dst & 7) << 3) | (src & 7));
+}
+
+// cvtsi2sd xmm, reg
+static void emit_int_to_xmm(b_jit_asm *a, int xmm, int reg) {
+  emit8(a, 0xf2);
+  emit_rex(a, true, xmm, reg);
+  emit8(a, 0x0f);
+  emit8(a, 0x2a);
+  emit8(a, 0xc0 | ((xmm & 7) << 3) | (reg & 7));
+}
+
+// movq xmm, reg
+static void emit_to_xmm(b_jit_asm *a, int xmm, int reg) {
+  emit8(a, 0x66);
+  emit_rex(a, true, xmm, reg);
+  emit8(a, 0x0f);
+  emit8(a, 0x6e);
+  emit8(a, 0xc0 | ((xmm & 7) << 3) | (reg & 7));
+}
+
+// movq reg, xmm
+static void emit_from_xmm(b_jit_asm *a, int reg, int xmm) {
+  emit8(a, 0x66);
+  emit_rex(a, true, xmm, reg);
+  emit8(a, 0x0f);
+  emit8(a, 0x7e);
+  emit8(a, 0xc0 | ((xmm & 7) << 3) | (reg & 7));
+}
+
+// scalar double operation between two xmm registers
+static void emit_sse(b_jit_asm *a, uint8_t prefix, uint8_t op, int dst, int src) {
+  emit8(a, prefix);
+  emit8(a, 0x0f);
+  emit8(a, op);
+  emit8(a, 0xc0 | ((dst & 7) << 3) | (src & 7));
+}
+
+#define SSE_ADD 0x58
+#define SSE_MUL 0x59
+#define SSE_SUB 0x5c
+#define SSE_DIV 0x5e
+
+// ucomisd dst, src
+static void emit_ucomisd(b_jit_asm *a, int dst, int src) {
+  emit_sse(a, 0x66, 0x2e, dst, src);
+}
+
+// setcc al; movzx eax, al
+static void emit_setcc(b_jit_asm *a, int cc) {
+  emit8(a, 0x0f);
+  emit8(a, 0x90 | cc);
+  emit8(a, 0xc0);
+  emit8(a, 0x0f);
+  emit8(a, 0xb6);
+  emit8(a, 0xc0);
+}
+
+// jcc rel32, returns the position of the offset to patch
+static int emit_jcc(b_jit_asm *a, int cc) {
+  emit8(a, 0x0f);
+  emit8(a, 0x80 | cc);
+  emit32(a, 0);
+  return a->count - 4;
+}
+
+// jmp rel32, returns the position of the offset to patch
+static int emit_jmp(b_jit_asm *a) {
+  emit8(a, 0xe9);
+  emit32(a, 0);
+  return a->count - 4;
+}
+
+static void emit_call(b_jit_asm *a, void *function) {
+  emit_mov_imm(a, RAX, (uint64_t) (uintptr_t) function);
+  emit8(a, 0xff);
+  emit8(a, 0xd0);
+}
+
+// test reg, reg
+static void emit_test(b_jit_asm *a, int reg, bool wide) {
+  emit_rex(a, wide, reg, reg);
+  emit8(a, 0x85);
+  emit8(a, 0xc0 | ((reg & 7) << 3) | (reg & 7));
+}
+
+// --> vm stack helpers
+
+static inline void emit_push(b_jit_asm *a, int reg) {
+  a->pushes++;
+  emit_store(a, REG_TOP, 0, reg);
+  emit_add_imm(a, REG_TOP, sizeof(b_value));
+}
+
+static inline void emit_push_value(b_jit_asm *a, b_value value) {
+  emit_mov_imm(a, RAX, value);
+  emit_push(a, RAX);
+}
+
+static inline void emit_peek(b_jit_asm *a, int reg, int distance) {
+  emit_load(a, reg, REG_TOP, -(int32_t) sizeof(b_value) * (distance + 1));
+}
+
+static inline void emit_drop(b_jit_asm *a, int count) {
+  if (count > 0) {
+    emit_add_imm(a, REG_TOP, -(int32_t) sizeof(b_value) * count);
+  }
+}
+
+static inline void emit_jump_to(b_jit_asm *a, int cc, int target) {
+  int patch = cc < 0 ? emit_jmp(a) : emit_jcc(a, cc);
+  add_fix(a, &a->jumps, &a->jump_count, &a->jump_capacity, patch, target);
+}
+
+// leaves the native code so the interpreter runs the instruction at offset.
+static void emit_exit_to(b_jit_asm *a, int offset) {
+  emit_mov_imm(a, RAX, (uint64_t) (uintptr_t) (a->function->blob.code + offset));
+  int patch = emit_jmp(a);
+  patch32(a, patch, a->exit);
+}
+
+// jumps out to the interpreter at offset when the condition holds.
+static inline void emit_guard(b_jit_asm *a, int cc, int offset) {
+  int patch = emit_jcc(a, cc);
+  add_fix(a, &a->exits, &a->exit_count, &a->exit_capacity, patch, offset);
+}
+
+// leaves for the interpreter at offset unless reg holds a double.
+static void emit_number_guard(b_jit_asm *a, int reg, int offset) {
+  emit_alu(a, ALU_MOV, RCX, reg);
+  emit_alu(a, ALU_AND, RCX, REG_QNAN);
+  emit_alu(a, ALU_CMP, RCX, REG_QNAN);
+  emit_guard(a, CC_E, offset);
+}
+
+// jumps to the returned patch unless reg holds an integer.
+static int emit_not_integer(b_jit_asm *a, int reg) {
+  emit_alu(a, ALU_MOV, RCX, reg);
+  emit_shift(a, SHIFT_SHR, RCX, 48);
+  emit_cmp_imm(a, RCX, (int32_t) ((QNAN | INTEGER_TAG) >> 48));
+  return emit_jcc(a, CC_NE);
+}
+
+// moves the number in reg into xmm as a double, leaving for the
+// interpreter at offset when it is not a number. reg is clobbered.
+static void emit_to_double(b_jit_asm *a, int xmm, int reg, int offset) {
+  int not_integer = emit_not_integer(a, reg);
+  emit_shift(a, SHIFT_SHL, reg, 16);
+  emit_shift(a, SHIFT_SAR, reg, 16);
+  emit_int_to_xmm(a, xmm, reg);
+  int done = emit_jmp(a);
+
+  patch32(a, not_integer, a->count);
+  emit_number_guard(a, reg, offset);
+  emit_to_xmm(a, xmm, reg);
+  patch32(a, done, a->count);
+}
+
+// computes dst op src when both hold integers, leaving the tagged result
+// in dst. the payloads are worked on in the top 48 bits of the registers,
+// so the overflow flag is set exactly when the result no longer fits.
+// returns the number of jumps written to slow, taken for anything that
+// has to be computed with doubles instead.
+static int emit_integer_arithmetic(b_jit_asm *a, uint8_t op, int dst, int src, int *slow) {
+  int count = 0;
+  slow[count++] = emit_not_integer(a, dst);
+  slow[count++] = emit_not_integer(a, src);
+  emit_shift(a, SHIFT_SHL, dst, 16);
+  emit_shift(a, SHIFT_SHL, src, 16);
+  if (op == SSE_MUL) {
+    emit_shift(a, SHIFT_SAR, src, 16);
+    emit_imul(a, dst, src);
+  } else {
+    emit_alu(a, op == SSE_ADD ? ALU_ADD : ALU_SUB, dst, src);
+  }
+  slow[count++] = emit_jcc(a, CC_O);
+  if (op == SSE_MUL) {
+    // a zero product may have to be -0.
+    emit_test(a, dst, true);
+    slow[count++] = emit_jcc(a, CC_E);
+  }
+  emit_shift(a, SHIFT_SHR, dst, 16);
+  emit_mov_imm(a, RCX, QNAN | INTEGER_TAG);
+  emit_alu(a, ALU_OR, dst, RCX);
+  return count;
+}
+
+// shifts the payloads of two integers into the top of their registers,
+// where they compare like the integers do. jumps to slow otherwise.
+static void emit_integer_operands(b_jit_asm *a, int first, int second, int *slow) {
+  slow[0] = emit_not_integer(a, first);
+  slow[1] = emit_not_integer(a, second);
+  emit_shift(a, SHIFT_SHL, first, 16);
+  emit_shift(a, SHIFT_SHL, second, 16);
+}
+
+// turns the flag in eax into a boolean value.
+static void emit_box_bool(b_jit_asm *a) {
+  emit_mov_imm(a, RCX, FALSE_VAL);
+  emit_alu(a, ALU_OR, RAX, RCX);
+}
+
+// loads the two number operands on top of the stack into xmm0 and xmm1.
+static void emit_number_operands(b_jit_asm *a, int offset) {
+  emit_peek(a, RAX, 0);
+  emit_peek(a, RDX, 1);
+  emit_to_double(a, XMM1, RAX, offset);
+  emit_to_double(a, XMM0, RDX, offset);
+}
+
+static void emit_arithmetic(b_jit_asm *a, uint8_t op, int offset) {
+  int slow[4], count = 0, done = -1;
+  if (op != SSE_DIV) {
+    emit_peek(a, RAX, 0);
+    emit_peek(a, RDX, 1);
+    count = emit_integer_arithmetic(a, op, RDX, RAX, slow);
+    emit_drop(a, 1);
+    emit_store(a, REG_TOP, -(int32_t) sizeof(b_value), RDX);
+    done = emit_jmp(a);
+  }
+  for (int i = 0; i < count; i++) {
+    patch32(a, slow[i], a->count);
+  }
+
+  emit_number_operands(a, offset);
+  emit_sse(a, 0xf2, op, XMM0, XMM1);
+  emit_from_xmm(a, RAX, XMM0);
+  emit_drop(a, 1);
+  emit_store(a, REG_TOP, -(int32_t) sizeof(b_value), RAX);
+  if (done >= 0) {
+    patch32(a, done, a->count);
+  }
+}
+
+// compares a (xmm0) against b (xmm1). an unordered result is false for
+// both < and >, so a < b is tested as b > a.
+static int emit_compare(b_jit_asm *a, bool less) {
+  if (less) {
+    emit_ucomisd(a, XMM1, XMM0);
+  } else {
+    emit_ucomisd(a, XMM0, XMM1);
+  }
+  return CC_A;
+}
+
+static void emit_comparison(b_jit_asm *a, bool less, int offset) {
+  emit_number_operands(a, offset);
+  emit_setcc(a, emit_compare(a, less));
+  emit_box_bool(a);
+  emit_drop(a, 1);
+  emit_store(a, REG_TOP, -(int32_t) sizeof(b_value), RAX);
+}
+
+// loads a register operand into reg.
+static void emit_register(b_jit_asm *a, int reg, uint16_t operand) {
+  if (operand & REG_CONSTANT) {
+    emit_mov_imm(a, reg, a->function->blob.constants.values[operand & ~REG_CONSTANT]);
+  } else {
+    emit_load(a, reg, REG_SLOTS, operand * sizeof(b_value));
+  }
+}
+
+// loads two number registers into xmm0 and xmm1, leaving for the stack
+// instructions at fallback when either is not a number.
+static void emit_number_registers(b_jit_asm *a, uint16_t first, uint16_t second, int fallback) {
+  emit_register(a, RDX, first);
+  emit_register(a, RAX, second);
+  emit_to_double(a, XMM0, RDX, fallback);
+  emit_to_double(a, XMM1, RAX, fallback);
+}
+
+// jumps to target when the value in rax is false.
+static void emit_jump_if_false(b_jit_asm *a, int target) {
+  emit_mov_imm(a, RCX, TRUE_VAL);
+  emit_alu(a, ALU_CMP, RAX, RCX);
+  int is_true = emit_jcc(a, CC_E);
+
+  emit_mov_imm(a, RCX, FALSE_VAL);
+  emit_alu(a, ALU_CMP, RAX, RCX);
+  emit_jump_to(a, CC_E, target);
+
+  emit_alu(a, ALU_MOV, RDI, RAX);
+  emit_call(a, (void *) is_false);
+  emit8(a, 0x84); // test al, al
+  emit8(a, 0xc0);
+  emit_jump_to(a, CC_NE, target);
+
+  patch32(a, is_true, a->count);
+}
+
+// replaces the instance on top of the stack with the field the inline
+// cache resolved for it. only the first receiver of the site is checked
+// and everything else, including cached methods, goes to the interpreter.
+// shapes belong to a single class, so the shape alone identifies the
+// receiver, and fields shadow methods, so the class version can be ignored.
+static void emit_cached_field(b_jit_asm *a, b_inline_cache *cache, int offset) {
+  emit_peek(a, RAX, 0);
+  emit_mov_imm(a, RCX, QNAN | SIGN_BIT);
+  emit_alu(a, ALU_MOV, RDX, RAX);
+  emit_alu(a, ALU_AND, RDX, RCX);
+  emit_alu(a, ALU_CMP, RDX, RCX);
+  emit_guard(a, CC_NE, offset);
+  emit_mov_imm(a, RCX, ~(QNAN | SIGN_BIT));
+  emit_alu(a, ALU_AND, RAX, RCX);
+
+  emit_load32(a, RCX, RAX, offsetof(b_obj, type));
+  emit8(a, 0x81); // cmp ecx, OBJ_INSTANCE
+  emit8(a, 0xf9);
+  emit32(a, OBJ_INSTANCE);
+  emit_guard(a, CC_NE, offset);
+
+  emit_mov_imm(a, RDX, (uint64_t) (uintptr_t) cache);
+  emit_load32(a, RCX, RDX, offsetof(b_inline_cache, count));
+  emit_test(a, RCX, false);
+  emit_guard(a, CC_E, offset);
+
+  emit_load(a, RCX, RAX, offsetof(b_obj_instance, shape));
+  emit_test(a, RCX, true);
+  emit_guard(a, CC_E, offset);
+  emit_cmp_mem(a, RCX, RDX, offsetof(b_inline_cache, entries) + offsetof(b_cache_entry, shape));
+  emit_guard(a, CC_NE, offset);
+
+  emit_load32(a, RCX, RDX, offsetof(b_inline_cache, entries) + offsetof(b_cache_entry, slot));
+  emit_test(a, RCX, false);
+  emit_guard(a, CC_S, offset);
+
+  emit_load(a, RDX, RAX, offsetof(b_obj_instance, fields));
+  emit8(a, 0x48); // mov rax, [rdx + rcx * 8]
+  emit8(a, 0x8b);
+  emit8(a, 0x04);
+  emit8(a, 0xca);
+  emit_store(a, REG_TOP, -(int32_t) sizeof(b_value), RAX);
+}
+
+static inline uint16_t read_short(const uint8_t *code, int offset) {
+  return (uint16_t) ((code[offset] << 8) | code[offset + 1]);
+}
+
+static void emit_prologue(b_jit_asm *a) {
+  emit8(a, 0x55); // push rbp
+  emit8(a, 0x53); // push rbx
+  emit8(a, 0x41); // push r12
+  emit8(a, 0x54);
+  emit8(a, 0x41); // push r13
+  emit8(a, 0x55);
+  emit8(a, 0x41); // push r14
+  emit8(a, 0x56);
+  emit8(a, 0x41); // push r15
+  emit8(a, 0x57);
+  emit_add_imm(a, RSP, -8); // keep the stack 16 byte aligned for calls
+
+  emit_alu(a, ALU_MOV, REG_VM, RDI);
+  emit_alu(a, ALU_MOV, REG_FRAME, RSI);
+  emit_load(a, REG_SLOTS, REG_FRAME, offsetof(b_call_frame, slots));
+  emit_load(a, REG_TOP, REG_VM, offsetof(b_vm, stack_top));
+  emit_mov_imm(a, REG_QNAN, QNAN);
+  emit8(a, 0xff); // jmp rdx
+  emit8(a, 0xe2);
+
+  // everything leaves through here with the instruction to resume in rax.
+  a->exit = a->count;
+  emit_store(a, REG_VM, offsetof(b_vm, stack_top), REG_TOP);
+  emit_add_imm(a, RSP, 8);
+  emit8(a, 0x41); // pop r15
+  emit8(a, 0x5f);
+  emit8(a, 0x41); // pop r14
+  emit8(a, 0x5e);
+  emit8(a, 0x41); // pop r13
+  emit8(a, 0x5d);
+  emit8(a, 0x41); // pop r12
+  emit8(a, 0x5c);
+  emit8(a, 0x5b); // pop rbx
+  emit8(a, 0x5d); // pop rbp
+  emit8(a, 0xc3); // ret
+}
+
+// emits the template for the instruction at offset. returns false if the
+// instruction is always left to the interpreter.
+static bool emit_instruction(b_jit_asm *a, int offset, int length) {
+  b_obj_func *function = a->function;
+  uint8_t *code = function->blob.code;
+  b_value *constants = function->blob.constants.values;
+  int next = offset + length;
+
+  switch (code[offset]) {
+    case OP_CONSTANT:
+      emit_push_value(a, constants[read_short(code, offset + 1)]);
+      break;
+    case OP_NIL:
+      emit_push_value(a, NIL_VAL);
+      break;
+    case OP_TRUE:
+      emit_push_value(a, TRUE_VAL);
+      break;
+    case OP_FALSE:
+      emit_push_value(a, FALSE_VAL);
+      break;
+    case OP_EMPTY:
+      emit_push_value(a, EMPTY_VAL);
+      break;
+    case OP_ONE:
+      emit_push_value(a, INTEGER_VAL(1));
+      break;
+
+    case OP_POP:
+      emit_drop(a, 1);
+      break;
+    case OP_POP_N:
+      emit_drop(a, read_short(code, offset + 1));
+      break;
+    case OP_DUP:
+      emit_peek(a, RAX, 0);
+      emit_push(a, RAX);
+      break;
+
+    case OP_GET_LOCAL:
+      emit_load(a, RAX, REG_SLOTS, read_short(code, offset + 1) * sizeof(b_value));
+      emit_push(a, RAX);
+      break;
+    case OP_GET_LOCALS:
+      emit_load(a, RAX, REG_SLOTS, read_short(code, offset + 1) * sizeof(b_value));
+      emit_push(a, RAX);
+      emit_load(a, RAX, REG_SLOTS, read_short(code, offset + 3) * sizeof(b_value));
+      emit_push(a, RAX);
+      break;
+    case OP_GET_LOCAL_CONSTANT:
+      emit_load(a, RAX, REG_SLOTS, read_short(code, offset + 1) * sizeof(b_value));
+      emit_push(a, RAX);
+      emit_push_value(a, constants[read_short(code, offset + 3)]);
+      break;
+    case OP_SET_LOCAL:
+    case OP_SET_LOCAL_POP:
+      emit_peek(a, RAX, 0);
+      emit_alu(a, ALU_CMP, RAX, REG_QNAN); // empty cannot be assigned
+      emit_guard(a, CC_E, offset);
+      emit_store(a, REG_SLOTS, read_short(code, offset + 1) * sizeof(b_value), RAX);
+      if (code[offset] == OP_SET_LOCAL_POP) {
+        emit_drop(a, 1);
+      }
+      break;
+
+    case OP_GET_UP_VALUE:
+    case OP_SET_UP_VALUE: {
+      int index = read_short(code, offset + 1);
+      if (code[offset] == OP_SET_UP_VALUE) {
+        emit_peek(a, RDX, 0);
+        emit_alu(a, ALU_CMP, RDX, REG_QNAN);
+        emit_guard(a, CC_E, offset);
+      }
+      emit_load(a, RAX, REG_FRAME, offsetof(b_call_frame, closure));
+      emit_load(a, RAX, RAX, offsetof(b_obj_closure, up_values));
+      emit_load(a, RSI, RAX, index * sizeof(b_obj_up_value *));
+      emit_load(a, RAX, RSI, offsetof(b_obj_up_value, location));
+      if (code[offset] == OP_SET_UP_VALUE) {
+        emit_store(a, RAX, 0, RDX);
+        emit_alu(a, ALU_MOV, RDI, REG_VM);
+        emit_call(a, (void *) up_value_barrier);
+      } else {
+        emit_load(a, RAX, RAX, 0);
+        emit_push(a, RAX);
+      }
+      break;
+    }
+
+    case OP_GET_GLOBAL:
+    case OP_SET_GLOBAL: {
+      // globals missing from the module are left to the interpreter.
+      if (code[offset] == OP_SET_GLOBAL) {
+        emit_peek(a, RAX, 0);
+        emit_alu(a, ALU_CMP, RAX, REG_QNAN);
+        emit_guard(a, CC_E, offset);
+      }
+      emit_mov_imm(a, RDI, (uint64_t) (uintptr_t) function->module);
+      emit_mov_imm(a, RSI, read_short(code, offset + 3));
+      emit_mov_imm(a, RDX, (uint64_t) (uintptr_t) AS_STRING(constants[read_short(code, offset + 1)]));
+      emit_call(a, (void *) find_global_entry);
+      emit_test(a, RAX, true);
+      emit_guard(a, CC_E, offset);
+      if (code[offset] == OP_SET_GLOBAL) {
+        emit_peek(a, RDX, 0);
+        emit_store(a, RAX, offsetof(b_entry, value), RDX);
+        emit_alu(a, ALU_MOV, RDI, REG_VM);
+        emit_mov_imm(a, RSI, (uint64_t) (uintptr_t) function->module);
+        emit_call(a, (void *) gc_write_barrier);
+      } else {
+        emit_load(a, RAX, RAX, offsetof(b_entry, value));
+        emit_push(a, RAX);
+      }
+      break;
+    }
+
+    case OP_ADD:
+    case OP_ADD_NUM:
+      emit_arithmetic(a, SSE_ADD, offset);
+      break;
+    case OP_SUBTRACT:
+    case OP_SUBTRACT_NUM:
+      emit_arithmetic(a, SSE_SUB, offset);
+      break;
+    case OP_MULTIPLY:
+    case OP_MULTIPLY_NUM:
+      emit_arithmetic(a, SSE_MUL, offset);
+      break;
+    case OP_DIVIDE:
+    case OP_DIVIDE_NUM:
+      emit_arithmetic(a, SSE_DIV, offset);
+      break;
+    case OP_NEGATE:
+      // integers are negated as doubles, which also gets -0 right.
+      emit_peek(a, RAX, 0);
+      emit_to_double(a, XMM0, RAX, offset);
+      emit_from_xmm(a, RAX, XMM0);
+      emit_mov_imm(a, RCX, SIGN_BIT);
+      emit_alu(a, ALU_XOR, RAX, RCX);
+      emit_store(a, REG_TOP, -(int32_t) sizeof(b_value), RAX);
+      break;
+
+    case OP_LESS:
+    case OP_LESS_NUM:
+      emit_comparison(a, true, offset);
+      break;
+    case OP_GREATER:
+    case OP_GREATER_NUM:
+      emit_comparison(a, false, offset);
+      break;
+    case OP_EQUAL: {
+      // doubles compare by value and identical values are equal. anything
+      // else may still be an integer and a double of the same number.
+      emit_peek(a, RAX, 0);
+      emit_peek(a, RDX, 1);
+      emit_alu(a, ALU_MOV, RCX, RAX);
+      emit_alu(a, ALU_AND, RCX, REG_QNAN);
+      emit_alu(a, ALU_CMP, RCX, REG_QNAN);
+      int not_number = emit_jcc(a, CC_E);
+      emit_alu(a, ALU_MOV, RCX, RDX);
+      emit_alu(a, ALU_AND, RCX, REG_QNAN);
+      emit_alu(a, ALU_CMP, RCX, REG_QNAN);
+      int not_number2 = emit_jcc(a, CC_E);
+
+      emit_to_xmm(a, XMM0, RDX);
+      emit_to_xmm(a, XMM1, RAX);
+      emit_ucomisd(a, XMM0, XMM1);
+      emit8(a, 0x0f); // sete al
+      emit8(a, 0x94);
+      emit8(a, 0xc0);
+      emit8(a, 0x0f); // setnp cl
+      emit8(a, 0x9b);
+      emit8(a, 0xc1);
+      emit8(a, 0x20); // and al, cl
+      emit8(a, 0xc8);
+      int done = emit_jmp(a);
+
+      patch32(a, not_number, a->count);
+      patch32(a, not_number2, a->count);
+      emit_alu(a, ALU_MOV, RDI, RDX);
+      emit_alu(a, ALU_MOV, RSI, RAX);
+      emit_alu(a, ALU_CMP, RDX, RAX);
+      emit8(a, 0x0f); // sete al
+      emit8(a, 0x94);
+      emit8(a, 0xc0);
+      int same = emit_jcc(a, CC_E);
+      emit_call(a, (void *) values_equal);
+
+      patch32(a, done, a->count);
+      patch32(a, same, a->count);
+      emit8(a, 0x0f); // movzx eax, al
+      emit8(a, 0xb6);
+      emit8(a, 0xc0);
+      emit_box_bool(a);
+      emit_drop(a, 1);
+      emit_store(a, REG_TOP, -(int32_t) sizeof(b_value), RAX);
+      break;
+    }
+    case OP_NOT:
+      emit_peek(a, RDI, 0);
+      emit_call(a, (void *) is_false);
+      emit8(a, 0x0f); // movzx eax, al
+      emit8(a, 0xb6);
+      emit8(a, 0xc0);
+      emit_box_bool(a);
+      emit_store(a, REG_TOP, -(int32_t) sizeof(b_value), RAX);
+      break;
+
+    case OP_JUMP:
+      emit_jump_to(a, -1, next + read_short(code, offset + 1));
+      break;
+    case OP_JUMP_IF_FALSE:
+      emit_peek(a, RAX, 0);
+      emit_jump_if_false(a, next + read_short(code, offset + 1));
+      break;
+    case OP_POP_JUMP_IF_FALSE:
+      emit_peek(a, RAX, 0);
+      emit_drop(a, 1);
+      emit_jump_if_false(a, next + read_short(code, offset + 1));
+      break;
+    case OP_LOOP:
+      emit_jump_to(a, -1, next - read_short(code, offset + 1));
+      break;
+    case OP_LESS_JUMP:
+    case OP_GREATER_JUMP: {
+      bool less = code[offset] == OP_LESS_JUMP;
+      int target = next + read_short(code, offset + 1), slow[2];
+      emit_peek(a, RAX, 0);
+      emit_peek(a, RDX, 1);
+      emit_integer_operands(a, RDX, RAX, slow);
+      emit_drop(a, 2);
+      emit_alu(a, ALU_CMP, RDX, RAX);
+      emit_jump_to(a, (less ? CC_L : CC_G) ^ 1, target);
+      int done = emit_jmp(a);
+
+      patch32(a, slow[0], a->count);
+      patch32(a, slow[1], a->count);
+      emit_number_operands(a, offset);
+      emit_drop(a, 2);
+      emit_jump_to(a, emit_compare(a, less) ^ 1, target);
+      patch32(a, done, a->count);
+      break;
+    }
+
+    case OP_REG_MOVE:
+      emit_register(a, RAX, read_short(code, offset + 3));
+      emit_alu(a, ALU_CMP, RAX, REG_QNAN); // empty cannot be assigned
+      emit_guard(a, CC_E, next);
+      emit_store(a, REG_SLOTS, read_short(code, offset + 1) * sizeof(b_value), RAX);
+      emit_jump_to(a, -1, next + read_short(code, offset + 5));
+      break;
+    case OP_REG_ADD:
+    case OP_REG_SUBTRACT:
+    case OP_REG_MULTIPLY:
+    case OP_REG_DIVIDE: {
+      static const uint8_t ops[] = {SSE_ADD, SSE_SUB, SSE_MUL, SSE_DIV};
+      uint8_t op = ops[code[offset] - OP_REG_ADD];
+      uint16_t dst = read_short(code, offset + 1);
+      uint16_t first = read_short(code, offset + 3), second = read_short(code, offset + 5);
+      int slow[4], count = 0, done = -1;
+      if (op != SSE_DIV) {
+        emit_register(a, RDX, first);
+        emit_register(a, RAX, second);
+        count = emit_integer_arithmetic(a, op, RDX, RAX, slow);
+        emit_alu(a, ALU_MOV, RAX, RDX);
+        done = emit_jmp(a);
+      }
+      for (int i = 0; i < count; i++) {
+        patch32(a, slow[i], a->count);
+      }
+      emit_number_registers(a, first, second, next);
+      emit_sse(a, 0xf2, op, XMM0, XMM1);
+      emit_from_xmm(a, RAX, XMM0);
+      if (done >= 0) {
+        patch32(a, done, a->count);
+      }
+      if (dst == REG_PUSH) {
+        emit_push(a, RAX);
+      } else {
+        emit_store(a, REG_SLOTS, dst * sizeof(b_value), RAX);
+      }
+      emit_jump_to(a, -1, next + read_short(code, offset + 7));
+      break;
+    }
+    case OP_REG_LESS_JUMP:
+    case OP_REG_GREATER_JUMP: {
+      bool less = code[offset] == OP_REG_LESS_JUMP;
+      uint16_t first = read_short(code, offset + 1), second = read_short(code, offset + 3);
+      int slow[2];
+      emit_register(a, RDX, first);
+      emit_register(a, RAX, second);
+      emit_integer_operands(a, RDX, RAX, slow);
+      emit_alu(a, ALU_CMP, RDX, RAX);
+      emit_jump_to(a, (less ? CC_L : CC_G) ^ 1, next + read_short(code, offset + 7));
+      emit_jump_to(a, -1, next + read_short(code, offset + 5));
+
+      patch32(a, slow[0], a->count);
+      patch32(a, slow[1], a->count);
+      emit_number_registers(a, first, second, next);
+      emit_jump_to(a, emit_compare(a, less) ^ 1, next + read_short(code, offset + 7));
+      emit_jump_to(a, -1, next + read_short(code, offset + 5));
+      break;
+    }
+
+    case OP_ITER_NEXT: {
+      // iterate() may allocate the value, so the collector has to see the
+      // stack as it is.
+      emit_store(a, REG_VM, offsetof(b_vm, stack_top), REG_TOP);
+      emit_alu(a, ALU_MOV, RDI, REG_VM);
+      emit_alu(a, ALU_MOV, RSI, REG_SLOTS);
+      emit_add_imm(a, RSI, read_short(code, offset + 1) * sizeof(b_value));
+      emit_call(a, (void *) iterate);
+      emit8(a, 0x83); // cmp eax, ITER_CONTINUE
+      emit8(a, 0xf8);
+      emit8(a, ITER_CONTINUE);
+      emit_jump_to(a, CC_E, next + read_short(code, offset + 3));
+      emit8(a, 0x83); // cmp eax, ITER_DONE
+      emit8(a, 0xf8);
+      emit8(a, ITER_DONE);
+      emit_jump_to(a, CC_E, next + read_short(code, offset + 5));
+      // user iterables run their methods in the interpreter.
+      emit_exit_to(a, next);
+      break;
+    }
+
+    case OP_GET_PROPERTY:
+    case OP_GET_SELF_PROPERTY:
+      emit_cached_field(a, &function->blob.caches[read_short(code, offset + 3)], offset);
+      break;
+
+    default:
+      // calls, returns, objects and anything else that may need the
+      // heap or raise an exception.
+      emit_exit_to(a, offset);
+      return false;
+  }
+  return true;
+}
+
+bool jit_compile(b_vm *vm, b_obj_func *function) {
+  b_blob *blob = &function->blob;
+
+  b_jit_asm a;
+  memset(&a, 0, sizeof(b_jit_asm));
+  a.vm = vm;
+  a.function = function;
+
+  int *map = malloc(sizeof(int) * (blob->count + 1));
+  int *runs = malloc(sizeof(int) * (blob->count + 1));
+  int *starts = malloc(sizeof(int) * (blob->count + 1));
+  if (map == NULL || runs == NULL || starts == NULL) {
+    free(map);
+    free(runs);
+    free(starts);
+    function->jit_counter = -1;
+    return false;
+  }
+
+  emit_prologue(&a);
+
+  // a run of native code pushes at most every value its templates push,
+  // fused local loads pushing two. one more is left for whatever the
+  // functions native code calls push.
+  int start_count = 0;
+  for (int offset = 0; offset < blob->count;) {
+    int length = 1 + get_code_args_count(blob->code, blob->constants.values, offset);
+    map[offset] = a.count;
+    runs[offset] = emit_instruction(&a, offset, length) ? 1 : 0;
+    starts[start_count++] = offset;
+    offset += length;
+  }
+  map[blob->count] = a.count;
+  runs[blob->count] = 0;
+  starts[start_count] = blob->count;
+  emit_exit_to(&a, blob->count);
+
+  for (int i = 0; i < a.jump_count; i++) {
+    patch32(&a, a.jumps[i].patch, map[a.jumps[i].target]);
+  }
+  for (int i = 0; i < a.exit_count; i++) {
+    patch32(&a, a.exits[i].patch, a.count);
+    emit_exit_to(&a, a.exits[i].target);
+  }
+
+  // count how far native code gets from each instruction in a straight
+  // line. a loop back edge is always worth it.
+  for (int i = start_count - 1; i >= 0; i--) {
+    int offset = starts[i];
+    if (runs[offset] != 0) {
+      runs[offset] = blob->code[offset] == OP_LOOP ? MIN_NATIVE_RUN : 1 + runs[starts[i + 1]];
+    }
+    if (runs[offset] < MIN_NATIVE_RUN) {
+      map[offset] = -1;
+    }
+  }
+  free(runs);
+  free(starts);
+
+  b_jit_code *jit = NULL;
+  void *memory = MAP_FAILED;
+  size_t size = ((size_t) a.count + 4095) & ~(size_t) 4095;
+
+  if (!a.failed) {
+    memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  }
+  if (memory != MAP_FAILED) {
+    memcpy(memory, a.code, a.count);
+    if (mprotect(memory, size, PROT_READ | PROT_EXEC) == 0) {
+      jit = ALLOCATE(b_jit_code, 1);
+      jit->code = memory;
+      jit->size = size;
+      jit->entry = (b_jit_entry) memory;
+      jit->map = map;
+      jit->stack_size = a.pushes + 1;
+    } else {
+      munmap(memory, size);
+    }
+  }
+
+  free(a.code);
+  free(a.jumps);
+  free(a.exits);
+
+  if (jit == NULL) {
+    free(map);
+    function->jit_counter = -1;
+    return false;
+  }
+
+  function->jit = jit;
+  return true;
+}
+
+void free_jit_code(b_vm *vm, b_obj_func *function) {
+  b_jit_code *jit = function->jit;
+  if (jit != NULL) {
+    munmap(jit->code, jit->size);
+    free(jit->map);
+    FREE(b_jit_code, jit);
+    function->jit = NULL;
+  }
+}
+
+#else
+
+bool jit_compile(b_vm *vm, b_obj_func *function) {
+  function->jit_counter = -1;
+  return false;
+}
+
+void free_jit_code(b_vm *vm, b_obj_func *function) {}
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef BLADE_JIT_H
+#define BLADE_JIT_H
+
+#include "common.h"
+#include "config.h"
+#include "object.h"
+#include "vm.h"
+
+#if defined(__x86_64__) && defined(__linux__) && defined(USE_NAN_BOXING) && USE_NAN_BOXING
+#define JIT_SUPPORTED 1
+#else
+#define JIT_SUPPORTED 0
+#endif
+
+/**
+ * native code runs the function on the vm stack exactly like the
+ * interpreter would and returns the instruction the interpreter has to
+ * continue from. it never throws: anything it cannot do, including every
+ * instruction that may raise an exception, is left to the interpreter.
+ */
+typedef uint8_t *(*b_jit_entry)(b_vm *vm, b_call_frame *frame, void *target);
+
+typedef struct b_jit_code {
+  b_jit_entry entry;
+  uint8_t *code;
+  size_t size;
+  int *map; // bytecode offset -> native code offset, -1 if not worth entering
+  int stack_size; // values native code may push before it gives control back
+} b_jit_code;
+
+/**
+ * compiles the function to native code. returns false if it could not,
+ * in which case it will not be tried again.
+ */
+bool jit_compile(b_vm *vm, b_obj_func *function);
+
+void free_jit_code(b_vm *vm, b_obj_func *function);
+
+// counts a call or loop iteration in the function and returns true once
+// the function has native code to run.
+static inline bool jit_is_hot(b_vm *vm, b_obj_func *function) {
+  if (function->jit != NULL) {
+    return true;
+  }
+  if (function->jit_counter < 0 || ++function->jit_counter < JIT_HOT_COUNT) {
+    return false;
+  }
+  return jit_compile(vm, function);
+}
+
+// runs the native code of the frame's function from the frame's current
+// instruction until it has to give control back to the interpreter.
+static inline void jit_run(b_vm *vm, b_call_frame *frame) {
+  b_obj_func *function = frame->closure->function;
+  b_jit_code *jit = function->jit;
+  int native = jit->map[frame->ip - function->blob.code];
+  if (native >= 0) {
+    // native code keeps the stack in registers, so it must not move.
+    ensure_stack(vm, jit->stack_size);
+    frame->ip = jit->entry(vm, frame, jit->code + native);
+  }
+}
+
+#endif
@@ -4,6 +4,7 @@
 
 inline void write_list(b_vm *vm, b_obj_list *list, b_value value) {
   write_value_arr(vm, &list->items, value);
+  write_barrier(vm, &list->obj, value);
 }
 
 b_obj_list *copy_list(b_vm *vm, b_obj_list *list, int start, int length) {
@@ -21,7 +22,7 @@ b_obj_list *copy_list(b_vm *vm, b_obj_list *list, int start, int length) {
 
 DECLARE_LIST_METHOD(length) {
   ENFORCE_ARG_COUNT(length, 0);
-  RETURN_NUMBER(AS_LIST(METHOD_OBJECT)->items.count);
+  RETURN_LONG(AS_LIST(METHOD_OBJECT)->items.count);
 }
 
 DECLARE_LIST_METHOD(append) {
@@ -97,6 +98,7 @@ DECLARE_LIST_METHOD(insert) {
   int index = (int) AS_NUMBER(args[1]);
 
   insert_value_arr(vm, &list->items, args[0], index);
+  write_barrier(vm, &list->obj, args[0]);
   RETURN;
 }
 
@@ -3,23 +3,54 @@
 #include "config.h"
 #include "object.h"
 #include "file.h"
+#include "jit.h"
 #include "module.h"
 
+#include "threads/threads.h"
+
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #if defined(DEBUG_GC) && DEBUG_GC
 #include "debug.h"
 #include <stdio.h>
 #endif
 
-void *c_allocate(b_vm *vm, size_t size, size_t length) {
-  vm->bytes_allocated += length;
+static void start_collection(b_vm *vm);
+static void collection_step(b_vm *vm, int budget);
+static void mark_shared(b_vm *vm, b_obj *object);
+
+void collect_if_needed(b_vm *vm) {
+  // module unloaders run while objects are freed and may allocate.
+  if (vm->gc_busy) return;
+  vm->gc_busy = true;
 
-  if (vm->bytes_allocated > vm->next_gc) {
-    collect_garbage(vm);
+  if (vm->gc_phase != GC_IDLE) {
+    // a heap outgrowing the steps is finished in one go.
+    if (vm->bytes_allocated > vm->next_gc * 2) {
+      collect_garbage(vm);
+    } else {
+      collection_step(vm, vm->gc_step_budget);
+    }
+  } else if (vm->bytes_allocated > vm->next_gc) {
+    if (vm->gc_step_budget > 0) {
+      start_collection(vm);
+    } else {
+      collect_garbage(vm);
+    }
+  } else if (vm->bytes_allocated > vm->next_minor_gc) {
+    collect_young_garbage(vm);
   }
 
+  vm->gc_busy = false;
+}
+
+void *c_allocate(b_vm *vm, size_t size, size_t length) {
+  vm->bytes_allocated += length;
+  collect_if_needed(vm);
+
   if (size == 0) {
     return NULL;
   }
@@ -36,10 +67,7 @@ void *c_allocate(b_vm *vm, size_t size, size_t length) {
 
 void *allocate(b_vm *vm, size_t size) {
   vm->bytes_allocated += size;
-
-  if (vm->bytes_allocated > vm->next_gc) {
-    collect_garbage(vm);
-  }
+  collect_if_needed(vm);
 
   if (size == 0) {
     return NULL;
@@ -58,8 +86,8 @@ void *allocate(b_vm *vm, size_t size) {
 void *reallocate(b_vm *vm, void *pointer, size_t old_size, size_t new_size) {
   vm->bytes_allocated += new_size - old_size;
 
-  if (new_size > old_size && vm->bytes_allocated > vm->next_gc) {
-    collect_garbage(vm);
+  if (new_size > old_size) {
+    collect_if_needed(vm);
   }
 
   if (new_size == 0) {
@@ -80,7 +108,14 @@ void *reallocate(b_vm *vm, void *pointer, size_t old_size, size_t new_size) {
 void mark_object(b_vm *vm, b_obj *object) {
   if (object == NULL)
     return;
-  if (object->mark == vm->mark_value)
+  if (vm->gc_parallel) {
+    mark_shared(vm, object);
+    return;
+  }
+  if (is_marked(vm, object))
+    return;
+  // minor collections stop at the old generation.
+  if (object->old && vm->gc_minor)
     return;
 
 #if defined(DEBUG_GC) && DEBUG_GC
@@ -89,8 +124,14 @@ void mark_object(b_vm *vm, b_obj *object) {
   printf("\n");
 #endif
 
-  object->mark = vm->mark_value;
+  set_object_mark(object, vm->mark_value);
+  if (object->arena) {
+    vm->arena.marked += ARENA_PAGE(object)->slot_size;
+  }
+  gray_object(vm, object);
+}
 
+void gray_object(b_vm *vm, b_obj *object) {
   if (vm->gray_capacity < vm->gray_count + 1) {
     vm->gray_capacity = GROW_CAPACITY(vm->gray_capacity);
     vm->gray_stack = (b_obj **) realloc(vm->gray_stack, sizeof(b_obj *) * vm->gray_capacity);
@@ -109,6 +150,56 @@ void mark_value(b_vm *vm, b_value value) {
     mark_object(vm, AS_OBJ(value));
 }
 
+void remember_object(b_vm *vm, b_obj *object) {
+  object->remembered = true;
+
+  if (vm->remembered_capacity < vm->remembered_count + 1) {
+    vm->remembered_capacity = GROW_CAPACITY(vm->remembered_capacity);
+    vm->remembered = (b_obj **) realloc(vm->remembered, sizeof(b_obj *) * vm->remembered_capacity);
+
+    if (vm->remembered == NULL) {
+      fflush(stdout); // flush out anything on stdout first
+      fprintf(stderr, "GC encountered an error");
+      exit(EXIT_TERMINAL);
+    }
+  }
+  vm->remembered[vm->remembered_count++] = object;
+}
+
+void add_young_object(b_vm *vm, b_obj *object) {
+  if (vm->young_capacity < vm->young_count + 1) {
+    vm->young_capacity = GROW_CAPACITY(vm->young_capacity);
+    vm->young = (b_obj **) realloc(vm->young, sizeof(b_obj *) * vm->young_capacity);
+
+    if (vm->young == NULL) {
+      fflush(stdout); // flush out anything on stdout first
+      fprintf(stderr, "GC encountered an error");
+      exit(EXIT_TERMINAL);
+    }
+  }
+  vm->young[vm->young_count++] = object;
+}
+
+void gc_write_barrier(b_vm *vm, b_obj *owner, b_value value) {
+  write_barrier(vm, owner, value);
+}
+
+void up_value_barrier(b_vm *vm, b_obj_up_value *up_value) {
+  if (up_value->location == &up_value->closed) {
+    write_barrier(vm, &up_value->obj, up_value->closed);
+  } else if (up_value->owner != NULL) {
+    // the slot lives on the stack of a fiber that is not running.
+    write_barrier(vm, up_value->owner, *up_value->location);
+  }
+}
+
+static void forget_remembered(b_vm *vm) {
+  for (int i = 0; i < vm->remembered_count; i++) {
+    vm->remembered[i]->remembered = false;
+  }
+  vm->remembered_count = 0;
+}
+
 static void mark_array(b_vm *vm, b_value_arr *array) {
   for (int i = 0; i < array->count; i++) {
     mark_value(vm, array->values[i]);
@@ -126,6 +217,7 @@ void blacken_object(b_vm *vm, b_obj *object) {
     case OBJ_MODULE: {
       b_obj_module *module = (b_obj_module *) object;
       mark_table(vm, &module->values);
+      mark_table(vm, &module->slot_names);
       break;
     }
     case OBJ_SWITCH: {
@@ -164,6 +256,7 @@ void blacken_object(b_vm *vm, b_obj *object) {
       mark_table(vm, &klass->properties);
       mark_table(vm, &klass->static_properties);
       mark_value(vm, klass->initializer);
+      mark_shape(vm, klass->root_shape);
       if(klass->superclass != NULL) {
         mark_object(vm, (b_obj *)klass->superclass);
       }
@@ -183,17 +276,51 @@ void blacken_object(b_vm *vm, b_obj *object) {
       mark_object(vm, (b_obj *) function->name);
       mark_object(vm, (b_obj *) function->module);
       mark_array(vm, &function->blob.constants);
+      for (int i = 0; i < function->blob.cache_count; i++) {
+        b_inline_cache *cache = &function->blob.caches[i];
+        for (int j = 0; j < cache->count && j < INLINE_CACHE_SIZE; j++) {
+          mark_object(vm, (b_obj *) cache->entries[j].klass);
+          mark_value(vm, cache->entries[j].value);
+        }
+      }
       break;
     }
     case OBJ_INSTANCE: {
       b_obj_instance *instance = (b_obj_instance *) object;
       mark_object(vm, (b_obj *) instance->klass);
+      if (instance->shape != NULL) {
+        for (int i = 0; i < instance->shape->count; i++) {
+          mark_value(vm, instance->fields[i]);
+        }
+      }
       mark_table(vm, &instance->properties);
       break;
     }
 
+    case OBJ_FIBER: {
+      b_obj_fiber *fiber = (b_obj_fiber *) object;
+      mark_object(vm, (b_obj *) fiber->closure);
+      mark_object(vm, (b_obj *) fiber->parent);
+      for (b_value *slot = fiber->stack; slot < fiber->stack_top; slot++) {
+        mark_value(vm, *slot);
+      }
+      for (int i = 0; i < fiber->frame_count; i++) {
+        mark_object(vm, (b_obj *) fiber->frames[i].closure);
+      }
+      for (b_obj_up_value *up_value = fiber->open_up_values; up_value != NULL;
+           up_value = up_value->next) {
+        mark_object(vm, (b_obj *) up_value);
+      }
+      break;
+    }
+
     case OBJ_UP_VALUE: {
-      mark_value(vm, ((b_obj_up_value *) object)->closed);
+      b_obj_up_value *up_value = (b_obj_up_value *) object;
+      mark_value(vm, up_value->closed);
+      // an open up value keeps the stack it points into alive.
+      if (up_value->location != &up_value->closed) {
+        mark_object(vm, up_value->owner);
+      }
       break;
     }
 
@@ -206,6 +333,17 @@ void blacken_object(b_vm *vm, b_obj *object) {
   }
 }
 
+// gives the memory of an object back to its arena page or to malloc.
+static void release_object(b_vm *vm, b_obj *object, size_t size) {
+  if (object->arena) {
+    arena_release(vm, object);
+  } else {
+    arena_release_large(vm, object, size);
+  }
+}
+
+#define FREE_OBJ(type, object) release_object(vm, object, sizeof(type))
+
 void free_object(b_vm *vm, b_obj *object) {
 #if defined(DEBUG_GC) && DEBUG_GC
   printf("%p free type %d\n", (void *)object, object->type);
@@ -218,49 +356,52 @@ void free_object(b_vm *vm, b_obj *object) {
     case OBJ_MODULE: {
       b_obj_module *module = (b_obj_module *) object;
       free_table(vm, &module->values);
+      free_table(vm, &module->slot_names);
+      FREE_ARRAY(int, module->slots, module->slot_capacity);
       free(module->name);
       free(module->file);
       if (module->unloader != NULL && module->imported) {
-        ((b_module_loader)module->unloader)(vm);
+        call_module_loader(vm, (b_module_loader)module->unloader);
       }
       if(module->handle != NULL) {
         close_dl_module(module->handle);  // free the shared library...
       }
-      FREE(b_obj_module, object);
+      FREE_OBJ(b_obj_module, object);
       break;
     }
     case OBJ_BYTES: {
       b_obj_bytes *bytes = (b_obj_bytes *) object;
       free_byte_arr(vm, &bytes->bytes);
-      FREE(b_obj_bytes, object);
+      FREE_OBJ(b_obj_bytes, object);
       break;
     }
     case OBJ_FILE: {
       b_obj_file *file = (b_obj_file *) object;
-      if (file->mode->length != 0 && !is_std_file(file) && file->file != NULL) {
+      // the std files of every vm are the streams of the whole process.
+      if (!file->is_std && file->file != NULL) {
         fclose(file->file);
       }
-      FREE(b_obj_file, object);
+      FREE_OBJ(b_obj_file, object);
       break;
     }
     case OBJ_DICT: {
       b_obj_dict *dict = (b_obj_dict *) object;
       free_value_arr(vm, &dict->names);
       free_table(vm, &dict->items);
-      FREE(b_obj_dict, object);
+      FREE_OBJ(b_obj_dict, object);
       break;
     }
     case OBJ_LIST: {
       b_obj_list *list = (b_obj_list *) object;
       free_value_arr(vm, &list->items);
-      FREE(b_obj_list, object);
+      FREE_OBJ(b_obj_list, object);
       break;
     }
 
     case OBJ_BOUND_METHOD: {
       // a closure may be bound to multiple instances
       // for this reason, we do not free closures when freeing bound methods
-      FREE(b_obj_bound, object);
+      FREE_OBJ(b_obj_bound, object);
       break;
     }
     case OBJ_CLASS: {
@@ -268,8 +409,10 @@ void free_object(b_vm *vm, b_obj *object) {
       free_table(vm, &klass->methods);
       free_table(vm, &klass->properties);
       free_table(vm, &klass->static_properties);
+      free_shape(vm, klass->root_shape);
+      FREE_ARRAY(b_obj_class *, klass->supers, klass->depth);
       // We are not freeing the initializer because it's a closure and will still be freed accordingly later.
-      FREE(b_obj_class, object);
+      FREE_OBJ(b_obj_class, object);
       break;
     }
     case OBJ_CLOSURE: {
@@ -277,44 +420,55 @@ void free_object(b_vm *vm, b_obj *object) {
       FREE_ARRAY(b_obj_up_value *, closure->up_values, closure->up_value_count);
       // there may be multiple closures that all reference the same function
       // for this reason, we do not free functions when freeing closures
-      FREE(b_obj_closure, object);
+      FREE_OBJ(b_obj_closure, object);
+      break;
+    }
+    case OBJ_FIBER: {
+      b_obj_fiber *fiber = (b_obj_fiber *) object;
+      free(fiber->stack);
+      free(fiber->frames);
+      FREE_OBJ(b_obj_fiber, object);
       break;
     }
     case OBJ_FUNCTION: {
       b_obj_func *function = (b_obj_func *) object;
+      free_jit_code(vm, function);
       free_blob(vm, &function->blob);
-      FREE(b_obj_func, object);
+      FREE_OBJ(b_obj_func, object);
       break;
     }
     case OBJ_INSTANCE: {
       b_obj_instance *instance = (b_obj_instance *) object;
       free_table(vm, &instance->properties);
-      FREE(b_obj_instance, object);
+      if (instance->fields != instance->inline_fields) {
+        FREE_ARRAY(b_value, instance->fields, instance->field_capacity);
+      }
+      release_object(vm, object, sizeof(b_obj_instance) + sizeof(b_value) * instance->inline_capacity);
       break;
     }
     case OBJ_NATIVE: {
-      FREE(b_obj_native, object);
+      FREE_OBJ(b_obj_native, object);
       break;
     }
     case OBJ_UP_VALUE: {
-      FREE(b_obj_up_value, object);
+      FREE_OBJ(b_obj_up_value, object);
       break;
     }
     case OBJ_RANGE: {
-      FREE(b_obj_range, object);
+      FREE_OBJ(b_obj_range, object);
       break;
     }
     case OBJ_STRING: {
       b_obj_string *string = (b_obj_string *) object;
       FREE_ARRAY(char, string->chars, string->length + 1);
-      FREE(b_obj_string, object);
+      FREE_OBJ(b_obj_string, object);
       break;
     }
 
     case OBJ_SWITCH: {
       b_obj_switch *sw = (b_obj_switch *) object;
       free_table(vm, &sw->table);
-      FREE(b_obj_switch, object);
+      FREE_OBJ(b_obj_switch, object);
       break;
     }
 
@@ -323,7 +477,7 @@ void free_object(b_vm *vm, b_obj *object) {
       if(ptr->free_fn) {
         ptr->free_fn(ptr->pointer);
       }
-      FREE(b_obj_ptr, object);
+      FREE_OBJ(b_obj_ptr, object);
       break;
     }
 
@@ -336,17 +490,25 @@ static void mark_roots(b_vm *vm) {
   for (b_value *slot = vm->stack; slot < vm->stack_top; slot++) {
     mark_value(vm, *slot);
   }
+  for (int i = 0; i < vm->gc_protected; i++) {
+    mark_object(vm, vm->gc_roots[i]);
+    // native code fills the objects it protects while collections come and
+    // go, so they are traced even once promoted.
+    write_barrier_all(vm, vm->gc_roots[i]);
+  }
   for (int i = 0; i < vm->frame_count; i++) {
     mark_object(vm, (b_obj *) vm->frames[i].closure);
-    for(int j = 0; j < vm->frames[i].handlers_count; j++) {
-      b_exception_frame handler = vm->frames[i].handlers[j];
-      mark_object(vm, (b_obj *)handler.klass);
-    }
   }
   for (b_obj_up_value *up_value = vm->open_up_values; up_value != NULL;
        up_value = up_value->next) {
     mark_object(vm, (b_obj *) up_value);
   }
+  // the fibers up the resume chain hold the stacks of whoever resumed
+  // them, which up values write to without a barrier.
+  for (b_obj_fiber *fiber = vm->fiber; fiber != NULL; fiber = fiber->parent) {
+    mark_object(vm, (b_obj *) fiber);
+    write_barrier_all(vm, (b_obj *) fiber);
+  }
   mark_table(vm, &vm->globals);
   mark_table(vm, &vm->modules);
 
@@ -356,32 +518,347 @@ static void mark_roots(b_vm *vm) {
   mark_table(vm, &vm->methods_list);
   mark_table(vm, &vm->methods_dict);
   mark_table(vm, &vm->methods_range);
+  mark_table(vm, &vm->methods_fiber);
 
   mark_object(vm, (b_obj*)vm->exception_class);
   mark_compiler_roots(vm);
 }
 
+/*
+ * Parallel marking.
+ *
+ * While the program is paused, the marking of a full collection can be
+ * shared by vm->gc_threads markers: the collecting thread and helpers
+ * started for the occasion. Every marker drains its own gray stack and
+ * moves the older half of it to a locked queue whenever that queue is
+ * empty, and markers out of work steal from the queues of the others.
+ * Marks are set atomically, so only the marker that sets one grays the
+ * object.
+ */
+
+// gray objects a marker keeps to itself before it shares any.
+#define GC_SHARE_MIN 32
+
+#ifdef _MSC_VER
+#include <intrin.h>
+
+static inline int atomic_load_int(int *value) {
+  return (int) _InterlockedOr((volatile long *) value, 0);
+}
+
+static inline void atomic_store_int(int *value, int n) {
+  _InterlockedExchange((volatile long *) value, n);
+}
+
+static inline void atomic_add_int(int *value, int n) {
+  _InterlockedExchangeAdd((volatile long *) value, n);
+}
+
+static inline uint64_t atomic_load_word(uint64_t *word) {
+  return (uint64_t) _InterlockedOr64((volatile __int64 *) word, 0);
+}
+
+static inline uint64_t atomic_or_word(uint64_t *word, uint64_t bits) {
+  return (uint64_t) _InterlockedOr64((volatile __int64 *) word, (__int64) bits);
+}
+
+static inline uint64_t atomic_and_word(uint64_t *word, uint64_t bits) {
+  return (uint64_t) _InterlockedAnd64((volatile __int64 *) word, (__int64) bits);
+}
+
+static inline bool atomic_load_bool(bool *value) {
+  return _InterlockedOr8((volatile char *) value, 0) != 0;
+}
+
+static inline bool atomic_exchange_bool(bool *value, bool n) {
+  return _InterlockedExchange8((volatile char *) value, (char) n) != 0;
+}
+#else
+static inline int atomic_load_int(int *value) {
+  return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+
+static inline void atomic_store_int(int *value, int n) {
+  __atomic_store_n(value, n, __ATOMIC_RELEASE);
+}
+
+static inline void atomic_add_int(int *value, int n) {
+  __atomic_add_fetch(value, n, __ATOMIC_ACQ_REL);
+}
+
+static inline uint64_t atomic_load_word(uint64_t *word) {
+  return __atomic_load_n(word, __ATOMIC_RELAXED);
+}
+
+static inline uint64_t atomic_or_word(uint64_t *word, uint64_t bits) {
+  return __atomic_fetch_or(word, bits, __ATOMIC_RELAXED);
+}
+
+static inline uint64_t atomic_and_word(uint64_t *word, uint64_t bits) {
+  return __atomic_fetch_and(word, bits, __ATOMIC_RELAXED);
+}
+
+static inline bool atomic_load_bool(bool *value) {
+  return __atomic_load_n(value, __ATOMIC_RELAXED);
+}
+
+static inline bool atomic_exchange_bool(bool *value, bool n) {
+  return __atomic_exchange_n(value, n, __ATOMIC_RELAXED);
+}
+#endif
+
+typedef struct {
+  mtx_t lock;
+  b_obj **items;
+  int count; // also read without the lock when looking for work
+  int capacity;
+} b_gray_queue;
+
+typedef struct s_marking b_marking;
+
+typedef struct {
+  b_vm *vm;
+  b_marking *marking;
+  b_obj **stack;
+  int count;
+  int capacity;
+  b_gray_queue queue;
+  size_t marked; // arena bytes, added up once the marking is done
+  bool running;
+} b_marker;
+
+struct s_marking {
+  b_marker *markers;
+  int count;
+  int idle; // markers that found no work
+};
+
+// the marker of the current thread while a parallel marking runs.
+static _Thread_local b_marker *current_marker = NULL;
+
+static void push_marker(b_marker *marker, b_obj *object) {
+  if (marker->capacity < marker->count + 1) {
+    marker->capacity = GROW_CAPACITY(marker->capacity);
+    marker->stack = (b_obj **) realloc(marker->stack, sizeof(b_obj *) * marker->capacity);
+
+    if (marker->stack == NULL) {
+      fflush(stdout); // flush out anything on stdout first
+      fprintf(stderr, "GC encountered an error");
+      exit(EXIT_TERMINAL);
+    }
+  }
+  marker->stack[marker->count++] = object;
+}
+
+// mark_object for markers running side by side.
+static void mark_shared(b_vm *vm, b_obj *object) {
+  b_marker *marker = current_marker;
+  bool mark = vm->mark_value;
+
+  if (object->arena) {
+    b_arena_page *page = ARENA_PAGE(object);
+    uintptr_t bit = ARENA_BIT(object);
+    uint64_t *word = &page->marks[bit / 64];
+    uint64_t mask = (uint64_t) 1 << (bit % 64);
+
+    // looking first keeps the markers from fighting over words that are
+    // set already.
+    if (((atomic_load_word(word) & mask) != 0) == mark) return;
+    uint64_t old = mark ? atomic_or_word(word, mask) : atomic_and_word(word, ~mask);
+    if (((old & mask) != 0) == mark) return;
+
+    marker->marked += page->slot_size;
+  } else if (atomic_load_bool(&object->mark) == mark
+             || atomic_exchange_bool(&object->mark, mark) == mark) {
+    return;
+  }
+
+  push_marker(marker, object);
+}
+
+// moves the older half of the stack of a marker to its queue, where the
+// others can steal it.
+static void share_work(b_marker *marker) {
+  b_gray_queue *queue = &marker->queue;
+  int half = marker->count / 2;
+
+  mtx_lock(&queue->lock);
+  if (queue->capacity < queue->count + half) {
+    queue->capacity = queue->count + half;
+    queue->items = (b_obj **) realloc(queue->items, sizeof(b_obj *) * queue->capacity);
+
+    if (queue->items == NULL) {
+      fflush(stdout); // flush out anything on stdout first
+      fprintf(stderr, "GC encountered an error");
+      exit(EXIT_TERMINAL);
+    }
+  }
+  memcpy(&queue->items[queue->count], marker->stack, sizeof(b_obj *) * half);
+  atomic_store_int(&queue->count, queue->count + half);
+  mtx_unlock(&queue->lock);
+
+  marker->count -= half;
+  memmove(marker->stack, &marker->stack[half], sizeof(b_obj *) * marker->count);
+}
+
+// takes half the queue of another marker, or all of its own.
+static bool take_work(b_marker *marker, b_marker *from) {
+  b_gray_queue *queue = &from->queue;
+  if (atomic_load_int(&queue->count) == 0) return false;
+
+  mtx_lock(&queue->lock);
+  int count = from == marker ? queue->count : (queue->count + 1) / 2;
+  int left = queue->count - count;
+  for (int i = queue->count - 1; i >= left; i--) {
+    push_marker(marker, queue->items[i]);
+  }
+  atomic_store_int(&queue->count, left);
+  mtx_unlock(&queue->lock);
+
+  return count > 0;
+}
+
+static bool steal_work(b_marker *marker) {
+  b_marking *marking = marker->marking;
+  int self = (int) (marker - marking->markers);
+  for (int i = 1; i < marking->count; i++) {
+    if (take_work(marker, &marking->markers[(self + i) % marking->count])) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// waits until some queue has work again. returns false when all markers
+// ran out of work, which is when the marking is done: a marker only goes
+// idle with its queue empty and never shares while idle.
+static bool wait_for_work(b_marker *marker) {
+  b_marking *marking = marker->marking;
+  atomic_add_int(&marking->idle, 1);
+
+  for (;;) {
+    if (atomic_load_int(&marking->idle) == marking->count) {
+      return false;
+    }
+    for (int i = 0; i < marking->count; i++) {
+      if (atomic_load_int(&marking->markers[i].queue.count) > 0) {
+        atomic_add_int(&marking->idle, -1);
+        return true;
+      }
+    }
+    thrd_yield();
+  }
+}
+
+static void run_marker(b_marker *marker) {
+  current_marker = marker;
+
+  do {
+    while (marker->count > 0) {
+      blacken_object(marker->vm, marker->stack[--marker->count]);
+      if (marker->count >= GC_SHARE_MIN && atomic_load_int(&marker->queue.count) == 0) {
+        share_work(marker);
+      }
+    }
+  } while (take_work(marker, marker) || steal_work(marker) || wait_for_work(marker));
+
+  current_marker = NULL;
+}
+
+static int marker_thread(void *arg) {
+  run_marker((b_marker *) arg);
+  return 0;
+}
+
+static bool trace_in_parallel(b_vm *vm) {
+  b_marking marking = {NULL, vm->gc_threads, 0};
+  marking.markers = (b_marker *) calloc(marking.count, sizeof(b_marker));
+  thrd_t *threads = (thrd_t *) malloc(sizeof(thrd_t) * marking.count);
+  if (marking.markers == NULL || threads == NULL) {
+    free(marking.markers);
+    free(threads);
+    return false;
+  }
+
+  for (int i = 0; i < marking.count; i++) {
+    marking.markers[i].vm = vm;
+    marking.markers[i].marking = &marking;
+    mtx_init(&marking.markers[i].queue.lock, mtx_plain);
+  }
+
+  // the collecting thread starts with everything gray so far.
+  b_marker *first = &marking.markers[0];
+  first->stack = vm->gray_stack;
+  first->count = vm->gray_count;
+  first->capacity = vm->gray_capacity;
+
+  vm->gc_parallel = true;
+  for (int i = 1; i < marking.count; i++) {
+    marking.markers[i].running = thrd_create(&threads[i], marker_thread, &marking.markers[i]) == thrd_success;
+    if (!marking.markers[i].running) {
+      // a helper that never started never has work either.
+      atomic_add_int(&marking.idle, 1);
+    }
+  }
+  run_marker(first);
+  for (int i = 1; i < marking.count; i++) {
+    if (marking.markers[i].running) {
+      thrd_join(threads[i], NULL);
+    }
+  }
+  vm->gc_parallel = false;
+
+  vm->gray_stack = first->stack;
+  vm->gray_capacity = first->capacity;
+  vm->gray_count = 0;
+
+  for (int i = 0; i < marking.count; i++) {
+    b_marker *marker = &marking.markers[i];
+    vm->arena.marked += marker->marked;
+    if (i > 0) {
+      free(marker->stack);
+    }
+    free(marker->queue.items);
+    mtx_destroy(&marker->queue.lock);
+  }
+  free(marking.markers);
+  free(threads);
+  return true;
+}
+
+// minor collections and small heaps are not worth the helpers.
+static inline bool should_mark_in_parallel(b_vm *vm) {
+  return vm->gc_threads > 1 && !vm->gc_minor && vm->bytes_allocated >= GC_PARALLEL_MIN_HEAP;
+}
+
 static void trace_references(b_vm *vm) {
+  if (should_mark_in_parallel(vm) && trace_in_parallel(vm)) {
+    return;
+  }
+
   while (vm->gray_count > 0) {
     b_obj *object = vm->gray_stack[--vm->gray_count];
     blacken_object(vm, object);
   }
 }
 
-static void sweep(b_vm *vm) {
-  b_obj *previous = NULL;
-  b_obj *object = vm->objects;
+// frees up to budget unreached objects of the old generation that are too
+// big for the arena, going on from where the last call stopped. returns
+// true once the list is done.
+static bool sweep(b_vm *vm, int budget) {
+  b_obj *previous = vm->sweep_previous;
+  b_obj *object = vm->sweep_cursor;
 
-  while (object != NULL) {
-    if (object->mark == vm->mark_value) {
+  while (object != NULL && budget-- > 0) {
+    if (is_marked(vm, object)) {
       previous = object;
-      object = object->next;
+      object = LARGE_NEXT(object);
     } else {
       b_obj *unreached = object;
 
-      object = object->next;
+      object = LARGE_NEXT(object);
       if (previous != NULL) {
-        previous->next = object;
+        LARGE_NEXT(previous) = object;
       } else {
         vm->objects = object;
       }
@@ -389,39 +866,175 @@ static void sweep(b_vm *vm) {
       free_object(vm, unreached);
     }
   }
+  vm->sweep_previous = previous;
+  vm->sweep_cursor = object;
+  return object == NULL;
+}
+
+// moves an object to the old generation. the arena keeps track of its
+// own objects.
+static inline void promote_object(b_vm *vm, b_obj *object) {
+  object->old = true;
+  if (!object->arena) {
+    LARGE_NEXT(object) = vm->objects;
+    vm->objects = object;
+  }
+}
+
+// frees the young objects nothing reached and promotes the rest to the old
+// generation, white again for the next collection.
+static void sweep_young(b_vm *vm) {
+  int count = vm->young_count;
+
+  for (int i = 0; i < count; i++) {
+    b_obj *object = vm->young[i];
+    if (is_marked(vm, object)) {
+      set_object_mark(object, !vm->mark_value);
+      promote_object(vm, object);
+    } else {
+      // dropped from the interned strings here rather than by a walk over
+      // all of them, most of which are old.
+      if (object->type == OBJ_STRING) {
+        table_delete(&vm->strings, OBJ_VAL(object));
+      }
+      free_object(vm, object);
+    }
+  }
+
+  // module unloaders may have allocated while objects were freed.
+  vm->young_count -= count;
+  memmove(vm->young, vm->young + count, sizeof(b_obj *) * vm->young_count);
 }
 
 void free_objects(b_vm *vm) {
+  for (int i = 0; i < vm->young_count; i++) {
+    free_object(vm, vm->young[i]);
+  }
   b_obj *object = vm->objects;
   while (object != NULL) {
-    b_obj *next = object->next;
+    b_obj *next = LARGE_NEXT(object);
     free_object(vm, object);
     object = next;
   }
+  free_arena(vm);
 
+  free(vm->young);
+  vm->young = NULL;
   free(vm->gray_stack);
   vm->gray_stack = NULL;
+  free(vm->remembered);
+  vm->remembered = NULL;
 }
 
-void collect_garbage(b_vm *vm) {
+static void start_collection(b_vm *vm) {
 #if defined(DEBUG_GC) && DEBUG_GC
   printf("-- gc begins\n");
-  size_t before = vm->bytes_allocated;
 #endif
 
+  // the garbage of the last collection has to go before its colors are
+  // reused.
+  arena_finish_sweeping(vm);
+
+  vm->gc_phase = GC_MARK;
+  mark_roots(vm);
+}
+
+// the roots are written without a barrier, so marking ends with one more
+// pass over them before the weak tables lose their white keys.
+static void finish_marking(b_vm *vm) {
   mark_roots(vm);
   trace_references(vm);
   table_remove_whites(vm, &vm->strings);
   table_remove_whites(vm, &vm->modules);
-  sweep(vm);
 
-  vm->next_gc = vm->bytes_allocated * GC_HEAP_GROWTH_FACTOR;
+  // the young objects are swept along with the rest of the heap, which
+  // leaves nothing young for the remembered set to point at.
+  for (int i = 0; i < vm->young_count; i++) {
+    promote_object(vm, vm->young[i]);
+  }
+  vm->young_count = 0;
+  forget_remembered(vm);
+  arena_start_sweeping(vm);
+
+  vm->gc_phase = GC_SWEEP;
+  vm->sweep_previous = NULL;
+  vm->sweep_cursor = vm->objects;
+}
+
+static void finish_collection(b_vm *vm) {
+  vm->gc_phase = GC_IDLE;
+  // the arena pages give back their garbage only as they are swept.
+  vm->next_gc = (vm->bytes_allocated - vm->arena.garbage) * GC_HEAP_GROWTH_FACTOR;
+  vm->next_minor_gc = vm->bytes_allocated + GC_NURSERY_SIZE;
   vm->mark_value = !vm->mark_value;
 
 #if defined(DEBUG_GC) && DEBUG_GC
   printf("-- gc ends\n");
+  printf("   heap at %zu, next at %zu\n", vm->bytes_allocated, vm->next_gc);
+#endif
+}
+
+// marks or sweeps about budget objects of the running collection.
+static void collection_step(b_vm *vm, int budget) {
+  if (vm->gc_phase == GC_MARK) {
+    if (should_mark_in_parallel(vm)) {
+      // the helpers only run while the program waits, so they mark in
+      // one go.
+      trace_references(vm);
+    }
+    while (vm->gray_count > 0 && budget-- > 0) {
+      blacken_object(vm, vm->gray_stack[--vm->gray_count]);
+    }
+    if (vm->gray_count == 0) {
+      finish_marking(vm);
+    }
+  } else if (sweep(vm, budget)) {
+    finish_collection(vm);
+  }
+}
+
+void collect_garbage(b_vm *vm) {
+  if (vm->gc_phase == GC_IDLE) {
+    start_collection(vm);
+  }
+  if (vm->gc_phase == GC_MARK) {
+    trace_references(vm);
+    finish_marking(vm);
+  }
+  sweep(vm, INT_MAX);
+  finish_collection(vm);
+}
+
+void collect_young_garbage(b_vm *vm) {
+#if defined(DEBUG_GC) && DEBUG_GC
+  printf("-- minor gc begins\n");
+  size_t before = vm->bytes_allocated;
+#endif
+
+  vm->gc_minor = true;
+  mark_roots(vm);
+  // young objects stored into old ones are kept, and old objects filled
+  // in bulk are the only other old ones that can hold young references.
+  for (int i = 0; i < vm->remembered_count; i++) {
+    b_obj *object = vm->remembered[i];
+    if (object->old) {
+      blacken_object(vm, object);
+    } else {
+      mark_object(vm, object);
+    }
+  }
+  trace_references(vm);
+  table_remove_whites(vm, &vm->modules);
+  sweep_young(vm);
+  forget_remembered(vm);
+  vm->gc_minor = false;
+
+  vm->next_minor_gc = vm->bytes_allocated + GC_NURSERY_SIZE;
+
+#if defined(DEBUG_GC) && DEBUG_GC
+  printf("-- minor gc ends\n");
   printf("   collected %zu bytes (from %zu to %zu), next at %zu\n",
          before - vm->bytes_allocated, before, vm->bytes_allocated,
-         vm->next_gc);
+         vm->next_minor_gc);
 #endif
-}
\ No newline at end of file
+}
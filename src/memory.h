@@ -1,6 +1,7 @@
 #ifndef BLADE_MEMORY_H
 #define BLADE_MEMORY_H
 
+#include "arena.h"
 #include "common.h"
 #include "vm.h"
 
@@ -28,6 +29,9 @@ void *allocate(b_vm *vm, size_t size);
 void *c_allocate(b_vm *vm, size_t size, size_t length);
 void *reallocate(b_vm *vm, void *pointer, size_t old_size, size_t new_size);
 
+// runs or advances a collection once the heap has grown enough.
+void collect_if_needed(b_vm *vm);
+
 void free_object(b_vm *vm, b_obj *object);
 void free_objects(b_vm *vm);
 
@@ -37,6 +41,62 @@ void mark_value(b_vm *vm, b_value value);
 
 void collect_garbage(b_vm *vm);
 
+// collects only the objects allocated since the last collection.
+void collect_young_garbage(b_vm *vm);
+
+void remember_object(b_vm *vm, b_obj *object);
+
+void add_young_object(b_vm *vm, b_obj *object);
+
+void gray_object(b_vm *vm, b_obj *object);
+
+static inline bool object_mark(b_obj *object) {
+  return object->arena ? arena_get_bit(ARENA_PAGE(object)->marks, object) : object->mark;
+}
+
+static inline void set_object_mark(b_obj *object, bool mark) {
+  if (object->arena) {
+    arena_set_bit(ARENA_PAGE(object)->marks, object, mark);
+  } else {
+    object->mark = mark;
+  }
+}
+
+static inline bool is_marked(b_vm *vm, b_obj *object) {
+  return object_mark(object) == vm->mark_value;
+}
+
+// a young object stored into an old one goes into the remembered set and
+// lives through the next minor collection. remembering the value rather
+// than the owner spares that collection a walk over big old lists and
+// dictionaries. while a collection is marking, nothing white may hide
+// behind an object that was already marked either.
+static inline void write_barrier(b_vm *vm, b_obj *owner, b_value value) {
+  if (IS_OBJ(value)) {
+    b_obj *object = AS_OBJ(value);
+    if (owner->old && !object->old && !object->remembered) {
+      remember_object(vm, object);
+    }
+    if (vm->gc_phase == GC_MARK && is_marked(vm, owner)) {
+      mark_object(vm, object);
+    }
+  }
+}
+
+// for stores that copy many values into the owner at once.
+static inline void write_barrier_all(b_vm *vm, b_obj *owner) {
+  if (owner->old && !owner->remembered) {
+    remember_object(vm, owner);
+  }
+  if (vm->gc_phase == GC_MARK && is_marked(vm, owner)) {
+    gray_object(vm, owner); // traced again
+  }
+}
+
+// out of line versions for generated code.
+void gc_write_barrier(b_vm *vm, b_obj *owner, b_value value);
+void up_value_barrier(b_vm *vm, b_obj_up_value *up_value);
+
 void blacken_object(b_vm *vm, b_obj *object);
 
 #endif
\ No newline at end of file
@@ -22,6 +22,8 @@
 #include <errno.h>
 #endif /* HAVE_DIRENT_H */
 
+#include "threads/threads.h"
+
 #include <stdlib.h>
 #include <sys/stat.h>
 
@@ -43,9 +45,35 @@ b_module_init modules[] = {
     GET_MODULE_LOADER(array), //
     GET_MODULE_LOADER(process), //
     GET_MODULE_LOADER(struct), //
+    GET_MODULE_LOADER(thread), //
     NULL,
 };
 
+// module loaders, preloaders and unloaders were written for a single vm
+// and some of them set up libraries for the whole process, so vms running
+// on other threads take turns calling them.
+static mtx_t modules_lock;
+static once_flag modules_lock_once = ONCE_FLAG_INIT;
+
+static void init_modules_lock(void) {
+  mtx_init(&modules_lock, mtx_plain);
+}
+
+static void lock_modules() {
+  call_once(&modules_lock_once, init_modules_lock);
+  mtx_lock(&modules_lock);
+}
+
+static void unlock_modules() {
+  mtx_unlock(&modules_lock);
+}
+
+void call_module_loader(b_vm *vm, b_module_loader loader) {
+  lock_modules();
+  loader(vm);
+  unlock_modules();
+}
+
 bool load_module(b_vm *vm, b_module_init init_fn, char *import_name, char *source, void *handle) {
   b_module_reg *module = init_fn(vm);
 
@@ -200,11 +228,13 @@ void bind_user_modules(b_vm *vm, char *pkg_root) {
 }
 
 void bind_native_modules(b_vm *vm) {
+  lock_modules();
   for (int i = 0; modules[i] != NULL; i++) {
     load_module(vm, modules[i], NULL, strdup("<__native__>"), NULL);
   }
   bind_user_modules(vm, merge_paths(get_exe_dir(), "dist"));
   bind_user_modules(vm, merge_paths(getcwd(NULL, 0), LOCAL_PACKAGES_DIRECTORY LOCAL_EXT_DIRECTORY));
+  unlock_modules();
 }
 
 char* load_user_module(b_vm *vm, const char *path, char *name) {
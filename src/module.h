@@ -47,5 +47,6 @@ void add_native_module(b_vm *vm, b_obj_module *module, const char *as);
 bool load_module(b_vm *vm, b_module_init init_fn, char *name, char *source, void *handle);
 char* load_user_module(b_vm *vm, const char *path, char *name);
 void close_dl_module(void* handle);
+void call_module_loader(b_vm *vm, b_module_loader loader);
 
 #endif
\ No newline at end of file
@@ -148,7 +148,7 @@ DECLARE_NATIVE(hasprop) {
 
   b_obj_instance *instance = AS_INSTANCE(args[0]);
   b_value dummy;
-  RETURN_BOOL(table_get(&instance->properties, args[1], &dummy));
+  RETURN_BOOL(!is_hidden_field(args[1]) && instance_get_field(instance, args[1], &dummy));
 }
 
 /**
@@ -165,7 +165,10 @@ DECLARE_NATIVE(getprop) {
 
   b_obj_instance *instance = AS_INSTANCE(args[0]);
   b_value value;
-  if(table_get(&instance->properties, args[1], &value) ||
+  if (is_hidden_field(args[1])) {
+    RETURN_NIL;
+  }
+  if(instance_get_field(instance, args[1], &value) ||
       table_get(&instance->klass->methods, args[1], &value)) {
     RETURN_VALUE(value);
   }
@@ -187,7 +190,10 @@ DECLARE_NATIVE(setprop) {
   ENFORCE_ARG_TYPE(setprop, 1, IS_STRING);
 
   b_obj_instance *instance = AS_INSTANCE(args[0]);
-  RETURN_BOOL(table_set(vm, &instance->properties, args[1], args[2]));
+  if (is_hidden_field(args[1])) {
+    RETURN_FALSE;
+  }
+  RETURN_BOOL(instance_set_dynamic_field(vm, instance, args[1], args[2]));
 }
 
 /**
@@ -202,7 +208,10 @@ DECLARE_NATIVE(delprop) {
   ENFORCE_ARG_TYPE(delprop, 1, IS_STRING);
 
   b_obj_instance *instance = AS_INSTANCE(args[0]);
-  RETURN_BOOL(table_delete(&instance->properties, args[1]));
+  if (is_hidden_field(args[1])) {
+    RETURN_FALSE;
+  }
+  RETURN_BOOL(instance_delete_field(vm, instance, args[1]));
 }
 
 /**
@@ -473,13 +482,13 @@ DECLARE_NATIVE(to_list) {
     b_obj_dict *dict = AS_DICT(args[0]);
     for (int i = 0; i < dict->names.count; i++) {
       b_obj_list *n_list = (b_obj_list *) GC(new_list(vm));
-      write_value_arr(vm, &n_list->items, dict->names.values[i]);
+      write_list(vm, n_list, dict->names.values[i]);
 
       b_value value;
       table_get(&dict->items, dict->names.values[i], &value);
-      write_value_arr(vm, &n_list->items, value);
+      write_list(vm, n_list, value);
 
-      write_value_arr(vm, &list->items, OBJ_VAL(n_list));
+      write_list(vm, list, OBJ_VAL(n_list));
     }
   } else if(IS_STRING(args[0])) {
     b_obj_string *str = AS_STRING(args[0]);
@@ -501,7 +510,7 @@ DECLARE_NATIVE(to_list) {
       }
     }
   } else {
-    write_value_arr(vm, &list->items, args[0]);
+    write_list(vm, list, args[0]);
   }
 
   RETURN_OBJ(list);
@@ -610,12 +619,14 @@ static uint32_t mt_generate(uint32_t* state, uint32_t* index) {
 }
 
 double mt_rand(double lower_limit, double upper_limit) {
-  static uint32_t mt_state[MT_STATE_SIZE];
-  static uint32_t mt_index = MT_STATE_SIZE + 1;
+  // every thread has its own generator, told apart by where its state
+  // lives in case two are seeded in the same microsecond.
+  static _Thread_local uint32_t mt_state[MT_STATE_SIZE];
+  static _Thread_local uint32_t mt_index = MT_STATE_SIZE + 1;
   if (mt_index >= MT_STATE_SIZE) {
     struct timeval tv;
     gettimeofday(&tv, NULL);
-    mt_seed((uint32_t)(1000000 * tv.tv_sec + tv.tv_usec), mt_state, &mt_index);
+    mt_seed((uint32_t)(1000000 * tv.tv_sec + tv.tv_usec) ^ (uint32_t)(uintptr_t)mt_state, mt_state, &mt_index);
   }
   uint32_t rand_val = mt_generate(mt_state, &mt_index);
   double rand_num = lower_limit + ((double)rand_val / UINT32_MAX) * (upper_limit - lower_limit);
@@ -796,6 +807,16 @@ DECLARE_NATIVE(is_file) {
   RETURN_BOOL(IS_FILE(args[0]));
 }
 
+/**
+ * is_fiber(value: any)
+ *
+ * returns true if the value is a fiber or false otherwise
+ */
+DECLARE_NATIVE(is_fiber) {
+  ENFORCE_ARG_COUNT(is_fiber, 1);
+  RETURN_BOOL(IS_FIBER(args[0]));
+}
+
 /**
  * is_instance(value: any)
  *
@@ -817,8 +838,7 @@ DECLARE_NATIVE(instance_of) {
   ENFORCE_ARG_TYPE(instance_of, 0, IS_INSTANCE);
   ENFORCE_ARG_TYPE(instance_of, 1, IS_CLASS);
 
-  RETURN_BOOL(is_instance_of(AS_INSTANCE(args[0])->klass,
-                             AS_CLASS(args[1])->name->chars));
+  RETURN_BOOL(is_instance_of(AS_INSTANCE(args[0])->klass, AS_CLASS(args[1])));
 }
 
 //------------------------------------------------------------------------------
@@ -58,14 +58,15 @@
 #define RETURN_ERROR(...)                                                      \
   do {                                                                            \
     pop_n(vm, arg_count); \
-    throw_exception(vm, ##__VA_ARGS__);                                        \
     args[-1] = FALSE_VAL; \
+    throw_exception(vm, ##__VA_ARGS__);                                        \
     return false;                                                          \
   } while(0)
 #define RETURN_BOOL(v) do { args[-1] = BOOL_VAL(v); return true; } while(0)
 #define RETURN_TRUE do { args[-1] = TRUE_VAL; return true; } while(0)
 #define RETURN_FALSE do { args[-1] = FALSE_VAL; return true; } while(0)
 #define RETURN_NUMBER(v) do { args[-1] = NUMBER_VAL(v); return true; } while(0)
+#define RETURN_LONG(v) do { args[-1] = LONG_VAL(v); return true; } while(0)
 #define RETURN_OBJ(v) do { args[-1] = OBJ_VAL(v); return true; } while(0)
 #define RETURN_PTR(v) do { args[-1] = OBJ_VAL(new_ptr(vm, (void*)(v))); return true; } while(0)
 #define RETURN_STRING(v) do { args[-1] = OBJ_VAL(copy_string(vm, v, (int)strlen(v))); return true; } while(0)
@@ -277,6 +278,8 @@ DECLARE_NATIVE(is_class);
 
 DECLARE_NATIVE(is_file);
 
+DECLARE_NATIVE(is_fiber);
+
 DECLARE_NATIVE(is_instance);
 
 DECLARE_NATIVE(is_iterable);
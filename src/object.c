@@ -10,14 +10,24 @@
 #include <string.h>
 
 b_obj *allocate_object(b_vm *vm, size_t size, b_obj_type type) {
-  b_obj *object = (b_obj *) reallocate(vm, NULL, 0, size);
+  b_obj *object;
+  if (size <= ARENA_MAX_SIZE) {
+    object = arena_allocate(vm, size);
+    object->arena = true;
+  } else {
+    object = arena_allocate_large(vm, size);
+    object->arena = false;
+  }
 
   object->type = type;
-  object->mark = !vm->mark_value;
+  // objects made during a sweep have to outlive it and turn white when the
+  // colors flip at its end.
+  set_object_mark(object, vm->gc_phase == GC_SWEEP ? vm->mark_value : !vm->mark_value);
   object->stale = false;
+  object->old = false;
+  object->remembered = false;
 
-  object->next = vm->objects;
-  vm->objects = object;
+  add_young_object(vm, object);
 
 #if defined(DEBUG_GC) && DEBUG_GC
   printf("%p allocate %ld for %d\n", (void *)object, size, type);
@@ -38,6 +48,10 @@ b_obj_ptr *new_ptr(b_vm *vm, void *pointer) {
 b_obj_module *new_module(b_vm *vm, char *name, char *file) {
   b_obj_module *module = ALLOCATE_OBJ(b_obj_module, OBJ_MODULE);
   init_table(&module->values);
+  init_table(&module->slot_names);
+  module->slot_count = 0;
+  module->slot_capacity = 0;
+  module->slots = NULL;
   module->name = name;
   module->file = file;
   module->unloader = NULL;
@@ -47,6 +61,24 @@ b_obj_module *new_module(b_vm *vm, char *name, char *file) {
   return module;
 }
 
+int module_global_slot(b_vm *vm, b_obj_module *module, b_obj_string *name) {
+  b_value slot;
+  if (table_get(&module->slot_names, OBJ_VAL(name), &slot)) {
+    return (int) AS_NUMBER(slot);
+  }
+
+  if (module->slot_capacity < module->slot_count + 1) {
+    int old_capacity = module->slot_capacity;
+    module->slot_capacity = GROW_CAPACITY(old_capacity);
+    module->slots = GROW_ARRAY(int, module->slots, old_capacity, module->slot_capacity);
+  }
+
+  module->slots[module->slot_count] = -1;
+  table_set(vm, &module->slot_names, OBJ_VAL(name), NUMBER_VAL(module->slot_count));
+  write_barrier(vm, &module->obj, OBJ_VAL(name));
+  return module->slot_count++;
+}
+
 b_obj_switch *new_switch(b_vm *vm) {
   b_obj_switch *sw = ALLOCATE_OBJ(b_obj_switch, OBJ_SWITCH);
   init_table(&sw->table);
@@ -116,6 +148,12 @@ b_obj_class *new_class(b_vm *vm, b_obj_string *name) {
   init_table(&klass->methods);
   klass->initializer = EMPTY_VAL;
   klass->superclass = NULL;
+  klass->supers = NULL;
+  klass->depth = 0;
+  klass->version = 0;
+  klass->root_shape = NULL;
+  klass->instance_shape = NULL;
+  klass->field_hint = 0;
   return klass;
 }
 
@@ -127,24 +165,247 @@ b_obj_func *new_function(b_vm *vm, b_obj_module *module, b_func_type type) {
   function->name = NULL;
   function->type = type;
   function->module = module;
+  function->jit_counter = 0;
+  function->jit = NULL;
   init_blob(&function->blob);
   return function;
 }
 
+static b_shape *new_shape(b_vm *vm, b_shape *parent, b_obj_string *name) {
+  b_shape *shape = ALLOCATE(b_shape, 1);
+  shape->parent = parent;
+  shape->name = name;
+  shape->count = parent == NULL ? 0 : parent->count + 1;
+  shape->transition_count = 0;
+  shape->transition_capacity = 0;
+  shape->transitions = NULL;
+  init_table(&shape->slots);
+  return shape;
+}
+
+static b_shape *shape_transition(b_vm *vm, b_shape *shape, b_obj_string *name) {
+  for (int i = 0; i < shape->transition_count; i++) {
+    if (shape->transitions[i]->name == name) {
+      return shape->transitions[i];
+    }
+  }
+
+  b_shape *next = new_shape(vm, shape, name);
+
+  // link the new shape into the tree before filling its slots so that
+  // a collection triggered below still sees (and marks) it.
+  if (shape->transition_capacity < shape->transition_count + 1) {
+    int old_capacity = shape->transition_capacity;
+    shape->transition_capacity = GROW_CAPACITY(old_capacity);
+    shape->transitions = GROW_ARRAY(b_shape *, shape->transitions, old_capacity, shape->transition_capacity);
+  }
+  shape->transitions[shape->transition_count++] = next;
+
+  table_add_all(vm, &shape->slots, &next->slots);
+  table_set(vm, &next->slots, OBJ_VAL(name), NUMBER_VAL(shape->count));
+  return next;
+}
+
+int shape_find_slot(b_shape *shape, b_value name) {
+  b_value slot;
+  if (table_get(&shape->slots, name, &slot)) {
+    return (int) AS_NUMBER(slot);
+  }
+  return -1;
+}
+
+void mark_shape(b_vm *vm, b_shape *shape) {
+  if (shape == NULL) return;
+  mark_object(vm, (b_obj *) shape->name);
+  mark_table(vm, &shape->slots);
+  for (int i = 0; i < shape->transition_count; i++) {
+    mark_shape(vm, shape->transitions[i]);
+  }
+}
+
+void free_shape(b_vm *vm, b_shape *shape) {
+  if (shape == NULL) return;
+  for (int i = 0; i < shape->transition_count; i++) {
+    free_shape(vm, shape->transitions[i]);
+  }
+  FREE_ARRAY(b_shape *, shape->transitions, shape->transition_capacity);
+  free_table(vm, &shape->slots);
+  FREE(b_shape, shape);
+}
+
+// returns the shape new instances of the class start with, rebuilding it
+// when the class has gained properties since it was last computed.
+// returns NULL when the properties cannot be described by a shape.
+static b_shape *class_instance_shape(b_vm *vm, b_obj_class *klass) {
+  if (klass->instance_shape != NULL && klass->instance_shape->count == klass->properties.count) {
+    return klass->instance_shape;
+  }
+
+  if (klass->properties.count > MAX_SHAPE_FIELDS) {
+    return NULL;
+  }
+
+  if (klass->root_shape == NULL) {
+    klass->root_shape = new_shape(vm, NULL, NULL);
+  }
+
+  b_shape *shape = klass->root_shape;
+  for (int i = 0; i < klass->properties.capacity; i++) {
+    b_entry *entry = &klass->properties.entries[i];
+    if (!IS_EMPTY(entry->key)) {
+      if (!IS_STRING(entry->key)) {
+        return NULL;
+      }
+      shape = shape_transition(vm, shape, AS_STRING(entry->key));
+    }
+  }
+
+  klass->instance_shape = shape;
+  return shape;
+}
+
 b_obj_instance *new_instance(b_vm *vm, b_obj_class *klass) {
-  b_obj_instance *instance = ALLOCATE_OBJ(b_obj_instance, OBJ_INSTANCE);
-  push(vm, OBJ_VAL(instance)); // gc fix
+  b_shape *shape = class_instance_shape(vm, klass);
 
+  int capacity = 0;
+  if (shape != NULL) {
+    capacity = shape->count > klass->field_hint ? shape->count : klass->field_hint;
+  }
+
+  b_obj_instance *instance = (b_obj_instance *) allocate_object(
+      vm, sizeof(b_obj_instance) + sizeof(b_value) * capacity, OBJ_INSTANCE);
   instance->klass = klass;
+  instance->shape = shape;
+  instance->fields = instance->inline_fields;
+  instance->field_capacity = capacity;
+  instance->inline_capacity = capacity;
   init_table(&instance->properties);
-  if(klass->properties.count > 0) {
-    table_copy(vm, &klass->properties, &instance->properties);
+  for (int i = 0; i < capacity; i++) {
+    instance->inline_fields[i] = NIL_VAL;
+  }
+
+  push(vm, OBJ_VAL(instance)); // gc fix
+
+  if (shape == NULL) {
+    table_copy(vm, &instance->obj, &klass->properties, &instance->properties);
+  } else if (shape->count > 0) {
+    // the shape was built walking the properties in this same order.
+    int slot = 0;
+    for (int i = 0; i < klass->properties.capacity; i++) {
+      b_entry *entry = &klass->properties.entries[i];
+      if (!IS_EMPTY(entry->key)) {
+        instance->fields[slot] = copy_value(vm, entry->value);
+        // a collection while copying could have promoted the instance.
+        write_barrier(vm, &instance->obj, instance->fields[slot++]);
+      }
+    }
   }
 
   pop(vm); // gc fix
   return instance;
 }
 
+void instance_to_dictionary(b_vm *vm, b_obj_instance *instance) {
+  b_shape *shape = instance->shape;
+  if (shape == NULL) return;
+
+  for (int i = 0; i < shape->slots.capacity; i++) {
+    b_entry *entry = &shape->slots.entries[i];
+    if (!IS_EMPTY(entry->key)) {
+      table_set(vm, &instance->properties, entry->key, instance->fields[(int) AS_NUMBER(entry->value)]);
+    }
+  }
+
+  write_barrier_all(vm, &instance->obj);
+
+  instance->shape = NULL;
+  if (instance->fields != instance->inline_fields) {
+    FREE_ARRAY(b_value, instance->fields, instance->field_capacity);
+    instance->fields = instance->inline_fields;
+    instance->field_capacity = instance->inline_capacity;
+  }
+}
+
+bool instance_get_field(b_obj_instance *instance, b_value name, b_value *value) {
+  if (instance->shape == NULL) {
+    return table_get(&instance->properties, name, value);
+  }
+
+  int slot = shape_find_slot(instance->shape, name);
+  if (slot < 0) return false;
+
+  *value = instance->fields[slot];
+  return true;
+}
+
+bool instance_set_field(b_vm *vm, b_obj_instance *instance, b_value name, b_value value) {
+  write_barrier(vm, &instance->obj, name);
+  write_barrier(vm, &instance->obj, value);
+
+  b_shape *shape = instance->shape;
+  if (shape != NULL) {
+    int slot = shape_find_slot(shape, name);
+    if (slot >= 0) {
+      instance->fields[slot] = value;
+      return false;
+    }
+
+    if (IS_STRING(name) && shape->count < MAX_SHAPE_FIELDS) {
+      push(vm, name); // gc fix
+      push(vm, value);
+      b_shape *next = shape_transition(vm, shape, AS_STRING(name));
+      // the shapes of the class now hold the name too.
+      write_barrier(vm, &instance->klass->obj, name);
+
+      if (next->count > instance->field_capacity) {
+        int capacity = GROW_CAPACITY(instance->field_capacity);
+        b_value *fields = ALLOCATE(b_value, capacity);
+        for (int i = 0; i < shape->count; i++) {
+          fields[i] = instance->fields[i];
+        }
+        if (instance->fields != instance->inline_fields) {
+          FREE_ARRAY(b_value, instance->fields, instance->field_capacity);
+        }
+        instance->fields = fields;
+        instance->field_capacity = capacity;
+      }
+
+      instance->fields[shape->count] = value;
+      instance->shape = next;
+      pop_n(vm, 2);
+
+      if (next->count > instance->klass->field_hint) {
+        instance->klass->field_hint = next->count;
+      }
+      return true;
+    }
+
+    push(vm, value); // gc fix
+    instance_to_dictionary(vm, instance);
+    pop(vm);
+  }
+
+  return table_set(vm, &instance->properties, name, value);
+}
+
+// fields added by name at runtime move the instance off its shape.
+bool instance_set_dynamic_field(b_vm *vm, b_obj_instance *instance, b_value name, b_value value) {
+  if (instance->shape != NULL && shape_find_slot(instance->shape, name) < 0) {
+    instance_to_dictionary(vm, instance);
+  }
+  return instance_set_field(vm, instance, name, value);
+}
+
+bool instance_delete_field(b_vm *vm, b_obj_instance *instance, b_value name) {
+  if (instance->shape != NULL) {
+    if (shape_find_slot(instance->shape, name) < 0) {
+      return false;
+    }
+    instance_to_dictionary(vm, instance);
+  }
+  return table_delete(&instance->properties, name);
+}
+
 b_obj_native *new_native(b_vm *vm, b_native_fn function, const char *name) {
   b_obj_native *native = ALLOCATE_OBJ(b_obj_native, OBJ_NATIVE);
   native->function = function;
@@ -167,6 +428,20 @@ b_obj_closure *new_closure(b_vm *vm, b_obj_func *function) {
   return closure;
 }
 
+b_obj_fiber *new_fiber(b_vm *vm, b_obj_closure *closure) {
+  b_obj_fiber *fiber = ALLOCATE_OBJ(b_obj_fiber, OBJ_FIBER);
+  fiber->state = FIBER_NEW;
+  fiber->closure = closure;
+  fiber->parent = NULL;
+  fiber->stack = fiber->stack_top = NULL;
+  fiber->stack_capacity = 0;
+  fiber->frames = NULL;
+  fiber->frame_count = 0;
+  fiber->frame_capacity = 0;
+  fiber->open_up_values = NULL;
+  return fiber;
+}
+
 b_obj_string *allocate_string(b_vm *vm, char *chars, int length, uint32_t hash) {
   b_obj_string *string = ALLOCATE_OBJ(b_obj_string, OBJ_STRING);
   string->chars = chars;
@@ -213,6 +488,7 @@ b_obj_up_value *new_up_value(b_vm *vm, b_value *slot) {
   up_value->closed = NIL_VAL;
   up_value->location = slot;
   up_value->next = NULL;
+  up_value->owner = (b_obj *) vm->fiber;
   return up_value;
 }
 
@@ -318,6 +594,10 @@ void print_object(b_value value, bool fix_string) {
       print_function(AS_CLOSURE(value)->function);
       break;
     }
+    case OBJ_FIBER: {
+      printf("<fiber at %p>", (void *) AS_FIBER(value));
+      break;
+    }
     case OBJ_FUNCTION: {
       print_function(AS_FUNCTION(value));
       break;
@@ -483,6 +763,8 @@ b_obj_string *object_to_string(b_vm *vm, b_value value) {
     case OBJ_BOUND_METHOD: {
       return function_to_string(vm, AS_BOUND(value)->method->function);
     }
+    case OBJ_FIBER:
+      return copy_string(vm, "<fiber>", 7);
     case OBJ_FUNCTION:
       return function_to_string(vm, AS_FUNCTION(value));
     case OBJ_NATIVE:{
@@ -552,6 +834,9 @@ const char *object_type(b_obj *object) {
     case OBJ_CLASS:
       return "class";
 
+    case OBJ_FIBER:
+      return "fiber";
+
     case OBJ_FUNCTION:
     case OBJ_NATIVE:
     case OBJ_CLOSURE:
@@ -27,6 +27,7 @@ typedef enum {
 #define IS_CLASS(v) is_obj_type(v, OBJ_CLASS)
 #define IS_INSTANCE(v) is_obj_type(v, OBJ_INSTANCE)
 #define IS_BOUND(v) is_obj_type(v, OBJ_BOUND_METHOD)
+#define IS_FIBER(v) is_obj_type(v, OBJ_FIBER)
 
 // containers
 #define IS_BYTES(v) is_obj_type(v, OBJ_BYTES)
@@ -43,6 +44,7 @@ typedef enum {
 #define AS_CLASS(v) ((b_obj_class *)AS_OBJ(v))
 #define AS_INSTANCE(v) ((b_obj_instance *)AS_OBJ(v))
 #define AS_BOUND(v) ((b_obj_bound *)AS_OBJ(v))
+#define AS_FIBER(v) ((b_obj_fiber *)AS_OBJ(v))
 
 // non-user objects
 #define AS_SWITCH(v) ((b_obj_switch *)AS_OBJ(v))
@@ -77,6 +79,7 @@ typedef enum {
   OBJ_UP_VALUE,
   OBJ_BOUND_METHOD,
   OBJ_CLOSURE,
+  OBJ_FIBER,
   OBJ_FUNCTION,
   OBJ_INSTANCE,
   OBJ_NATIVE,
@@ -88,17 +91,24 @@ typedef enum {
   OBJ_PTR,  // object type that can hold any C pointer
 } b_obj_type;
 
+// the allocator keeps track of every object rather than a list threaded
+// through them, so the header fits in a single word.
 struct s_obj {
   b_obj_type type;
-  bool mark;
+  bool mark; // objects in the arena keep theirs in the page bitmap
+  // survived a collection. old objects are only traced by minor
+  // collections while they sit in the remembered set, and young ones
+  // in it live through them.
+  bool old : 1;
+  bool remembered : 1;
 
   // when an object is marked as stale, it means that the
   // GC will never collect this object. This can be useful
   // for library/package objects that want to reuse native
   // objects in their types/pointers. The GC cannot reach
   // them yet, so it's best for them to be kept stale.
-  bool stale;
-  struct s_obj *next;
+  bool stale : 1;
+  bool arena : 1; // lives in an arena page rather than its own allocation
 };
 
 struct s_obj_string {
@@ -115,12 +125,17 @@ typedef struct b_obj_up_value {
   b_value closed;
   b_value *location;
   struct b_obj_up_value *next;
+  b_obj *owner; // the fiber whose stack location points into, NULL for the main stack
 } b_obj_up_value;
 
 typedef struct {
   b_obj obj;
   bool imported;
   b_table values;
+  b_table slot_names; // global name -> slot, assigned by the compiler
+  int slot_count;
+  int slot_capacity;
+  int *slots; // position of each global's entry in values, -1 if unknown
   char *name;
   char *file;
   void *preloader;
@@ -137,6 +152,11 @@ typedef struct {
   b_blob blob;
   b_obj_string *name;
   b_obj_module *module;
+
+  // calls and loop iterations counted towards compiling to native code,
+  // -1 once it should not be tried.
+  int jit_counter;
+  struct b_jit_code *jit;
 } b_obj_func;
 
 typedef struct {
@@ -146,6 +166,44 @@ typedef struct {
   b_obj_up_value **up_values;
 } b_obj_closure;
 
+typedef enum {
+  FIBER_NEW,
+  FIBER_SUSPENDED,
+  FIBER_RUNNING,
+  FIBER_DONE,
+} b_fiber_state;
+
+// a fiber holds the value and frame stacks the vm is not running on. while
+// it runs, they are the stacks of whoever resumed it, so resuming and
+// yielding only swap them with those of the vm.
+typedef struct b_obj_fiber {
+  b_obj obj;
+  b_fiber_state state;
+  b_obj_closure *closure;
+  struct b_obj_fiber *parent; // the fiber that resumed this one, NULL for the main stack
+  b_value *stack;
+  b_value *stack_top;
+  int stack_capacity;
+  struct b_call_frame *frames;
+  int frame_count;
+  int frame_capacity;
+  b_obj_up_value *open_up_values;
+} b_obj_fiber;
+
+// a shape describes the layout of the fields of instances of a class.
+// shapes form a transition tree rooted in the class: adding a field to
+// an instance moves it to the child shape for that field name, so
+// instances that gain the same fields in the same order share a shape.
+typedef struct b_shape {
+  struct b_shape *parent;
+  b_obj_string *name; // the field this shape added to its parent
+  int count;          // number of fields (slots) described by the shape
+  b_table slots;      // field name -> slot index
+  int transition_count;
+  int transition_capacity;
+  struct b_shape **transitions;
+} b_shape;
+
 typedef struct b_obj_class {
   b_obj obj;
   b_value initializer;
@@ -154,12 +212,25 @@ typedef struct b_obj_class {
   b_table methods;
   b_obj_string *name;
   struct b_obj_class *superclass;
+  // every ancestor from the root class down to the superclass, so that
+  // supers[c->depth] can only ever be c when c is an ancestor.
+  struct b_obj_class **supers;
+  int depth;
+  uint32_t version; // bumped whenever methods change to invalidate inline caches
+  b_shape *root_shape;
+  b_shape *instance_shape; // shape of new instances, NULL when stale
+  int field_hint; // number of fields instances are expected to grow to
 } b_obj_class;
 
 typedef struct {
   b_obj obj;
-  b_table properties;
   b_obj_class *klass;
+  b_shape *shape; // NULL when the instance is in dictionary mode
+  b_value *fields;
+  int field_capacity;
+  int inline_capacity;
+  b_table properties; // only used in dictionary mode
+  b_value inline_fields[];
 } b_obj_instance;
 
 typedef struct {
@@ -249,10 +320,31 @@ b_obj_class *new_class(b_vm *vm, b_obj_string *name);
 
 b_obj_closure *new_closure(b_vm *vm, b_obj_func *function);
 
+b_obj_fiber *new_fiber(b_vm *vm, b_obj_closure *closure);
+
 b_obj_func *new_function(b_vm *vm, b_obj_module *module, b_func_type type);
 
 b_obj_instance *new_instance(b_vm *vm, b_obj_class *klass);
 
+int module_global_slot(b_vm *vm, b_obj_module *module, b_obj_string *name);
+
+bool instance_get_field(b_obj_instance *instance, b_value name, b_value *value);
+
+bool instance_set_field(b_vm *vm, b_obj_instance *instance, b_value name, b_value value);
+
+// sets a field named by the program at runtime rather than in the class.
+bool instance_set_dynamic_field(b_vm *vm, b_obj_instance *instance, b_value name, b_value value);
+
+bool instance_delete_field(b_vm *vm, b_obj_instance *instance, b_value name);
+
+void instance_to_dictionary(b_vm *vm, b_obj_instance *instance);
+
+int shape_find_slot(b_shape *shape, b_value name);
+
+void mark_shape(b_vm *vm, b_shape *shape);
+
+void free_shape(b_vm *vm, b_shape *shape);
+
 b_obj_up_value *new_up_value(b_vm *vm, b_value *slot);
 
 b_obj_native *new_native(b_vm *vm, b_native_fn function, const char *name);
@@ -0,0 +1,521 @@
+#include "optimizer.h"
+#include "compiler.h"
+#include "memory.h"
+#include "object.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum {
+  FIX_FORWARD,  // offset forward from the end of the instruction
+  FIX_BACKWARD, // offset backward from the end of the instruction
+  FIX_SKIP_POP, // like FIX_FORWARD, but lands after the pop at the target
+} b_fix_type;
+
+typedef struct {
+  b_fix_type type;
+  int operand; // new position of the operand to patch
+  int end;     // new offset just past the instruction
+  int target;  // old offset of the target
+} b_jump_fix;
+
+typedef struct {
+  b_obj_switch *sw;
+  int old_base;
+  int new_base;
+} b_switch_fix;
+
+typedef struct {
+  b_vm *vm;
+  b_blob *blob;
+  bool *targets; // old offsets that something jumps to
+  int *map;      // old offset -> new offset
+
+  uint8_t *code;
+  int *lines;
+  int count;
+
+  b_jump_fix *jumps;
+  int jump_count;
+  b_switch_fix *switches;
+  int switch_count;
+
+  int one; // constant holding 1 for register operands, -1 until needed
+} b_optimizer;
+
+// rewrites the instructions starting at offset. returns the offset of the
+// first instruction not consumed, or -1 to copy the instruction unchanged.
+typedef int (*b_rewrite_fn)(b_optimizer *o, int offset, int length);
+
+static inline uint16_t read_short(const uint8_t *code, int offset) {
+  return (uint16_t) ((code[offset] << 8) | code[offset + 1]);
+}
+
+static inline void write_short(uint8_t *code, int offset, int value) {
+  code[offset] = (value >> 8) & 0xff;
+  code[offset + 1] = value & 0xff;
+}
+
+static inline int instruction_length(b_blob *blob, int offset) {
+  return 1 + get_code_args_count(blob->code, blob->constants.values, offset);
+}
+
+static void mark_targets(b_optimizer *o) {
+  b_blob *blob = o->blob;
+  uint8_t *code = blob->code;
+
+  for (int offset = 0; offset < blob->count; offset += instruction_length(blob, offset)) {
+    switch (code[offset]) {
+      case OP_JUMP:
+      case OP_JUMP_IF_FALSE:
+        o->targets[offset + 3 + read_short(code, offset + 1)] = true;
+        break;
+      case OP_LOOP:
+        o->targets[offset + 3 - read_short(code, offset + 1)] = true;
+        break;
+      case OP_ITER_NEXT:
+        o->targets[offset + 7 + read_short(code, offset + 3)] = true;
+        o->targets[offset + 7 + read_short(code, offset + 5)] = true;
+        break;
+      case OP_REG_MOVE:
+        o->targets[offset + 7 + read_short(code, offset + 5)] = true;
+        break;
+      case OP_REG_ADD:
+      case OP_REG_SUBTRACT:
+      case OP_REG_MULTIPLY:
+      case OP_REG_DIVIDE:
+        o->targets[offset + 9 + read_short(code, offset + 7)] = true;
+        break;
+      case OP_REG_LESS_JUMP:
+      case OP_REG_GREATER_JUMP:
+        o->targets[offset + 9 + read_short(code, offset + 5)] = true;
+        o->targets[offset + 9 + read_short(code, offset + 7) - 1] = true;
+        break;
+      case OP_SWITCH: {
+        b_obj_switch *sw = AS_SWITCH(blob->constants.values[read_short(code, offset + 1)]);
+        int base = offset + 3;
+        for (int i = 0; i < sw->table.capacity; i++) {
+          b_entry *entry = &sw->table.entries[i];
+          if (!IS_EMPTY(entry->key)) {
+            o->targets[base + (int) AS_NUMBER(entry->value)] = true;
+          }
+        }
+        if (sw->default_jump != -1) {
+          o->targets[base + sw->default_jump] = true;
+        }
+        o->targets[base + sw->exit_jump] = true;
+        break;
+      }
+      default:
+        break;
+    }
+  }
+
+  // nothing may be fused across the edges of a try body, and the handlers
+  // are entered from outside.
+  for (int i = 0; i < blob->handler_count; i++) {
+    b_handler *handler = &blob->handlers[i];
+    o->targets[handler->start] = true;
+    o->targets[handler->end] = true;
+    o->targets[handler->address] = true;
+    o->targets[handler->finally_address] = true;
+  }
+}
+
+// returns the instruction at offset if it can be folded into the
+// instruction before it, or -1 if it cannot.
+static inline int fusable(b_optimizer *o, int offset) {
+  if (offset >= o->blob->count || o->targets[offset]) {
+    return -1;
+  }
+  return o->blob->code[offset];
+}
+
+static inline void emit(b_optimizer *o, uint8_t byte, int line) {
+  o->lines[o->count] = line;
+  o->code[o->count++] = byte;
+}
+
+static inline void emit_short(b_optimizer *o, uint16_t value, int line) {
+  emit(o, (value >> 8) & 0xff, line);
+  emit(o, value & 0xff, line);
+}
+
+static void add_jump(b_optimizer *o, b_fix_type type, int operand, int end, int target) {
+  b_jump_fix *fix = &o->jumps[o->jump_count++];
+  fix->type = type;
+  fix->operand = operand;
+  fix->end = end;
+  fix->target = target;
+}
+
+// maps the old instructions in [from, to) to the instruction about to be emitted.
+static inline void map_range(b_optimizer *o, int from, int to) {
+  for (int i = from; i < to; i++) {
+    o->map[i] = o->count;
+  }
+}
+
+// copies a single instruction unchanged, remembering any code offsets it holds.
+static void copy_instruction(b_optimizer *o, int offset, int length) {
+  b_blob *blob = o->blob;
+  uint8_t *code = blob->code;
+  int start = o->count;
+
+  map_range(o, offset, offset + length);
+  for (int i = 0; i < length; i++) {
+    emit(o, code[offset + i], blob->lines[offset + i]);
+  }
+
+  switch (code[offset]) {
+    case OP_JUMP:
+    case OP_JUMP_IF_FALSE:
+      add_jump(o, FIX_FORWARD, start + 1, start + 3, offset + 3 + read_short(code, offset + 1));
+      break;
+    case OP_LOOP:
+      add_jump(o, FIX_BACKWARD, start + 1, start + 3, offset + 3 - read_short(code, offset + 1));
+      break;
+    case OP_ITER_NEXT:
+      add_jump(o, FIX_FORWARD, start + 3, start + 7, offset + 7 + read_short(code, offset + 3));
+      add_jump(o, FIX_FORWARD, start + 5, start + 7, offset + 7 + read_short(code, offset + 5));
+      break;
+    case OP_REG_MOVE:
+      add_jump(o, FIX_FORWARD, start + 5, start + 7, offset + 7 + read_short(code, offset + 5));
+      break;
+    case OP_REG_ADD:
+    case OP_REG_SUBTRACT:
+    case OP_REG_MULTIPLY:
+    case OP_REG_DIVIDE:
+      add_jump(o, FIX_FORWARD, start + 7, start + 9, offset + 9 + read_short(code, offset + 7));
+      break;
+    case OP_REG_LESS_JUMP:
+    case OP_REG_GREATER_JUMP:
+      add_jump(o, FIX_FORWARD, start + 5, start + 9, offset + 9 + read_short(code, offset + 5));
+      add_jump(o, FIX_SKIP_POP, start + 7, start + 9, offset + 9 + read_short(code, offset + 7) - 1);
+      break;
+    case OP_SWITCH: {
+      b_switch_fix *fix = &o->switches[o->switch_count++];
+      fix->sw = AS_SWITCH(blob->constants.values[read_short(code, offset + 1)]);
+      fix->old_base = offset + 3;
+      fix->new_base = start + 3;
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+// tries to fuse the instructions starting at offset into a single one.
+// returns the offset of the first instruction not consumed, or -1 if
+// nothing could be fused.
+static int fuse(b_optimizer *o, int offset, int length) {
+  b_blob *blob = o->blob;
+  uint8_t *code = blob->code;
+  int line = blob->lines[offset];
+  int next = offset + length;
+  int next_op = fusable(o, next);
+  int start = o->count;
+
+  switch (code[offset]) {
+    case OP_DUP: {
+      // a value duplicated only to be discarded.
+      if (next_op == OP_POP) {
+        map_range(o, offset, next + 1);
+        return next + 1;
+      }
+      break;
+    }
+
+    case OP_SET_LOCAL: {
+      if (next_op == OP_POP) {
+        map_range(o, offset, next + 1);
+        emit(o, OP_SET_LOCAL_POP, line);
+        emit_short(o, read_short(code, offset + 1), line);
+        return next + 1;
+      }
+      break;
+    }
+
+    case OP_JUMP_IF_FALSE: {
+      // both edges of a condition start by popping it, so the pop can move
+      // into the jump as long as the target really is that pop.
+      int target = next + read_short(code, offset + 1);
+      if (next_op == OP_POP && target < blob->count && code[target] == OP_POP) {
+        map_range(o, offset, next + 1);
+        emit(o, OP_POP_JUMP_IF_FALSE, line);
+        emit_short(o, 0, line);
+        add_jump(o, FIX_SKIP_POP, start + 1, start + 3, target);
+        return next + 1;
+      }
+      break;
+    }
+
+    case OP_LESS:
+    case OP_GREATER: {
+      if (next_op == OP_JUMP_IF_FALSE) {
+        int after = next + 3;
+        int target = after + read_short(code, next + 1);
+        if (fusable(o, after) == OP_POP && target < blob->count && code[target] == OP_POP) {
+          map_range(o, offset, after + 1);
+          emit(o, code[offset] == OP_LESS ? OP_LESS_JUMP : OP_GREATER_JUMP, line);
+          emit_short(o, 0, line);
+          add_jump(o, FIX_SKIP_POP, start + 1, start + 3, target);
+          return after + 1;
+        }
+      }
+      break;
+    }
+
+    case OP_GET_LOCAL: {
+      uint16_t slot = read_short(code, offset + 1);
+
+      if (next_op == OP_INVOKE && code[next + 3] == 0) {
+        map_range(o, offset, next + 6);
+        emit(o, OP_INVOKE_LOCAL, line);
+        emit_short(o, slot, line);
+        emit_short(o, read_short(code, next + 1), line); // method name
+        emit(o, 0, line);                                // arg count
+        emit_short(o, read_short(code, next + 4), line); // inline cache
+        return next + 6;
+      } else if (next_op == OP_GET_LOCAL || next_op == OP_CONSTANT) {
+        map_range(o, offset, next + 3);
+        emit(o, next_op == OP_GET_LOCAL ? OP_GET_LOCALS : OP_GET_LOCAL_CONSTANT, line);
+        emit_short(o, slot, line);
+        emit_short(o, read_short(code, next + 1), line);
+        return next + 3;
+      }
+      break;
+    }
+
+    default:
+      break;
+  }
+
+  return -1;
+}
+
+// reads the local or constant pushed by the instruction at offset as a
+// register operand. returns the offset just past it, or -1 if it is not
+// one that can be addressed directly.
+static int register_operand(b_optimizer *o, int offset, uint16_t *operand) {
+  uint8_t *code = o->blob->code;
+  uint16_t index;
+
+  switch (code[offset]) {
+    case OP_GET_LOCAL:
+      index = read_short(code, offset + 1);
+      if (index >= REG_CONSTANT) return -1;
+      *operand = index;
+      return offset + 3;
+    case OP_CONSTANT:
+      index = read_short(code, offset + 1);
+      if (index >= REG_CONSTANT) return -1;
+      *operand = index | REG_CONSTANT;
+      return offset + 3;
+    case OP_ONE:
+      if (o->one == -1) {
+        o->one = add_constant(o->vm, o->blob, INTEGER_VAL(1));
+      }
+      if (o->one >= REG_CONSTANT) return -1;
+      *operand = o->one | REG_CONSTANT;
+      return offset + 1;
+    default:
+      return -1;
+  }
+}
+
+static inline int register_operand_at(b_optimizer *o, int offset, uint16_t *operand) {
+  return fusable(o, offset) == -1 ? -1 : register_operand(o, offset, operand);
+}
+
+static inline uint8_t register_arithmetic(int op) {
+  switch (op) {
+    case OP_ADD: return OP_REG_ADD;
+    case OP_SUBTRACT: return OP_REG_SUBTRACT;
+    case OP_MULTIPLY: return OP_REG_MULTIPLY;
+    case OP_DIVIDE: return OP_REG_DIVIDE;
+    default: return 0;
+  }
+}
+
+// keeps the stack instructions in [offset, end) behind the register
+// instruction emitted at start, which takes over offset as a jump target.
+static int emit_fallback(b_optimizer *o, int start, int offset, int end) {
+  for (int i = offset; i < end; i += instruction_length(o->blob, i)) {
+    copy_instruction(o, i, instruction_length(o->blob, i));
+  }
+  o->map[offset] = start;
+  return end;
+}
+
+static int lower_to_registers(b_optimizer *o, int offset, int length) {
+  b_blob *blob = o->blob;
+  uint8_t *code = blob->code;
+  int line = blob->lines[offset];
+  int start = o->count;
+  uint16_t a, b;
+
+  int next = register_operand(o, offset, &a);
+  if (next == -1) return -1;
+
+  // local = a
+  if (fusable(o, next) == OP_SET_LOCAL && fusable(o, next + 3) == OP_POP) {
+    int end = next + 4;
+    emit(o, OP_REG_MOVE, line);
+    emit_short(o, read_short(code, next + 1), line);
+    emit_short(o, a, line);
+    emit_short(o, 0, line);
+    add_jump(o, FIX_FORWARD, start + 5, start + 7, end);
+    return emit_fallback(o, start, offset, end);
+  }
+
+  next = register_operand_at(o, next, &b);
+  if (next == -1) return -1;
+  int op = fusable(o, next);
+
+  // local = a op b, or a op b on its own
+  uint8_t reg_op = register_arithmetic(op);
+  if (reg_op != 0) {
+    bool to_local = fusable(o, next + 1) == OP_SET_LOCAL && fusable(o, next + 4) == OP_POP;
+    int end = to_local ? next + 5 : next + 1;
+    emit(o, reg_op, line);
+    emit_short(o, to_local ? read_short(code, next + 2) : REG_PUSH, line);
+    emit_short(o, a, line);
+    emit_short(o, b, line);
+    emit_short(o, 0, line);
+    add_jump(o, FIX_FORWARD, start + 7, start + 9, end);
+    return emit_fallback(o, start, offset, end);
+  }
+
+  // if a < b, while a > b...
+  if ((op == OP_LESS || op == OP_GREATER) && fusable(o, next + 1) == OP_JUMP_IF_FALSE
+      && fusable(o, next + 4) == OP_POP) {
+    int target = next + 4 + read_short(code, next + 2);
+    if (target < blob->count && code[target] == OP_POP) {
+      int end = next + 5;
+      emit(o, op == OP_LESS ? OP_REG_LESS_JUMP : OP_REG_GREATER_JUMP, line);
+      emit_short(o, a, line);
+      emit_short(o, b, line);
+      emit_short(o, 0, line);
+      emit_short(o, 0, line);
+      add_jump(o, FIX_FORWARD, start + 5, start + 9, end);
+      add_jump(o, FIX_SKIP_POP, start + 7, start + 9, target);
+      return emit_fallback(o, start, offset, end);
+    }
+  }
+
+  return -1;
+}
+
+static void patch_offsets(b_optimizer *o) {
+  for (int i = 0; i < o->jump_count; i++) {
+    b_jump_fix *fix = &o->jumps[i];
+    int target = o->map[fix->target];
+
+    switch (fix->type) {
+      case FIX_FORWARD:
+        write_short(o->code, fix->operand, target - fix->end);
+        break;
+      case FIX_SKIP_POP:
+        write_short(o->code, fix->operand, target + 1 - fix->end);
+        break;
+      case FIX_BACKWARD:
+        write_short(o->code, fix->operand, fix->end - target);
+        break;
+    }
+  }
+
+  for (int i = 0; i < o->switch_count; i++) {
+    b_switch_fix *fix = &o->switches[i];
+    b_obj_switch *sw = fix->sw;
+
+    for (int j = 0; j < sw->table.capacity; j++) {
+      b_entry *entry = &sw->table.entries[j];
+      if (!IS_EMPTY(entry->key)) {
+        int target = o->map[fix->old_base + (int) AS_NUMBER(entry->value)];
+        entry->value = NUMBER_VAL(target - fix->new_base);
+      }
+    }
+
+    if (sw->default_jump != -1) {
+      sw->default_jump = o->map[fix->old_base + sw->default_jump] - fix->new_base;
+    }
+    sw->exit_jump = o->map[fix->old_base + sw->exit_jump] - fix->new_base;
+  }
+
+  // 0 still marks a missing catch or finally block.
+  for (int i = 0; i < o->blob->handler_count; i++) {
+    b_handler *handler = &o->blob->handlers[i];
+    handler->start = o->map[handler->start];
+    handler->end = o->map[handler->end];
+    if (handler->address != 0) {
+      handler->address = o->map[handler->address];
+    }
+    if (handler->finally_address != 0) {
+      handler->finally_address = o->map[handler->finally_address];
+    }
+  }
+}
+
+static void rewrite_blob(b_vm *vm, b_blob *blob, int growth, b_rewrite_fn rewrite) {
+  int count = blob->count;
+  if (count == 0) return;
+
+  b_optimizer o;
+  o.vm = vm;
+  o.blob = blob;
+  o.targets = calloc(count + 1, sizeof(bool));
+  o.map = malloc(sizeof(int) * (count + 1));
+  o.code = malloc(sizeof(uint8_t) * count * growth);
+  o.lines = malloc(sizeof(int) * count * growth);
+  o.jumps = malloc(sizeof(b_jump_fix) * count);
+  o.switches = malloc(sizeof(b_switch_fix) * count);
+  o.count = o.jump_count = o.switch_count = 0;
+  o.one = -1;
+
+  if (o.targets != NULL && o.map != NULL && o.code != NULL
+      && o.lines != NULL && o.jumps != NULL && o.switches != NULL) {
+    mark_targets(&o);
+
+    int offset = 0;
+    while (offset < count) {
+      int length = instruction_length(blob, offset);
+      int next = rewrite(&o, offset, length);
+      if (next == -1) {
+        copy_instruction(&o, offset, length);
+        next = offset + length;
+      }
+      offset = next;
+    }
+    o.map[count] = o.count;
+
+    patch_offsets(&o);
+
+    FREE_ARRAY(uint8_t, blob->code, blob->capacity);
+    FREE_ARRAY(int, blob->lines, blob->capacity);
+    blob->code = ALLOCATE(uint8_t, o.count);
+    blob->lines = ALLOCATE(int, o.count);
+    memcpy(blob->code, o.code, sizeof(uint8_t) * o.count);
+    memcpy(blob->lines, o.lines, sizeof(int) * o.count);
+    blob->count = blob->capacity = o.count;
+  }
+
+  free(o.targets);
+  free(o.map);
+  free(o.code);
+  free(o.lines);
+  free(o.jumps);
+  free(o.switches);
+}
+
+void optimize_blob(b_vm *vm, b_blob *blob) {
+  // fused instructions are never longer than the ones they replace,
+  // so the old size bounds everything.
+  rewrite_blob(vm, blob, 1, fuse);
+}
+
+void lower_blob(b_vm *vm, b_blob *blob) {
+  // the shortest sequence with a register form is three bytes long and
+  // gains nine in front of it.
+  rewrite_blob(vm, blob, 4, lower_to_registers);
+}
@@ -0,0 +1,22 @@
+#ifndef BLADE_OPTIMIZER_H
+#define BLADE_OPTIMIZER_H
+
+#include "blob.h"
+#include "vm.h"
+
+/**
+ * rewrites the bytecode of a finished blob in place, fusing common
+ * instruction sequences into superinstructions and dropping redundant
+ * ones. all jump offsets, exception handler addresses and switch tables
+ * are patched to the new layout.
+ */
+void optimize_blob(b_vm *vm, b_blob *blob);
+
+/**
+ * puts a register instruction in front of every statement in the blob
+ * that only computes with locals and constants, leaving the stack
+ * instructions behind it for operands that are not numbers.
+ */
+void lower_blob(b_vm *vm, b_blob *blob);
+
+#endif
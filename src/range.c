@@ -2,12 +2,12 @@
 
 DECLARE_RANGE_METHOD(lower) {
   ENFORCE_ARG_COUNT(lower, 0);
-  RETURN_NUMBER(AS_RANGE(METHOD_OBJECT)->lower);
+  RETURN_LONG(AS_RANGE(METHOD_OBJECT)->lower);
 }
 
 DECLARE_RANGE_METHOD(upper) {
   ENFORCE_ARG_COUNT(upper, 0);
-  RETURN_NUMBER(AS_RANGE(METHOD_OBJECT)->upper);
+  RETURN_LONG(AS_RANGE(METHOD_OBJECT)->upper);
 }
 
 DECLARE_RANGE_METHOD(__iter__) {
@@ -16,11 +16,11 @@ DECLARE_RANGE_METHOD(__iter__) {
 
   b_obj_range *range = AS_RANGE(METHOD_OBJECT);
 
-  int index = AS_NUMBER(args[0]);
+  int index = AS_LONG(args[0]);
 
   if (index >= 0 && index < range->range) {
-    if(index == 0) RETURN_NUMBER(range->lower);
-    RETURN_NUMBER(range->lower > range->upper ? --range->lower : ++range->lower);
+    if(index == 0) RETURN_LONG(range->lower);
+    RETURN_LONG(range->lower > range->upper ? --range->lower : ++range->lower);
   }
 
   RETURN_NIL;
@@ -34,16 +34,16 @@ DECLARE_RANGE_METHOD(__itern__) {
     if (range->range == 0) {
       RETURN_NIL;
     }
-    RETURN_NUMBER(0);
+    RETURN_LONG(0);
   }
 
   if (!IS_NUMBER(args[0])) {
     RETURN_ERROR("ranges are numerically indexed");
   }
 
-  int index = (int)AS_NUMBER(args[0]) + 1;
+  int index = (int)AS_LONG(args[0]) + 1;
   if (index < range->range) {
-    RETURN_NUMBER(index);
+    RETURN_LONG(index);
   }
 
   RETURN_NIL;
@@ -11,6 +11,9 @@ void array_free(void *data) {
   }
 }
 
+// elements above the range of the integer tag come back as doubles.
+#define UINT64_VAL(v) ((v) > (uint64_t) INT64_MAX ? NUMBER_VAL((double) (v)) : LONG_VAL((int64_t) (v)))
+
 b_obj_ptr *new_array(b_vm *vm, b_array *array) {
   b_obj_ptr *ptr = (b_obj_ptr *)GC(new_ptr(vm, array));
   ptr->free_fn = &array_free;
@@ -28,7 +31,7 @@ b_array *new_int16_array(b_vm *vm, int length) {
 DECLARE_MODULE_METHOD(array__int16array) {
   ENFORCE_ARG_COUNT(int16array, 1);
   if (IS_NUMBER(args[0])) {
-    RETURN_OBJ(new_array(vm, new_int16_array(vm, (int) AS_NUMBER(args[0]))));
+    RETURN_OBJ(new_array(vm, new_int16_array(vm, (int) AS_LONG(args[0]))));
   } else if (IS_LIST(args[0])) {
     b_obj_list *list = AS_LIST(args[0]);
     b_array *array = new_int16_array(vm, list->items.count);
@@ -39,7 +42,7 @@ DECLARE_MODULE_METHOD(array__int16array) {
         RETURN_ERROR("Int16Array() expects a list of valid int16");
       }
 
-      values[i] = (int16_t) AS_NUMBER(list->items.values[i]);
+      values[i] = (int16_t) AS_LONG(list->items.values[i]);
     }
 
     RETURN_OBJ(new_array(vm, array));
@@ -58,7 +61,7 @@ DECLARE_MODULE_METHOD(array_int16_append) {
     array->buffer = GROW_ARRAY(int16_t, array->buffer, array->length, array->length++);
 
     int16_t *values = (int16_t *)array->buffer;
-    values[array->length - 1] = (int16_t) AS_NUMBER(args[1]);
+    values[array->length - 1] = (int16_t) AS_LONG(args[1]);
 
   } else if (IS_LIST(args[1])) {
     b_obj_list *list = AS_LIST(args[1]);
@@ -73,7 +76,7 @@ DECLARE_MODULE_METHOD(array_int16_append) {
           RETURN_ERROR("Int16Array lists can only contain numbers");
         }
 
-        values[array->length + i] = (int16_t) AS_NUMBER(list->items.values[i]);
+        values[array->length + i] = (int16_t) AS_LONG(list->items.values[i]);
       }
 
       array->length += list->items.count;
@@ -93,12 +96,12 @@ DECLARE_MODULE_METHOD(array_int16_get) {
   b_array  *array = (b_array *) AS_PTR(args[0])->pointer;
   int16_t *data = (int16_t *)array->buffer;
 
-  int index = AS_NUMBER(args[1]);
+  int index = AS_LONG(args[1]);
   if (index < 0 || index >= array->length) {
     RETURN_ERROR("Int16Array index %d out of range", index);
   }
 
-  RETURN_NUMBER((double) data[index]);
+  RETURN_LONG(data[index]);
 }
 
 DECLARE_MODULE_METHOD(array_int16_reverse) {
@@ -137,7 +140,7 @@ DECLARE_MODULE_METHOD(array_int16_pop) {
   int16_t last = ((int16_t *)array->buffer)[array->length - 1];
   array->length--;
 
-  RETURN_NUMBER(last);
+  RETURN_LONG(last);
 }
 
 DECLARE_MODULE_METHOD(array_int16_remove) {
@@ -148,7 +151,7 @@ DECLARE_MODULE_METHOD(array_int16_remove) {
   b_array  *array = (b_array *) AS_PTR(args[0])->pointer;
   int16_t *values = (int16_t *)array->buffer;
 
-  int index = AS_NUMBER(args[1]);
+  int index = AS_LONG(args[1]);
 
   if (index < 0 || index >= array->length) {
     RETURN_ERROR("Int16Array index %d out of range", index);
@@ -161,7 +164,7 @@ DECLARE_MODULE_METHOD(array_int16_remove) {
   }
   array->length--;
 
-  RETURN_NUMBER(val);
+  RETURN_LONG(val);
 }
 
 DECLARE_MODULE_METHOD(array_int16_to_list) {
@@ -174,7 +177,7 @@ DECLARE_MODULE_METHOD(array_int16_to_list) {
   b_obj_list *list = (b_obj_list *)GC(new_list(vm));
 
   for (int i = 0; i < array->length; i++) {
-    write_list(vm, list, NUMBER_VAL((double)values[i]));
+    write_list(vm, list, LONG_VAL(values[i]));
   }
 
   RETURN_OBJ(list);
@@ -200,10 +203,10 @@ DECLARE_MODULE_METHOD(array_int16___iter__) {
   b_array  *array = (b_array *) AS_PTR(args[0])->pointer;
   int16_t *values = (int16_t *)array->buffer;
 
-  int index = AS_NUMBER(args[1]);
+  int index = AS_LONG(args[1]);
 
   if (index > -1 && index < array->length) {
-    RETURN_NUMBER(values[index]);
+    RETURN_LONG(values[index]);
   }
 
   RETURN_NIL;
@@ -222,7 +225,7 @@ b_array *new_int32_array(b_vm *vm, int length) {
 DECLARE_MODULE_METHOD(array__int32array) {
   ENFORCE_ARG_COUNT(int32array, 1);
   if (IS_NUMBER(args[0])) {
-    RETURN_OBJ(new_array(vm, new_int32_array(vm, (int) AS_NUMBER(args[0]))));
+    RETURN_OBJ(new_array(vm, new_int32_array(vm, (int) AS_LONG(args[0]))));
   } else if (IS_LIST(args[0])) {
     b_obj_list *list = AS_LIST(args[0]);
     b_array *array = new_int32_array(vm, list->items.count);
@@ -233,7 +236,7 @@ DECLARE_MODULE_METHOD(array__int32array) {
         RETURN_ERROR("Int32Array() expects a list of valid int32");
       }
 
-      values[i] = (int32_t) AS_NUMBER(list->items.values[i]);
+      values[i] = (int32_t) AS_LONG(list->items.values[i]);
     }
 
     RETURN_OBJ(new_array(vm, array));
@@ -252,7 +255,7 @@ DECLARE_MODULE_METHOD(array_int32_append) {
     array->buffer = GROW_ARRAY(int32_t, array->buffer, array->length, array->length++);
 
     int32_t *values = (int32_t *)array->buffer;
-    values[array->length - 1] = (int32_t) AS_NUMBER(args[1]);
+    values[array->length - 1] = (int32_t) AS_LONG(args[1]);
 
   } else if (IS_LIST(args[1])) {
     b_obj_list *list = AS_LIST(args[1]);
@@ -267,7 +270,7 @@ DECLARE_MODULE_METHOD(array_int32_append) {
           RETURN_ERROR("Int32Array lists can only contain numbers");
         }
 
-        values[array->length + i] = (int32_t) AS_NUMBER(list->items.values[i]);
+        values[array->length + i] = (int32_t) AS_LONG(list->items.values[i]);
       }
 
       array->length += list->items.count;
@@ -287,12 +290,12 @@ DECLARE_MODULE_METHOD(array_int32_get) {
   b_array  *array = (b_array *) AS_PTR(args[0])->pointer;
   int32_t *data = (int32_t *)array->buffer;
 
-  int index = AS_NUMBER(args[1]);
+  int index = AS_LONG(args[1]);
   if (index < 0 || index >= array->length) {
     RETURN_ERROR("Int32Array index %d out of range", index);
   }
 
-  RETURN_NUMBER((double) data[index]);
+  RETURN_LONG(data[index]);
 }
 
 DECLARE_MODULE_METHOD(array_int32_reverse) {
@@ -331,7 +334,7 @@ DECLARE_MODULE_METHOD(array_int32_pop) {
   int32_t last = ((int32_t *)array->buffer)[array->length - 1];
   array->length--;
 
-  RETURN_NUMBER(last);
+  RETURN_LONG(last);
 }
 
 DECLARE_MODULE_METHOD(array_int32_remove) {
@@ -342,7 +345,7 @@ DECLARE_MODULE_METHOD(array_int32_remove) {
   b_array  *array = (b_array *) AS_PTR(args[0])->pointer;
   int32_t *values = (int32_t *)array->buffer;
 
-  int index = AS_NUMBER(args[1]);
+  int index = AS_LONG(args[1]);
 
   if (index < 0 || index >= array->length) {
     RETURN_ERROR("Int32Array index %d out of range", index);
@@ -355,7 +358,7 @@ DECLARE_MODULE_METHOD(array_int32_remove) {
   }
   array->length--;
 
-  RETURN_NUMBER(val);
+  RETURN_LONG(val);
 }
 
 DECLARE_MODULE_METHOD(array_int32_to_list) {
@@ -368,7 +371,7 @@ DECLARE_MODULE_METHOD(array_int32_to_list) {
   b_obj_list *list = (b_obj_list *)GC(new_list(vm));
 
   for (int i = 0; i < array->length; i++) {
-    write_list(vm, list, NUMBER_VAL((double)values[i]));
+    write_list(vm, list, LONG_VAL(values[i]));
   }
 
   RETURN_OBJ(list);
@@ -394,10 +397,10 @@ DECLARE_MODULE_METHOD(array_int32___iter__) {
   b_array  *array = (b_array *) AS_PTR(args[0])->pointer;
   int32_t *values = (int32_t *)array->buffer;
 
-  int index = AS_NUMBER(args[1]);
+  int index = AS_LONG(args[1]);
 
   if (index > -1 && index < array->length) {
-    RETURN_NUMBER(values[index]);
+    RETURN_LONG(values[index]);
   }
 
   RETURN_NIL;
@@ -416,7 +419,7 @@ b_array *new_int64_array(b_vm *vm, int length) {
 DECLARE_MODULE_METHOD(array__int64array) {
   ENFORCE_ARG_COUNT(int64array, 1);
   if (IS_NUMBER(args[0])) {
-    RETURN_OBJ(new_array(vm, new_int64_array(vm, (int) AS_NUMBER(args[0]))));
+    RETURN_OBJ(new_array(vm, new_int64_array(vm, (int) AS_LONG(args[0]))));
   } else if (IS_LIST(args[0])) {
     b_obj_list *list = AS_LIST(args[0]);
     b_array *array = new_int64_array(vm, list->items.count);
@@ -427,7 +430,7 @@ DECLARE_MODULE_METHOD(array__int64array) {
         RETURN_ERROR("Int64Array() expects a list of valid int64");
       }
 
-      values[i] = (int64_t) AS_NUMBER(list->items.values[i]);
+      values[i] = (int64_t) AS_LONG(list->items.values[i]);
     }
 
     RETURN_OBJ(new_array(vm, array));
@@ -446,7 +449,7 @@ DECLARE_MODULE_METHOD(array_int64_append) {
     array->buffer = GROW_ARRAY(int64_t, array->buffer, array->length, array->length++);
 
     int64_t *values = (int64_t *)array->buffer;
-    values[array->length - 1] = (int64_t) AS_NUMBER(args[1]);
+    values[array->length - 1] = (int64_t) AS_LONG(args[1]);
 
   } else if (IS_LIST(args[1])) {
     b_obj_list *list = AS_LIST(args[1]);
@@ -461,7 +464,7 @@ DECLARE_MODULE_METHOD(array_int64_append) {
           RETURN_ERROR("Int64Array lists can only contain numbers");
         }
 
-        values[array->length + i] = (int64_t) AS_NUMBER(list->items.values[i]);
+        values[array->length + i] = (int64_t) AS_LONG(list->items.values[i]);
       }
 
       array->length += list->items.count;
@@ -481,12 +484,12 @@ DECLARE_MODULE_METHOD(array_int64_get) {
   b_array  *array = (b_array *) AS_PTR(args[0])->pointer;
   int64_t *data = (int64_t *)array->buffer;
 
-  int index = AS_NUMBER(args[1]);
+  int index = AS_LONG(args[1]);
   if (index < 0 || index >= array->length) {
     RETURN_ERROR("Int64Array index %d out of range", index);
   }
 
-  RETURN_NUMBER((double) data[index]);
+  RETURN_LONG(data[index]);
 }
 
 DECLARE_MODULE_METHOD(array_int64_reverse) {
@@ -525,7 +528,7 @@ DECLARE_MODULE_METHOD(array_int64_pop) {
   int64_t last = ((int64_t *)array->buffer)[array->length - 1];
   array->length--;
 
-  RETURN_NUMBER(last);
+  RETURN_LONG(last);
 }
 
 DECLARE_MODULE_METHOD(array_int64_remove) {
@@ -536,7 +539,7 @@ DECLARE_MODULE_METHOD(array_int64_remove) {
   b_array  *array = (b_array *) AS_PTR(args[0])->pointer;
   int64_t *values = (int64_t *)array->buffer;
 
-  int index = AS_NUMBER(args[1]);
+  int index = AS_LONG(args[1]);
 
   if (index < 0 || index >= array->length) {
     RETURN_ERROR("Int64Array index %d out of range", index);
@@ -549,7 +552,7 @@ DECLARE_MODULE_METHOD(array_int64_remove) {
   }
   array->length--;
 
-  RETURN_NUMBER(val);
+  RETURN_LONG(val);
 }
 
 DECLARE_MODULE_METHOD(array_int64_to_list) {
@@ -562,7 +565,7 @@ DECLARE_MODULE_METHOD(array_int64_to_list) {
   b_obj_list *list = (b_obj_list *)GC(new_list(vm));
 
   for (int i = 0; i < array->length; i++) {
-    write_list(vm, list, NUMBER_VAL((double)values[i]));
+    write_list(vm, list, LONG_VAL(values[i]));
   }
 
   RETURN_OBJ(list);
@@ -588,10 +591,10 @@ DECLARE_MODULE_METHOD(array_int64___iter__) {
   b_array  *array = (b_array *) AS_PTR(args[0])->pointer;
   int64_t *values = (int64_t *)array->buffer;
 
-  int index = AS_NUMBER(args[1]);
+  int index = AS_LONG(args[1]);
 
   if (index > -1 && index < array->length) {
-    RETURN_NUMBER(values[index]);
+    RETURN_LONG(values[index]);
   }
 
   RETURN_NIL;
@@ -610,7 +613,7 @@ b_array *new_uint16_array(b_vm *vm, int length) {
 DECLARE_MODULE_METHOD(array__uint16array) {
   ENFORCE_ARG_COUNT(uint16array, 1);
   if (IS_NUMBER(args[0])) {
-    RETURN_OBJ(new_array(vm, new_uint16_array(vm, (int) AS_NUMBER(args[0]))));
+    RETURN_OBJ(new_array(vm, new_uint16_array(vm, (int) AS_LONG(args[0]))));
   } else if (IS_LIST(args[0])) {
     b_obj_list *list = AS_LIST(args[0]);
     b_array *array = new_uint16_array(vm, list->items.count);
@@ -621,7 +624,7 @@ DECLARE_MODULE_METHOD(array__uint16array) {
         RETURN_ERROR("UInt16Array() expects a list of valid uint16");
       }
 
-      values[i] = (uint16_t) AS_NUMBER(list->items.values[i]);
+      values[i] = (uint16_t) AS_LONG(list->items.values[i]);
     }
 
     RETURN_OBJ(new_array(vm, array));
@@ -640,7 +643,7 @@ DECLARE_MODULE_METHOD(array_uint16_append) {
     array->buffer = GROW_ARRAY(uint16_t, array->buffer, array->length, array->length++);
 
     uint16_t *values = (uint16_t *)array->buffer;
-    values[array->length - 1] = (uint16_t) AS_NUMBER(args[1]);
+    values[array->length - 1] = (uint16_t) AS_LONG(args[1]);
 
   } else if (IS_LIST(args[1])) {
     b_obj_list *list = AS_LIST(args[1]);
@@ -655,7 +658,7 @@ DECLARE_MODULE_METHOD(array_uint16_append) {
           RETURN_ERROR("UInt16Array lists can only contain numbers");
         }
 
-        values[array->length + i] = (uint16_t) AS_NUMBER(list->items.values[i]);
+        values[array->length + i] = (uint16_t) AS_LONG(list->items.values[i]);
       }
 
       array->length += list->items.count;
@@ -675,12 +678,12 @@ DECLARE_MODULE_METHOD(array_uint16_get) {
   b_array  *array = (b_array *) AS_PTR(args[0])->pointer;
   uint16_t *data = (uint16_t *)array->buffer;
 
-  int index = AS_NUMBER(args[1]);
+  int index = AS_LONG(args[1]);
   if (index < 0 || index >= array->length) {
     RETURN_ERROR("UInt16Array index %d out of range", index);
   }
 
-  RETURN_NUMBER((double) data[index]);
+  RETURN_LONG(data[index]);
 }
 
 DECLARE_MODULE_METHOD(array_uint16_reverse) {
@@ -719,7 +722,7 @@ DECLARE_MODULE_METHOD(array_uint16_pop) {
   uint16_t last = ((uint16_t *)array->buffer)[array->length - 1];
   array->length--;
 
-  RETURN_NUMBER(last);
+  RETURN_LONG(last);
 }
 
 DECLARE_MODULE_METHOD(array_uint16_remove) {
@@ -730,7 +733,7 @@ DECLARE_MODULE_METHOD(array_uint16_remove) {
   b_array  *array = (b_array *) AS_PTR(args[0])->pointer;
   uint16_t *values = (uint16_t *)array->buffer;
 
-  int index = AS_NUMBER(args[1]);
+  int index = AS_LONG(args[1]);
 
   if (index < 0 || index >= array->length) {
     RETURN_ERROR("UInt16Array index %d out of range", index);
@@ -743,7 +746,7 @@ DECLARE_MODULE_METHOD(array_uint16_remove) {
   }
   array->length--;
 
-  RETURN_NUMBER(val);
+  RETURN_LONG(val);
 }
 
 DECLARE_MODULE_METHOD(array_uint16_to_list) {
@@ -756,7 +759,7 @@ DECLARE_MODULE_METHOD(array_uint16_to_list) {
   b_obj_list *list = (b_obj_list *)GC(new_list(vm));
 
   for (int i = 0; i < array->length; i++) {
-    write_list(vm, list, NUMBER_VAL((double)values[i]));
+    write_list(vm, list, LONG_VAL(values[i]));
   }
 
   RETURN_OBJ(list);
@@ -782,10 +785,10 @@ DECLARE_MODULE_METHOD(array_uint16___iter__) {
   b_array  *array = (b_array *) AS_PTR(args[0])->pointer;
   uint16_t *values = (uint16_t *)array->buffer;
 
-  int index = AS_NUMBER(args[1]);
+  int index = AS_LONG(args[1]);
 
   if (index > -1 && index < array->length) {
-    RETURN_NUMBER(values[index]);
+    RETURN_LONG(values[index]);
   }
 
   RETURN_NIL;
@@ -804,7 +807,7 @@ b_array *new_uint32_array(b_vm *vm, int length) {
 DECLARE_MODULE_METHOD(array__uint32array) {
   ENFORCE_ARG_COUNT(uint32array, 1);
   if (IS_NUMBER(args[0])) {
-    RETURN_OBJ(new_array(vm, new_uint32_array(vm, (int) AS_NUMBER(args[0]))));
+    RETURN_OBJ(new_array(vm, new_uint32_array(vm, (int) AS_LONG(args[0]))));
   } else if (IS_LIST(args[0])) {
     b_obj_list *list = AS_LIST(args[0]);
     b_array *array = new_uint32_array(vm, list->items.count);
@@ -815,7 +818,7 @@ DECLARE_MODULE_METHOD(array__uint32array) {
         RETURN_ERROR("UInt32Array() expects a list of valid uint32");
       }
 
-      values[i] = (uint32_t) AS_NUMBER(list->items.values[i]);
+      values[i] = (uint32_t) AS_LONG(list->items.values[i]);
     }
 
     RETURN_OBJ(new_array(vm, array));
@@ -834,7 +837,7 @@ DECLARE_MODULE_METHOD(array_uint32_append) {
     array->buffer = GROW_ARRAY(uint32_t, array->buffer, array->length, array->length++);
 
     uint32_t *values = (uint32_t *)array->buffer;
-    values[array->length - 1] = (uint32_t) AS_NUMBER(args[1]);
+    values[array->length - 1] = (uint32_t) AS_LONG(args[1]);
 
   } else if (IS_LIST(args[1])) {
     b_obj_list *list = AS_LIST(args[1]);
@@ -849,7 +852,7 @@ DECLARE_MODULE_METHOD(array_uint32_append) {
           RETURN_ERROR("UInt32Array lists can only contain numbers");
         }
 
-        values[array->length + i] = (uint32_t) AS_NUMBER(list->items.values[i]);
+        values[array->length + i] = (uint32_t) AS_LONG(list->items.values[i]);
       }
 
       array->length += list->items.count;
@@ -869,12 +872,12 @@ DECLARE_MODULE_METHOD(array_uint32_get) {
   b_array  *array = (b_array *) AS_PTR(args[0])->pointer;
   uint32_t *data = (uint32_t *)array->buffer;
 
-  int index = AS_NUMBER(args[1]);
+  int index = AS_LONG(args[1]);
   if (index < 0 || index >= array->length) {
     RETURN_ERROR("UInt32Array index %d out of range", index);
   }
 
-  RETURN_NUMBER((double) data[index]);
+  RETURN_LONG(data[index]);
 }
 
 DECLARE_MODULE_METHOD(array_uint32_reverse) {
@@ -913,7 +916,7 @@ DECLARE_MODULE_METHOD(array_uint32_pop) {
   uint32_t last = ((uint32_t *)array->buffer)[array->length - 1];
   array->length--;
 
-  RETURN_NUMBER(last);
+  RETURN_LONG(last);
 }
 
 DECLARE_MODULE_METHOD(array_uint32_remove) {
@@ -924,7 +927,7 @@ DECLARE_MODULE_METHOD(array_uint32_remove) {
   b_array  *array = (b_array *) AS_PTR(args[0])->pointer;
   uint32_t *values = (uint32_t *)array->buffer;
 
-  int index = AS_NUMBER(args[1]);
+  int index = AS_LONG(args[1]);
 
   if (index < 0 || index >= array->length) {
     RETURN_ERROR("UInt32Array index %d out of range", index);
@@ -937,7 +940,7 @@ DECLARE_MODULE_METHOD(array_uint32_remove) {
   }
   array->length--;
 
-  RETURN_NUMBER(val);
+  RETURN_LONG(val);
 }
 
 DECLARE_MODULE_METHOD(array_uint32_to_list) {
@@ -950,7 +953,7 @@ DECLARE_MODULE_METHOD(array_uint32_to_list) {
   b_obj_list *list = (b_obj_list *)GC(new_list(vm));
 
   for (int i = 0; i < array->length; i++) {
-    write_list(vm, list, NUMBER_VAL((double)values[i]));
+    write_list(vm, list, LONG_VAL(values[i]));
   }
 
   RETURN_OBJ(list);
@@ -976,10 +979,10 @@ DECLARE_MODULE_METHOD(array_uint32___iter__) {
   b_array  *array = (b_array *) AS_PTR(args[0])->pointer;
   uint32_t *values = (uint32_t *)array->buffer;
 
-  int index = AS_NUMBER(args[1]);
+  int index = AS_LONG(args[1]);
 
   if (index > -1 && index < array->length) {
-    RETURN_NUMBER(values[index]);
+    RETURN_LONG(values[index]);
   }
 
   RETURN_NIL;
@@ -998,7 +1001,7 @@ b_array *new_uint64_array(b_vm *vm, int length) {
 DECLARE_MODULE_METHOD(array__uint64array) {
   ENFORCE_ARG_COUNT(uint32array, 1);
   if (IS_NUMBER(args[0])) {
-    RETURN_OBJ(new_array(vm, new_uint64_array(vm, (int) AS_NUMBER(args[0]))));
+    RETURN_OBJ(new_array(vm, new_uint64_array(vm, (int) AS_LONG(args[0]))));
   } else if (IS_LIST(args[0])) {
     b_obj_list *list = AS_LIST(args[0]);
     b_array *array = new_uint64_array(vm, list->items.count);
@@ -1063,12 +1066,12 @@ DECLARE_MODULE_METHOD(array_uint64_get) {
   b_array  *array = (b_array *) AS_PTR(args[0])->pointer;
   uint64_t *data = (uint64_t *)array->buffer;
 
-  int index = AS_NUMBER(args[1]);
+  int index = AS_LONG(args[1]);
   if (index < 0 || index >= array->length) {
     RETURN_ERROR("UInt64Array index %d out of range", index);
   }
 
-  RETURN_NUMBER((double) data[index]);
+  RETURN_VALUE(UINT64_VAL(data[index]));
 }
 
 DECLARE_MODULE_METHOD(array_uint64_reverse) {
@@ -1107,7 +1110,7 @@ DECLARE_MODULE_METHOD(array_uint64_pop) {
   uint64_t last = ((uint64_t *)array->buffer)[array->length - 1];
   array->length--;
 
-  RETURN_NUMBER(last);
+  RETURN_VALUE(UINT64_VAL(last));
 }
 
 DECLARE_MODULE_METHOD(array_uint64_remove) {
@@ -1118,7 +1121,7 @@ DECLARE_MODULE_METHOD(array_uint64_remove) {
   b_array  *array = (b_array *) AS_PTR(args[0])->pointer;
   uint64_t *values = (uint64_t *)array->buffer;
 
-  int index = AS_NUMBER(args[1]);
+  int index = AS_LONG(args[1]);
 
   if (index < 0 || index >= array->length) {
     RETURN_ERROR("UInt64Array index %d out of range", index);
@@ -1131,7 +1134,7 @@ DECLARE_MODULE_METHOD(array_uint64_remove) {
   }
   array->length--;
 
-  RETURN_NUMBER(val);
+  RETURN_VALUE(UINT64_VAL(val));
 }
 
 DECLARE_MODULE_METHOD(array_uint64_to_list) {
@@ -1144,7 +1147,7 @@ DECLARE_MODULE_METHOD(array_uint64_to_list) {
   b_obj_list *list = (b_obj_list *)GC(new_list(vm));
 
   for (int i = 0; i < array->length; i++) {
-    write_list(vm, list, NUMBER_VAL((double)values[i]));
+    write_list(vm, list, UINT64_VAL(values[i]));
   }
 
   RETURN_OBJ(list);
@@ -1170,10 +1173,10 @@ DECLARE_MODULE_METHOD(array_uint64___iter__) {
   b_array  *array = (b_array *) AS_PTR(args[0])->pointer;
   uint64_t *values = (uint64_t *)array->buffer;
 
-  int index = AS_NUMBER(args[1]);
+  int index = AS_LONG(args[1]);
 
   if (index > -1 && index < array->length) {
-    RETURN_NUMBER(values[index]);
+    RETURN_VALUE(UINT64_VAL(values[index]));
   }
 
   RETURN_NIL;
@@ -1187,7 +1190,7 @@ DECLARE_MODULE_METHOD(array_length) {
   ENFORCE_ARG_TYPE(length, 0, IS_PTR);
 
   b_obj_ptr *ptr = AS_PTR(args[0]);
-  RETURN_NUMBER(((b_array *)ptr->pointer)->length);
+  RETURN_LONG(((b_array *)ptr->pointer)->length);
 }
 
 DECLARE_MODULE_METHOD(array_first) {
@@ -1234,7 +1237,7 @@ DECLARE_MODULE_METHOD(array___itern__) {
 
   if (IS_NIL(args[1])) {
     if (array->length == 0) RETURN_FALSE;
-    RETURN_NUMBER(0);
+    RETURN_LONG(0);
   }
 
   if (!IS_NUMBER(args[1])) {
@@ -1243,7 +1246,7 @@ DECLARE_MODULE_METHOD(array___itern__) {
 
   int index = AS_NUMBER(args[0]);
   if (index < array->length - 1) {
-    RETURN_NUMBER((double) index + 1);
+    RETURN_LONG(index + 1);
   }
 
   RETURN_NIL;
@@ -15,7 +15,9 @@ DECLARE_MODULE_METHOD(reflect__hasprop) {
 
   b_obj_instance *instance = AS_INSTANCE(args[0]);
   b_value dummy;
-  RETURN_BOOL(table_get(&instance->properties, args[1], &dummy));
+  RETURN_BOOL(!is_hidden_field(args[1])
+              && (instance_get_field(instance, args[1], &dummy)
+                  || get_stack_trace_field(vm, instance, AS_STRING(args[1]), &dummy)));
 }
 
 /**
@@ -32,7 +34,11 @@ DECLARE_MODULE_METHOD(reflect__getprop) {
 
   b_obj_instance *instance = AS_INSTANCE(args[0]);
   b_value value;
-  if (table_get(&instance->properties, args[1], &value)) {
+  if (is_hidden_field(args[1])) {
+    RETURN_NIL;
+  }
+  if (instance_get_field(instance, args[1], &value)
+      || get_stack_trace_field(vm, instance, AS_STRING(args[1]), &value)) {
     RETURN_VALUE(value);
   }
   RETURN_NIL;
@@ -54,7 +60,10 @@ DECLARE_MODULE_METHOD(reflect__setprop) {
   ENFORCE_ARG_TYPE(set_prop, 2, IS_STRING);
 
   b_obj_instance *instance = AS_INSTANCE(args[0]);
-  RETURN_BOOL(table_set(vm, &instance->properties, args[1], args[2]));
+  if (is_hidden_field(args[1])) {
+    RETURN_FALSE;
+  }
+  RETURN_BOOL(instance_set_dynamic_field(vm, instance, args[1], args[2]));
 }
 
 /**
@@ -69,7 +78,10 @@ DECLARE_MODULE_METHOD(reflect__delprop) {
   ENFORCE_ARG_TYPE(del_prop, 1, IS_STRING);
 
   b_obj_instance *instance = AS_INSTANCE(args[0]);
-  RETURN_BOOL(table_delete(&instance->properties, args[1]));
+  if (is_hidden_field(args[1])) {
+    RETURN_FALSE;
+  }
+  RETURN_BOOL(instance_delete_field(vm, instance, args[1]));
 }
 
 /**
@@ -126,17 +138,22 @@ DECLARE_MODULE_METHOD(reflect__call_method) {
     pop_n(vm, 3);
     push(vm, OBJ_VAL(bound));
 
-    // convert the list into function args
+    // convert the list into function args. the stack may move, so args
+    // has to be found again afterwards.
+    ptrdiff_t base = args - vm->stack;
     for(int i = 0; i < items_count; i++) {
       push(vm, list->items.values[i]);
     }
+    args = vm->stack + base;
 
-    b_call_frame *frame = &vm->frames[vm->frame_count++];
+    b_call_frame *frame = push_frame(vm);
+    if (frame == NULL) {
+      RETURN_ERROR("stack overflow");
+    }
     frame->closure = bound->method;
     frame->ip = bound->method->function->blob.code;
 
     frame->slots = vm->stack_top - items_count - 1;
-    vm->current_frame = frame;
   }
 
   RETURN;
@@ -188,7 +205,16 @@ DECLARE_MODULE_METHOD(reflect__get_class_metadata) {
 
   b_obj_dict *result = (b_obj_dict *)GC(new_dict(vm));
   dict_set_entry(vm, result, GC_STRING("name"), OBJ_VAL(class->name));
-  dict_set_entry(vm, result, GC_STRING("properties"), OBJ_VAL(table_get_keys(vm, &class->properties)));
+  b_obj_list *properties = (b_obj_list *)GC(table_get_keys(vm, &class->properties));
+  for (int i = 0; i < properties->items.count; i++) {
+    if (is_hidden_field(properties->items.values[i])) {
+      properties->items.count--;
+      memmove(&properties->items.values[i], &properties->items.values[i + 1],
+              sizeof(b_value) * (properties->items.count - i));
+      break;
+    }
+  }
+  dict_set_entry(vm, result, GC_STRING("properties"), OBJ_VAL(properties));
   dict_set_entry(vm, result, GC_STRING("static_properties"), OBJ_VAL(table_get_keys(vm, &class->static_properties)));
   dict_set_entry(vm, result, GC_STRING("methods"), OBJ_VAL(table_get_keys(vm, &class->methods)));
   dict_set_entry(vm, result, GC_STRING("superclass"), class->superclass != NULL ? OBJ_VAL(class->superclass) : NIL_VAL);
@@ -274,12 +300,14 @@ DECLARE_MODULE_METHOD(reflect__runscript) {
     b_obj_closure *cls = new_closure(vm, fn);
     pop(vm);
 
-    b_call_frame *frame = &vm->frames[vm->frame_count++];
+    b_call_frame *frame = push_frame(vm);
+    if (frame == NULL) {
+      RETURN_ERROR("stack overflow");
+    }
     frame->closure = cls;
     frame->ip = fn->blob.code;
 
     frame->slots = vm->stack_top - 1;
-    vm->current_frame = frame;
   }
 
   RETURN;
@@ -22,6 +22,7 @@
  */
 
 #include "module.h"
+#include "threads/threads.h"
 #include <stdlib.h>
 
 #ifdef _WIN32
@@ -1188,7 +1189,7 @@ DECLARE_MODULE_METHOD(struct_unpack) {
   RETURN_OBJ(return_value);
 }
 
-void __struct_module_preloader(b_vm *vm) {
+static void init_struct_maps(void) {
   int i;
 
 #if IS_LITTLE_ENDIAN
@@ -1304,6 +1305,13 @@ void __struct_module_preloader(b_vm *vm) {
 #endif
 }
 
+// the maps are shared by every vm in the process and only filled once.
+static once_flag struct_maps_once = ONCE_FLAG_INIT;
+
+void __struct_module_preloader(b_vm *vm) {
+  call_once(&struct_maps_once, init_struct_maps);
+}
+
 CREATE_MODULE_LOADER(struct) {
   static b_func_reg module_functions[] = {
       {"pack", true,  GET_MODULE_METHOD(struct_pack)},
@@ -0,0 +1,721 @@
+#include "module.h"
+#include "util.h"
+
+#include "threads/threads.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Isolates are independent VMs, each running on its own thread. Nothing on
+ * one VM's heap is ever seen by another: values sent over a channel are
+ * flattened into a message on the sending side and rebuilt on the receiving
+ * side. Channels are the only thing shared and are reference counted by the
+ * Channel instances that point to them in every VM.
+ */
+
+// deep enough for any sensible value, shallow enough to catch a list that
+// contains itself.
+#define MAX_MESSAGE_DEPTH 256
+
+typedef enum {
+  MESSAGE_NIL,
+  MESSAGE_TRUE,
+  MESSAGE_FALSE,
+  MESSAGE_NUMBER,
+  MESSAGE_INTEGER,
+  MESSAGE_STRING,
+  MESSAGE_BYTES,
+  MESSAGE_LIST,
+  MESSAGE_DICT,
+  MESSAGE_CHANNEL,
+} b_message_type;
+
+typedef struct b_message {
+  struct b_message *next;
+  size_t length;
+  unsigned char data[];
+} b_message;
+
+typedef struct {
+  mtx_t lock;
+  cnd_t ready;
+  b_message *head;
+  b_message *tail;
+  int refs;
+  bool closed;
+} b_channel;
+
+typedef struct {
+  unsigned char *data;
+  size_t length;
+  size_t capacity;
+} b_message_writer;
+
+typedef struct {
+  const unsigned char *data;
+  size_t position;
+} b_message_reader;
+
+// everything an isolate needs to start, copied out of the vm that started
+// it since that one may be gone before the isolate is done.
+typedef struct {
+  char *file;
+  char *function; // NULL when the whole file is the isolate
+  char *root_file;
+  b_message *args;
+  char **std_args;
+  int std_args_count;
+  size_t next_gc;
+  int gc_step_budget;
+  int gc_threads;
+  bool show_warnings;
+  bool should_optimize;
+  bool should_use_registers;
+  bool should_jit;
+} b_isolate;
+
+typedef struct {
+  thrd_t thread;
+  bool joined;
+} b_thread;
+
+// channels, messages and isolates outlive the vm that made them, so they
+// are not counted against any vm's heap.
+static void *allocate_shared(void *pointer, size_t size) {
+  void *result = realloc(pointer, size);
+  if (result == NULL) {
+    fprintf(stderr, "Device out of memory.");
+    exit(EXIT_FAILURE);
+  }
+  return result;
+}
+
+static b_channel *new_channel() {
+  b_channel *channel = (b_channel *) allocate_shared(NULL, sizeof(b_channel));
+  mtx_init(&channel->lock, mtx_plain);
+  cnd_init(&channel->ready);
+  channel->head = channel->tail = NULL;
+  channel->refs = 1;
+  channel->closed = false;
+  return channel;
+}
+
+static void retain_channel(b_channel *channel) {
+  mtx_lock(&channel->lock);
+  channel->refs++;
+  mtx_unlock(&channel->lock);
+}
+
+static void release_message(b_message *message);
+
+static void release_channel(void *data) {
+  b_channel *channel = (b_channel *) data;
+  mtx_lock(&channel->lock);
+  bool is_last = --channel->refs == 0;
+  mtx_unlock(&channel->lock);
+
+  if (is_last) {
+    b_message *message = channel->head;
+    while (message != NULL) {
+      b_message *next = message->next;
+      release_message(message);
+      message = next;
+    }
+    cnd_destroy(&channel->ready);
+    mtx_destroy(&channel->lock);
+    free(channel);
+  }
+}
+
+static void write_message_bytes(b_message_writer *writer, const void *bytes, size_t length) {
+  if (writer->length + length > writer->capacity) {
+    size_t capacity = GROW_CAPACITY(writer->capacity);
+    while (capacity < writer->length + length) {
+      capacity = GROW_CAPACITY(capacity);
+    }
+    writer->data = allocate_shared(writer->data, capacity);
+    writer->capacity = capacity;
+  }
+  memcpy(writer->data + writer->length, bytes, length);
+  writer->length += length;
+}
+
+static void write_message_tag(b_message_writer *writer, b_message_type type) {
+  uint8_t tag = (uint8_t) type;
+  write_message_bytes(writer, &tag, 1);
+}
+
+static void write_message_length(b_message_writer *writer, int length) {
+  write_message_bytes(writer, &length, sizeof(int));
+}
+
+static bool get_channel(b_vm *vm, b_value value, b_channel **channel);
+
+// returns the name of the type that could not be sent, or NULL when the
+// whole value was written.
+static const char *write_message_value(b_vm *vm, b_message_writer *writer, b_value value, int depth) {
+  if (depth > MAX_MESSAGE_DEPTH) {
+    return "deeply nested value";
+  }
+
+  if (IS_NIL(value)) {
+    write_message_tag(writer, MESSAGE_NIL);
+  } else if (IS_BOOL(value)) {
+    write_message_tag(writer, AS_BOOL(value) ? MESSAGE_TRUE : MESSAGE_FALSE);
+  } else if (IS_INTEGER(value)) {
+    int64_t integer = AS_INTEGER(value);
+    write_message_tag(writer, MESSAGE_INTEGER);
+    write_message_bytes(writer, &integer, sizeof(int64_t));
+  } else if (IS_NUMBER(value)) {
+    double number = AS_NUMBER(value);
+    write_message_tag(writer, MESSAGE_NUMBER);
+    write_message_bytes(writer, &number, sizeof(double));
+  } else if (IS_STRING(value)) {
+    b_obj_string *string = AS_STRING(value);
+    write_message_tag(writer, MESSAGE_STRING);
+    write_message_length(writer, string->length);
+    write_message_bytes(writer, string->chars, string->length);
+  } else if (IS_BYTES(value)) {
+    b_byte_arr bytes = AS_BYTES(value)->bytes;
+    write_message_tag(writer, MESSAGE_BYTES);
+    write_message_length(writer, bytes.count);
+    write_message_bytes(writer, bytes.bytes, bytes.count);
+  } else if (IS_LIST(value)) {
+    b_value_arr items = AS_LIST(value)->items;
+    write_message_tag(writer, MESSAGE_LIST);
+    write_message_length(writer, items.count);
+    for (int i = 0; i < items.count; i++) {
+      const char *error = write_message_value(vm, writer, items.values[i], depth + 1);
+      if (error != NULL) return error;
+    }
+  } else if (IS_DICT(value)) {
+    b_obj_dict *dict = AS_DICT(value);
+    write_message_tag(writer, MESSAGE_DICT);
+    write_message_length(writer, dict->names.count);
+    for (int i = 0; i < dict->names.count; i++) {
+      b_value key = dict->names.values[i], item;
+      dict_get_entry(dict, key, &item);
+
+      const char *error = write_message_value(vm, writer, key, depth + 1);
+      if (error == NULL) error = write_message_value(vm, writer, item, depth + 1);
+      if (error != NULL) return error;
+    }
+  } else {
+    b_channel *channel;
+    if (!get_channel(vm, value, &channel)) {
+      return value_type(value);
+    }
+    // the message takes its reference once it is complete.
+    write_message_tag(writer, MESSAGE_CHANNEL);
+    write_message_bytes(writer, &channel, sizeof(b_channel *));
+  }
+
+  return NULL;
+}
+
+static void read_message_bytes(b_message_reader *reader, void *bytes, size_t length) {
+  memcpy(bytes, reader->data + reader->position, length);
+  reader->position += length;
+}
+
+static int read_message_length(b_message_reader *reader) {
+  int length;
+  read_message_bytes(reader, &length, sizeof(int));
+  return length;
+}
+
+// walks a message without building anything, taking or dropping a
+// reference on every channel in it.
+static void visit_message_channels(b_message_reader *reader, bool retain) {
+  uint8_t tag = reader->data[reader->position++];
+  switch ((b_message_type) tag) {
+    case MESSAGE_INTEGER: reader->position += sizeof(int64_t); break;
+    case MESSAGE_NUMBER: reader->position += sizeof(double); break;
+    case MESSAGE_STRING:
+    case MESSAGE_BYTES: {
+      int length = read_message_length(reader);
+      reader->position += length;
+      break;
+    }
+    case MESSAGE_LIST: {
+      int count = read_message_length(reader);
+      for (int i = 0; i < count; i++) {
+        visit_message_channels(reader, retain);
+      }
+      break;
+    }
+    case MESSAGE_DICT: {
+      int count = read_message_length(reader);
+      for (int i = 0; i < count * 2; i++) {
+        visit_message_channels(reader, retain);
+      }
+      break;
+    }
+    case MESSAGE_CHANNEL: {
+      b_channel *channel;
+      read_message_bytes(reader, &channel, sizeof(b_channel *));
+      if (retain) {
+        retain_channel(channel);
+      } else {
+        release_channel(channel);
+      }
+      break;
+    }
+    default: break;
+  }
+}
+
+static b_message *new_message(b_vm *vm, b_value value, const char **error) {
+  b_message_writer writer = {NULL, 0, 0};
+  *error = write_message_value(vm, &writer, value, 0);
+  if (*error != NULL) {
+    free(writer.data);
+    return NULL;
+  }
+
+  b_message *message = (b_message *) allocate_shared(NULL, sizeof(b_message) + writer.length);
+  message->next = NULL;
+  message->length = writer.length;
+  memcpy(message->data, writer.data, writer.length);
+  free(writer.data);
+
+  b_message_reader reader = {message->data, 0};
+  visit_message_channels(&reader, true);
+  return message;
+}
+
+// for messages that will never be read.
+static void release_message(b_message *message) {
+  b_message_reader reader = {message->data, 0};
+  visit_message_channels(&reader, false);
+  free(message);
+}
+
+static b_value new_channel_instance(b_vm *vm, b_channel *channel);
+
+// builds the value back on the heap of the receiving vm. references to
+// channels held by the message pass on to the instances made for them.
+static b_value read_message_value(b_vm *vm, b_message_reader *reader) {
+  uint8_t tag = reader->data[reader->position++];
+  switch ((b_message_type) tag) {
+    case MESSAGE_TRUE: return TRUE_VAL;
+    case MESSAGE_FALSE: return FALSE_VAL;
+    case MESSAGE_INTEGER: {
+      int64_t integer;
+      read_message_bytes(reader, &integer, sizeof(int64_t));
+      return LONG_VAL(integer);
+    }
+    case MESSAGE_NUMBER: {
+      double number;
+      read_message_bytes(reader, &number, sizeof(double));
+      return NUMBER_VAL(number);
+    }
+    case MESSAGE_STRING: {
+      int length = read_message_length(reader);
+      b_obj_string *string = copy_string(vm, (const char *) reader->data + reader->position, length);
+      reader->position += length;
+      return OBJ_VAL(string);
+    }
+    case MESSAGE_BYTES: {
+      int length = read_message_length(reader);
+      b_obj_bytes *bytes = copy_bytes(vm, (unsigned char *) reader->data + reader->position, length);
+      reader->position += length;
+      return OBJ_VAL(bytes);
+    }
+    case MESSAGE_LIST: {
+      int count = read_message_length(reader);
+      b_obj_list *list = new_list(vm);
+      push(vm, OBJ_VAL(list));
+      for (int i = 0; i < count; i++) {
+        b_value item = read_message_value(vm, reader);
+        push(vm, item);
+        write_list(vm, list, item);
+        pop(vm);
+      }
+      pop(vm);
+      return OBJ_VAL(list);
+    }
+    case MESSAGE_DICT: {
+      int count = read_message_length(reader);
+      b_obj_dict *dict = new_dict(vm);
+      push(vm, OBJ_VAL(dict));
+      for (int i = 0; i < count; i++) {
+        push(vm, read_message_value(vm, reader));
+        push(vm, read_message_value(vm, reader));
+        dict_add_entry(vm, dict, peek(vm, 1), peek(vm, 0));
+        pop_n(vm, 2);
+      }
+      pop(vm);
+      return OBJ_VAL(dict);
+    }
+    case MESSAGE_CHANNEL: {
+      b_channel *channel;
+      read_message_bytes(reader, &channel, sizeof(b_channel *));
+      return new_channel_instance(vm, channel);
+    }
+    default: return NIL_VAL;
+  }
+}
+
+static b_value read_message(b_vm *vm, b_message *message) {
+  b_message_reader reader = {message->data, 0};
+  b_value value = read_message_value(vm, &reader);
+  free(message);
+  return value;
+}
+
+/*
+ * Channel
+ */
+
+static b_obj_class *get_channel_class(b_vm *vm) {
+  b_value module, klass;
+  table_get(&vm->modules, STRING_VAL("_thread"), &module);
+  table_get(&AS_MODULE(module)->values, STRING_VAL("Channel"), &klass);
+  return AS_CLASS(klass);
+}
+
+static b_value new_channel_instance(b_vm *vm, b_channel *channel) {
+  b_obj_instance *instance = new_instance(vm, get_channel_class(vm));
+  push(vm, OBJ_VAL(instance));
+
+  b_obj_ptr *ptr = new_ptr(vm, channel);
+  ptr->name = "<*Thread::Channel>";
+  ptr->free_fn = &release_channel;
+  push(vm, OBJ_VAL(ptr));
+  instance_set_field(vm, instance, STRING_VAL("_ptr"), OBJ_VAL(ptr));
+  pop_n(vm, 2);
+
+  return OBJ_VAL(instance);
+}
+
+// finds the channel behind a Channel instance, creating it the first time
+// the instance is used.
+static bool get_channel(b_vm *vm, b_value value, b_channel **channel) {
+  if (!IS_INSTANCE(value) || !is_instance_of(AS_INSTANCE(value)->klass, get_channel_class(vm))) {
+    return false;
+  }
+
+  b_obj_instance *instance = AS_INSTANCE(value);
+  b_value field = STRING_VAL("_ptr");
+  push(vm, field);
+
+  b_value ptr;
+  if (instance_get_field(instance, field, &ptr) && IS_PTR(ptr)
+      && AS_PTR(ptr)->free_fn == &release_channel) {
+    *channel = (b_channel *) AS_PTR(ptr)->pointer;
+    pop(vm);
+    return true;
+  }
+
+  *channel = new_channel();
+  b_obj_ptr *channel_ptr = new_ptr(vm, *channel);
+  channel_ptr->name = "<*Thread::Channel>";
+  channel_ptr->free_fn = &release_channel;
+  push(vm, OBJ_VAL(channel_ptr));
+  instance_set_field(vm, instance, field, OBJ_VAL(channel_ptr));
+  pop_n(vm, 2);
+  return true;
+}
+
+DECLARE_MODULE_METHOD(thread_channel_send) {
+  ENFORCE_ARG_COUNT(send, 1);
+
+  b_channel *channel;
+  if (!get_channel(vm, METHOD_OBJECT, &channel)) {
+    RETURN_ERROR("send() must be called on a Channel");
+  }
+
+  const char *error;
+  b_message *message = new_message(vm, args[0], &error);
+  if (message == NULL) {
+    RETURN_ERROR("cannot send %s to another thread", error);
+  }
+
+  mtx_lock(&channel->lock);
+  if (channel->closed) {
+    mtx_unlock(&channel->lock);
+    release_message(message);
+    RETURN_ERROR("send on closed channel");
+  }
+
+  if (channel->tail == NULL) {
+    channel->head = message;
+  } else {
+    channel->tail->next = message;
+  }
+  channel->tail = message;
+  cnd_signal(&channel->ready);
+  mtx_unlock(&channel->lock);
+  RETURN;
+}
+
+DECLARE_MODULE_METHOD(thread_channel_receive) {
+  ENFORCE_ARG_COUNT(receive, 0);
+
+  b_channel *channel;
+  if (!get_channel(vm, METHOD_OBJECT, &channel)) {
+    RETURN_ERROR("receive() must be called on a Channel");
+  }
+
+  mtx_lock(&channel->lock);
+  while (channel->head == NULL && !channel->closed) {
+    cnd_wait(&channel->ready, &channel->lock);
+  }
+
+  b_message *message = channel->head;
+  if (message != NULL) {
+    channel->head = message->next;
+    if (channel->head == NULL) {
+      channel->tail = NULL;
+    }
+  }
+  mtx_unlock(&channel->lock);
+
+  if (message == NULL) {
+    RETURN_NIL;
+  }
+  RETURN_VALUE(read_message(vm, message));
+}
+
+DECLARE_MODULE_METHOD(thread_channel_close) {
+  ENFORCE_ARG_COUNT(close, 0);
+
+  b_channel *channel;
+  if (!get_channel(vm, METHOD_OBJECT, &channel)) {
+    RETURN_ERROR("close() must be called on a Channel");
+  }
+
+  mtx_lock(&channel->lock);
+  channel->closed = true;
+  cnd_broadcast(&channel->ready);
+  mtx_unlock(&channel->lock);
+  RETURN;
+}
+
+/*
+ * Isolates
+ */
+
+static void free_isolate(b_isolate *isolate) {
+  free(isolate->file);
+  free(isolate->function);
+  free(isolate->root_file);
+  if (isolate->args != NULL) {
+    release_message(isolate->args);
+  }
+  for (int i = 0; i < isolate->std_args_count; i++) {
+    free(isolate->std_args[i]);
+  }
+  free(isolate->std_args);
+  free(isolate);
+}
+
+static int run_isolate(void *data) {
+  b_isolate *isolate = (b_isolate *) data;
+
+  char *source = read_file(isolate->file);
+  if (source == NULL) {
+    fprintf(stderr, "(Blade):\n  Thread aborted for %s\n  Reason: could not read file\n", isolate->file);
+    free_isolate(isolate);
+    return PTR_RUNTIME_ERR;
+  }
+
+  b_vm *vm = (b_vm *) allocate_shared(NULL, sizeof(b_vm));
+  memset(vm, 0, sizeof(b_vm));
+  init_vm(vm);
+
+  vm->show_warnings = isolate->show_warnings;
+  vm->should_optimize = isolate->should_optimize;
+  vm->should_use_registers = isolate->should_use_registers;
+  vm->should_jit = isolate->should_jit;
+  vm->next_gc = isolate->next_gc;
+  vm->gc_step_budget = isolate->gc_step_budget;
+  vm->gc_threads = isolate->gc_threads;
+  vm->root_file = isolate->root_file;
+  vm->std_args = isolate->std_args;
+  vm->std_args_count = isolate->std_args_count;
+
+  bind_native_modules(vm);
+
+  // the thread module of an isolate says so and holds the arguments the
+  // isolate was started with.
+  b_value thread_module;
+  table_get(&vm->modules, STRING_VAL("_thread"), &thread_module);
+  b_table *values = &AS_MODULE(thread_module)->values;
+  table_set(vm, values, STRING_VAL("is_main"), FALSE_VAL);
+  write_barrier_all(vm, &AS_MODULE(thread_module)->obj);
+
+  b_message_reader reader = {isolate->args->data, 0};
+  b_value args = read_message_value(vm, &reader);
+  free(isolate->args);
+  isolate->args = NULL;
+  push(vm, args);
+  table_set(vm, values, STRING_VAL("args"), args);
+  write_barrier_all(vm, &AS_MODULE(thread_module)->obj);
+  pop(vm);
+
+  b_obj_module *module = new_module(vm, strdup(""), strdup(isolate->file));
+  add_module(vm, module);
+
+  b_ptr_result result = interpret(vm, module, source);
+  free(source);
+
+  if (result == PTR_OK && isolate->function != NULL) {
+    b_value function;
+    if (!table_get(&module->values, STRING_VAL(isolate->function), &function)) {
+      fprintf(stderr, "(Blade):\n  Thread aborted for %s\n  Reason: function %s not found\n",
+              isolate->file, isolate->function);
+      result = PTR_RUNTIME_ERR;
+    } else {
+      b_obj_list *list = AS_LIST(args);
+      push(vm, function);
+      for (int i = 0; i < list->items.count; i++) {
+        push(vm, list->items.values[i]);
+      }
+      result = interpret_call(vm, list->items.count);
+    }
+  }
+
+  fflush(stdout);
+
+  // owned by the isolate, not the vm.
+  vm->root_file = NULL;
+  vm->std_args = NULL;
+  free_vm(vm);
+  free(vm);
+  free_isolate(isolate);
+  return result;
+}
+
+static void free_thread(void *data) {
+  b_thread *thread = (b_thread *) data;
+  if (!thread->joined) {
+    thrd_detach(thread->thread);
+  }
+  free(thread);
+}
+
+DECLARE_MODULE_METHOD(thread_start) {
+  ENFORCE_ARG_COUNT(start, 2);
+  ENFORCE_ARG_TYPES(start, 0, IS_STRING, IS_CLOSURE);
+  ENFORCE_ARG_TYPE(start, 1, IS_LIST);
+
+  char *file, *function = NULL;
+  if (IS_STRING(args[0])) {
+    file = strdup(AS_C_STRING(args[0]));
+  } else {
+    // the isolate loads the function again from its own file, so it has to
+    // be one that can be found there by name.
+    b_obj_func *fn = AS_CLOSURE(args[0])->function;
+    b_value declared;
+    if (fn->name == NULL || !table_get(&fn->module->values, OBJ_VAL(fn->name), &declared)
+        || !IS_CLOSURE(declared) || AS_CLOSURE(declared)->function != fn) {
+      RETURN_ERROR("start() expects a function declared at the top level of a module");
+    }
+    file = strdup(fn->module->file);
+    function = strdup(fn->name->chars);
+  }
+
+  const char *error;
+  b_message *message = new_message(vm, args[1], &error);
+  if (message == NULL) {
+    free(file);
+    free(function);
+    RETURN_ERROR("cannot send %s to another thread", error);
+  }
+
+  b_isolate *isolate = (b_isolate *) allocate_shared(NULL, sizeof(b_isolate));
+  isolate->file = file;
+  isolate->function = function;
+  isolate->root_file = strdup(vm->root_file != NULL ? vm->root_file : file);
+  isolate->args = message;
+  isolate->next_gc = vm->next_gc;
+  isolate->gc_step_budget = vm->gc_step_budget;
+  isolate->gc_threads = vm->gc_threads;
+  isolate->show_warnings = vm->show_warnings;
+  isolate->should_optimize = vm->should_optimize;
+  isolate->should_use_registers = vm->should_use_registers;
+  isolate->should_jit = vm->should_jit;
+
+  isolate->std_args_count = vm->std_args_count;
+  isolate->std_args = (char **) allocate_shared(NULL, sizeof(char *) * (vm->std_args_count + 1));
+  for (int i = 0; i < vm->std_args_count; i++) {
+    isolate->std_args[i] = strdup(vm->std_args[i]);
+  }
+
+  b_thread *thread = (b_thread *) allocate_shared(NULL, sizeof(b_thread));
+  thread->joined = false;
+  if (thrd_create(&thread->thread, run_isolate, isolate) != thrd_success) {
+    free_isolate(isolate);
+    free(thread);
+    RETURN_ERROR("could not start thread");
+  }
+
+  b_obj_ptr *ptr = (b_obj_ptr *) GC(new_ptr(vm, thread));
+  ptr->name = "<*Thread::Thread>";
+  ptr->free_fn = &free_thread;
+  RETURN_OBJ(ptr);
+}
+
+DECLARE_MODULE_METHOD(thread_join) {
+  ENFORCE_ARG_COUNT(join, 1);
+  ENFORCE_ARG_TYPE(join, 0, IS_PTR);
+  b_thread *thread = (b_thread *) AS_PTR(args[0])->pointer;
+
+  if (thread->joined) {
+    RETURN_ERROR("thread already joined");
+  }
+
+  int result;
+  thrd_join(thread->thread, &result);
+  thread->joined = true;
+  RETURN_BOOL(result == PTR_OK);
+}
+
+b_value __thread_is_main(b_vm *vm) {
+  return TRUE_VAL;
+}
+
+b_value __thread_args(b_vm *vm) {
+  return OBJ_VAL(new_list(vm));
+}
+
+CREATE_MODULE_LOADER(thread) {
+  static b_func_reg module_functions[] = {
+      {"start", false, GET_MODULE_METHOD(thread_start)},
+      {"join",  false, GET_MODULE_METHOD(thread_join)},
+      {NULL,    false, NULL},
+  };
+
+  static b_field_reg module_fields[] = {
+      {"is_main", false, __thread_is_main},
+      {"args",    false, __thread_args},
+      {NULL,      false, NULL},
+  };
+
+  static b_func_reg channel_functions[] = {
+      {"send",    false, GET_MODULE_METHOD(thread_channel_send)},
+      {"receive", false, GET_MODULE_METHOD(thread_channel_receive)},
+      {"close",   false, GET_MODULE_METHOD(thread_channel_close)},
+      {NULL,      false, NULL},
+  };
+
+  static b_class_reg classes[] = {
+      {"Channel", NULL, channel_functions},
+      {NULL,      NULL, NULL},
+  };
+
+  static b_module_reg module = {
+      .name = "_thread",
+      .fields = module_fields,
+      .functions = module_functions,
+      .classes = classes,
+      .preloader = NULL,
+      .unloader = NULL
+  };
+
+  return &module;
+}
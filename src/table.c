@@ -101,6 +101,17 @@ bool table_get(b_table *table, b_value key, b_value *value) {
   return true;
 }
 
+b_entry *table_get_entry(b_table *table, b_value key) {
+  if (table->count == 0 || table->entries == NULL)
+    return NULL;
+
+  b_entry *entry = find_entry(table->entries, table->capacity, key);
+  if (IS_EMPTY(entry->key) || IS_NIL(entry->key))
+    return NULL;
+
+  return entry;
+}
+
 static void adjust_capacity(b_vm *vm, b_table *table, int capacity) {
   b_entry *entries = ALLOCATE(b_entry, capacity);
   for (int i = 0; i < capacity; i++) {
@@ -181,11 +192,14 @@ void table_import_all(b_vm *vm, b_table *from, b_table *to) {
   }
 }
 
-void table_copy(b_vm *vm, b_table *from, b_table *to) {
+void table_copy(b_vm *vm, b_obj *owner, b_table *from, b_table *to) {
   for (int i = 0; i < from->capacity; i++) {
     b_entry *entry = &from->entries[i];
     if (!IS_EMPTY(entry->key)) {
-      table_set(vm, to, entry->key, copy_value(vm, entry->value));
+      b_value value = copy_value(vm, entry->value);
+      table_set(vm, to, entry->key, value);
+      write_barrier(vm, owner, entry->key);
+      write_barrier(vm, owner, value);
     }
   }
 }
@@ -200,16 +214,17 @@ b_obj_string *table_find_string(b_table *table, const char *chars, int length, u
     b_entry *entry = &table->entries[index];
 
     if (IS_EMPTY(entry->key)) {
-      /* // stop if we find an empty non-tombstone entry
-      if (IS_NIL(entry->value)) */
-      return NULL;
-    }
-
-    b_obj_string *string = AS_STRING(entry->key);
-    if (string->length == length && string->hash == hash &&
-        memcmp(string->chars, chars, length) == 0) {
-      // we found it
-      return string;
+      // stop if we find an empty non-tombstone entry. the collector leaves
+      // tombstones behind in the string table.
+      if (IS_NIL(entry->value))
+        return NULL;
+    } else {
+      b_obj_string *string = AS_STRING(entry->key);
+      if (string->length == length && string->hash == hash &&
+          memcmp(string->chars, chars, length) == 0) {
+        // we found it
+        return string;
+      }
     }
 
     index = (index + 1) & (table->capacity - 1);
@@ -234,6 +249,7 @@ b_obj_list *table_get_keys(b_vm *vm, b_table *table) {
     b_entry *entry = &table->entries[i];
     if (!IS_NIL(entry->key) && !IS_EMPTY(entry->key)) {
       write_value_arr(vm, &list->items, entry->key);
+      write_barrier(vm, &list->obj, entry->key);
     }
   }
 
@@ -274,7 +290,8 @@ void mark_table(b_vm *vm, b_table *table) {
 void table_remove_whites(b_vm *vm, b_table *table) {
   for (int i = 0; i < table->capacity; i++) {
     b_entry *entry = &table->entries[i];
-    if (IS_OBJ(entry->key) && AS_OBJ(entry->key)->mark != vm->mark_value) {
+    if (IS_OBJ(entry->key) && !is_marked(vm, AS_OBJ(entry->key)) &&
+        !(vm->gc_minor && AS_OBJ(entry->key)->old)) {
       table_delete(table, entry->key);
     }
   }
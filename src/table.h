@@ -25,10 +25,12 @@ bool table_set(b_vm *vm, b_table *table, b_value key, b_value value);
 
 bool table_get(b_table *table, b_value key, b_value *value);
 
+b_entry *table_get_entry(b_table *table, b_value key);
+
 bool table_delete(b_table *table, b_value key);
 
 void table_add_all(b_vm *vm, b_table *from, b_table *to);
-void table_copy(b_vm *vm, b_table *from, b_table *to);
+void table_copy(b_vm *vm, b_obj *owner, b_table *from, b_table *to);
 
 b_obj_string *table_find_string(b_table *table, const char *chars, int length,
                                 uint32_t hash);
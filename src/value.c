@@ -392,6 +392,9 @@ uint32_t hash_value(b_value value) {
 #if defined(USE_NAN_BOXING) && USE_NAN_BOXING
   if (IS_OBJ(value))
     return hash_object(AS_OBJ(value));
+  // an integer has to land where the equal double does.
+  if (IS_INTEGER(value))
+    return hash_double(AS_NUMBER(value));
   return hash_bits(value);
 #else
   switch (value.type) {
@@ -506,6 +509,7 @@ b_value copy_value(b_vm *vm, b_value value) {
 
         for (int i = 0; i < list->items.count; i++) {
           write_value_arr(vm, &n_list->items, list->items.values[i]);
+          write_barrier(vm, &n_list->obj, list->items.values[i]);
         }
 
         pop(vm);
@@ -33,6 +33,13 @@ typedef union {
 #define FALSE_TAG 2 // 10
 #define TRUE_TAG 3  // 11
 
+// integers that fit in 48 bits live in the payload of a quiet nan marked
+// with this bit, so they never have to go through a double.
+#define INTEGER_TAG ((uint64_t)0x0001000000000000)
+#define INTEGER_MASK ((uint64_t)0xffff000000000000)
+#define INTEGER_MAX ((int64_t)0x00007fffffffffff)
+#define INTEGER_MIN (-INTEGER_MAX - 1)
+
 typedef uint64_t b_value;
 
 #define FALSE_VAL ((b_value)(uint64_t)(QNAN | FALSE_TAG))
@@ -48,12 +55,16 @@ typedef uint64_t b_value;
 
 #define AS_BOOL(v) ((v) == TRUE_VAL)
 #define AS_NUMBER(v) value_to_number(v)
+#define AS_INTEGER(v) ((int64_t)((v) << 16) >> 16)
+#define AS_LONG(v) value_to_long(v)
 #define AS_OBJ(v) ((b_obj *)(uintptr_t)((v) & ~(SIGN_BIT | QNAN)))
 
 #define IS_EMPTY(v) ((v) == EMPTY_VAL)
 #define IS_NIL(v) ((v) == NIL_VAL)
 #define IS_BOOL(v) (((v) | 1) == TRUE_VAL)
-#define IS_NUMBER(v) (((v)&QNAN) != QNAN)
+#define IS_DOUBLE(v) (((v)&QNAN) != QNAN)
+#define IS_INTEGER(v) (((v) & INTEGER_MASK) == (QNAN | INTEGER_TAG))
+#define IS_NUMBER(v) (IS_DOUBLE(v) || IS_INTEGER(v))
 #define IS_OBJ(v) (((v) & (QNAN | SIGN_BIT)) == (QNAN | SIGN_BIT))
 
 static inline b_value number_to_value(double v) {
@@ -63,23 +74,30 @@ static inline b_value number_to_value(double v) {
 }
 
 static inline b_value integer_to_value(int v) {
-  b_double_union data;
-  data.num = (double) v;
-  return data.bits;
+  return QNAN | INTEGER_TAG | ((uint64_t) (int64_t) v & ~INTEGER_MASK);
 }
 
-static inline b_value long_to_value(long v) {
-  b_double_union data;
-  data.num = (double) v;
-  return data.bits;
+// anything too large for the payload becomes a double.
+static inline b_value long_to_value(int64_t v) {
+  if (v < INTEGER_MIN || v > INTEGER_MAX) {
+    return number_to_value((double) v);
+  }
+  return QNAN | INTEGER_TAG | ((uint64_t) v & ~INTEGER_MASK);
 }
 
 static inline double value_to_number(b_value v) {
+  if (IS_INTEGER(v)) {
+    return (double) AS_INTEGER(v);
+  }
   double number;
   memcpy(&number, &v, sizeof(b_value));
   return number;
 }
 
+static inline int64_t value_to_long(b_value v) {
+  return IS_INTEGER(v) ? AS_INTEGER(v) : (int64_t) value_to_number(v);
+}
+
 #else
 
 typedef enum {
@@ -113,12 +131,20 @@ typedef struct {
 // demote blade values to C value
 #define AS_BOOL(v) ((v).as.boolean)
 #define AS_NUMBER(v) ((v).as.number)
+#define AS_INTEGER(v) ((int64_t)(v).as.number)
+#define AS_LONG(v) ((int64_t)(v).as.number)
 #define AS_OBJ(v) ((v).as.obj)
 
+// the whole numbers a double holds exactly
+#define INTEGER_MAX ((int64_t)0x001fffffffffffff)
+#define INTEGER_MIN (-INTEGER_MAX - 1)
+
 // testing blade value types
 #define IS_NIL(v) ((v).type == VAL_NIL)
 #define IS_BOOL(v) ((v).type == VAL_BOOL)
 #define IS_NUMBER(v) ((v).type == VAL_NUMBER)
+#define IS_DOUBLE(v) ((v).type == VAL_NUMBER)
+#define IS_INTEGER(v) (false) // numbers are always doubles here
 #define IS_OBJ(v) ((v).type == VAL_OBJ)
 #define IS_EMPTY(v) ((v).type == VAL_EMPTY)
 
@@ -168,6 +194,45 @@ void sort_values(b_value *values, int count);
 
 b_value copy_value(b_vm *vm, b_value value);
 
+// + - and * on two integers stay integers until the result no longer fits.
+static inline b_value add_numbers(b_value a, b_value b) {
+  if (IS_INTEGER(a) && IS_INTEGER(b)) {
+    return LONG_VAL(AS_INTEGER(a) + AS_INTEGER(b));
+  }
+  return NUMBER_VAL(AS_NUMBER(a) + AS_NUMBER(b));
+}
+
+static inline b_value subtract_numbers(b_value a, b_value b) {
+  if (IS_INTEGER(a) && IS_INTEGER(b)) {
+    return LONG_VAL(AS_INTEGER(a) - AS_INTEGER(b));
+  }
+  return NUMBER_VAL(AS_NUMBER(a) - AS_NUMBER(b));
+}
+
+static inline b_value multiply_numbers(b_value a, b_value b) {
+  if (IS_INTEGER(a) && IS_INTEGER(b)) {
+    int64_t x = AS_INTEGER(a), y = AS_INTEGER(b);
+    // factors under 2^31 cannot overflow 64 bits, and a zero with a
+    // negative factor is -0 as a double.
+    if (x >= -INT32_MAX && x <= INT32_MAX && y >= -INT32_MAX && y <= INT32_MAX
+        && (x * y != 0 || (x >= 0 && y >= 0))) {
+      return LONG_VAL(x * y);
+    }
+  }
+  return NUMBER_VAL(AS_NUMBER(a) * AS_NUMBER(b));
+}
+
+static inline b_value divide_numbers(b_value a, b_value b) {
+  return NUMBER_VAL(AS_NUMBER(a) / AS_NUMBER(b));
+}
+
+static inline b_value negate_number(b_value a) {
+  if (IS_INTEGER(a) && AS_INTEGER(a) != 0) {
+    return LONG_VAL(-AS_INTEGER(a));
+  }
+  return NUMBER_VAL(-AS_NUMBER(a));
+}
+
 #define STRING_VAL(val) OBJ_VAL(copy_string(vm, val, (int)strlen(val)))
 #define STRING_L_VAL(val, l) OBJ_VAL(copy_string(vm, val, l))
 #define STRING_T_VAL(val, l) OBJ_VAL(take_string(vm, val, l))
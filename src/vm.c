@@ -2,6 +2,7 @@
 #include "common.h"
 #include "compiler.h"
 #include "config.h"
+#include "jit.h"
 #include "memory.h"
 #include "module.h"
 #include "native.h"
@@ -14,7 +15,9 @@
 #include "list.h"
 #include "bstring.h"
 #include "range.h"
+#include "fiber.h"
 
+#include <limits.h>
 #include <math.h>
 #include <stdarg.h>
 #include <stdio.h>
@@ -31,20 +34,156 @@ static inline void reset_stack(b_vm *vm) {
   vm->open_up_values = NULL;
 }
 
-static b_value get_stack_trace(b_vm *vm) {
-  char *trace = calloc(0, sizeof(char));
+static void out_of_memory(void) {
+  fflush(stdout); // flush out anything on stdout first
+  fprintf(stderr, "VM ran out of memory");
+  exit(EXIT_TERMINAL);
+}
 
-  if (trace != NULL) {
+void grow_stack(b_vm *vm, int needed) {
+  int capacity = vm->stack_capacity;
+  ptrdiff_t used = vm->stack_top - vm->stack;
+  while (capacity < used + needed) {
+    capacity = GROW_CAPACITY(capacity);
+  }
 
-    for (int i = vm->frame_count - 1; i >= 0; i--) {
-      b_call_frame *frame = &vm->frames[i];
-      b_obj_func *function = frame->closure->function;
+  b_value *old = vm->stack;
+  b_value *stack = (b_value *) realloc(old, sizeof(b_value) * capacity);
+  if (stack == NULL) {
+    out_of_memory();
+  }
+  vm->stack = stack;
+  vm->stack_capacity = capacity;
 
-      // -1 because the IP is sitting on the next instruction to be executed
-      size_t instruction = frame->ip - function->blob.code - 1;
+  // everything that points into the stack has to follow it.
+  vm->stack_top = stack + used;
+  for (int i = 0; i < vm->frame_count; i++) {
+    vm->frames[i].slots = stack + (vm->frames[i].slots - old);
+  }
+  for (b_obj_up_value *up_value = vm->open_up_values; up_value != NULL;
+       up_value = up_value->next) {
+    up_value->location = stack + (up_value->location - old);
+  }
+}
+
+b_call_frame *push_frame(b_vm *vm) {
+  if (vm->frame_count == FRAMES_MAX) {
+    return NULL;
+  }
+
+  if (vm->frame_count == vm->frame_capacity) {
+    int capacity = GROW_CAPACITY(vm->frame_capacity);
+    b_call_frame *frames = (b_call_frame *) realloc(vm->frames, sizeof(b_call_frame) * capacity);
+    if (frames == NULL) {
+      out_of_memory();
+    }
+    vm->frames = frames;
+    vm->frame_capacity = capacity;
+  }
+
+  b_call_frame *frame = &vm->frames[vm->frame_count++];
+  frame->va_count = 0;
+  vm->current_frame = frame;
+  return frame;
+}
+
+#define SWAP(type, a, b) do { type tmp = (a); (a) = (b); (b) = tmp; } while (false)
+
+static void swap_fiber_stacks(b_vm *vm, b_obj_fiber *fiber) {
+  SWAP(b_value *, vm->stack, fiber->stack);
+  SWAP(b_value *, vm->stack_top, fiber->stack_top);
+  SWAP(int, vm->stack_capacity, fiber->stack_capacity);
+  SWAP(b_call_frame *, vm->frames, fiber->frames);
+  SWAP(int, vm->frame_count, fiber->frame_count);
+  SWAP(int, vm->frame_capacity, fiber->frame_capacity);
+  SWAP(b_obj_up_value *, vm->open_up_values, fiber->open_up_values);
+  vm->current_frame = vm->frame_count > 0 ? &vm->frames[vm->frame_count - 1] : NULL;
+  write_barrier_all(vm, &fiber->obj);
+}
+
+#undef SWAP
+
+// switches back to whoever resumed the running fiber. the value is what
+// their call to resume() returns.
+static void leave_fiber(b_vm *vm, b_fiber_state state, b_value value) {
+  b_obj_fiber *fiber = vm->fiber;
+  fiber->state = state;
+  vm->fiber = fiber->parent;
+  fiber->parent = NULL;
+  swap_fiber_stacks(vm, fiber);
+
+  if (state == FIBER_DONE) {
+    // nothing can run on a finished fiber again.
+    free(fiber->stack);
+    free(fiber->frames);
+    fiber->stack = fiber->stack_top = NULL;
+    fiber->frames = NULL;
+    fiber->stack_capacity = fiber->frame_count = fiber->frame_capacity = 0;
+    fiber->open_up_values = NULL;
+  }
+  push(vm, value);
+}
+
+void yield_fiber(b_vm *vm, b_value value, int arg_count) {
+  vm->stack_top -= arg_count + 1;
+  leave_fiber(vm, FIBER_SUSPENDED, value);
+}
+
+void grow_gc_roots(b_vm *vm) {
+  vm->gc_roots_capacity = GROW_CAPACITY(vm->gc_roots_capacity);
+  vm->gc_roots = (b_obj **) realloc(vm->gc_roots, sizeof(b_obj *) * vm->gc_roots_capacity);
+  if (vm->gc_roots == NULL) {
+    out_of_memory();
+  }
+}
+
+// the frames of a trace wait in a field of their own until 'stacktrace' is
+// first read.
+#define STACK_TRACE_FIELD "stacktrace"
+#define STACK_TRACE_FIELD_LENGTH ((int) sizeof(STACK_TRACE_FIELD) - 1)
+#define TRACE_FIELD " trace "
+#define TRACE_FIELD_LENGTH ((int) sizeof(TRACE_FIELD) - 1)
+
+bool is_hidden_field(b_value name) {
+  return IS_STRING(name) && AS_STRING(name)->length == TRACE_FIELD_LENGTH
+      && memcmp(AS_C_STRING(name), TRACE_FIELD, TRACE_FIELD_LENGTH) == 0;
+}
+
+// records the function and instruction of every frame, innermost first.
+// turning that into text is left until someone asks for the trace.
+static b_value capture_stack_trace(b_vm *vm) {
+  b_obj_list *list = new_list(vm);
+  push(vm, OBJ_VAL(list));
+
+  b_value_arr *items = &list->items;
+  items->values = ALLOCATE(b_value, vm->frame_count * 2);
+  items->capacity = vm->frame_count * 2;
+
+  for (int i = vm->frame_count - 1; i >= 0; i--) {
+    b_call_frame *frame = &vm->frames[i];
+    b_obj_func *function = frame->closure->function;
+
+    // -1 because the IP is sitting on the next instruction to be executed
+    items->values[items->count++] = OBJ_VAL(function);
+    items->values[items->count++] = NUMBER_VAL(frame->ip - function->blob.code - 1);
+  }
+  write_barrier_all(vm, &list->obj);
+
+  pop(vm);
+  return OBJ_VAL(list);
+}
+
+static b_value format_stack_trace(b_vm *vm, b_obj_list *list) {
+  char *trace = calloc(1, sizeof(char));
+
+  if (trace != NULL) {
+
+    for (int i = 0; i < list->items.count; i += 2) {
+      b_obj_func *function = AS_FUNCTION(list->items.values[i]);
+      size_t instruction = (size_t) AS_NUMBER(list->items.values[i + 1]);
       int line = function->blob.lines[instruction];
 
-      const char *trace_format = i != 0
+      const char *trace_format = i + 2 < list->items.count
           ? "    %s:%d -> %s()\n"
           : "    %s:%d -> %s()";
       char *fn_name = function->name == NULL ? "@.script": function->name->chars;
@@ -66,21 +205,117 @@ static b_value get_stack_trace(b_vm *vm) {
   return STRING_L_VAL("", 0);
 }
 
+bool get_stack_trace_field(b_vm *vm, b_obj_instance *instance, b_obj_string *name, b_value *value) {
+  b_value raw;
+  if (name->length != STACK_TRACE_FIELD_LENGTH
+      || memcmp(name->chars, STACK_TRACE_FIELD, STACK_TRACE_FIELD_LENGTH) != 0
+      || !instance_get_field(instance, STRING_L_VAL(TRACE_FIELD, TRACE_FIELD_LENGTH), &raw)) {
+    return false;
+  }
+
+  if (!IS_LIST(raw)) {
+    *value = NIL_VAL;
+    return true;
+  }
+
+  // from now on the trace is an ordinary field.
+  push(vm, OBJ_VAL(instance));
+  push(vm, OBJ_VAL(name));
+  *value = format_stack_trace(vm, AS_LIST(raw));
+  push(vm, *value);
+  instance_set_field(vm, instance, OBJ_VAL(name), *value);
+  instance_set_field(vm, instance, STRING_L_VAL(TRACE_FIELD, TRACE_FIELD_LENGTH), NIL_VAL);
+  pop_n(vm, 3);
+  return true;
+}
+
+// records where the exception was thrown from.
+static void set_stack_trace(b_vm *vm, b_obj_instance *instance) {
+  b_value trace, dummy;
+  if (instance_get_field(instance, STRING_L_VAL(STACK_TRACE_FIELD, STACK_TRACE_FIELD_LENGTH), &dummy)) {
+    // the trace of an earlier throw was already read and is a field now.
+    push(vm, capture_stack_trace(vm)); // gc fix
+    trace = format_stack_trace(vm, AS_LIST(peek(vm, 0)));
+    pop(vm);
+    push(vm, trace);
+    instance_set_field(vm, instance, STRING_L_VAL(STACK_TRACE_FIELD, STACK_TRACE_FIELD_LENGTH), trace);
+  } else {
+    trace = capture_stack_trace(vm);
+    push(vm, trace);
+    instance_set_field(vm, instance, STRING_L_VAL(TRACE_FIELD, TRACE_FIELD_LENGTH), trace);
+  }
+  pop(vm);
+}
+
+static inline void close_up_values(b_vm *vm, const b_value *last) {
+  while (vm->open_up_values != NULL && vm->open_up_values->location >= last) {
+    b_obj_up_value *up_value = vm->open_up_values;
+    up_value->closed = *up_value->location;
+    up_value->location = &up_value->closed;
+    write_barrier(vm, &up_value->obj, up_value->closed);
+    vm->open_up_values = up_value->next;
+  }
+}
+
+// drops everything the try body and the calls it made left on the stack,
+// leaving the exception just above the locals of the current frame.
+static inline void unwind(b_vm *vm, b_handler *handler, b_obj_instance *exception) {
+  b_value *top = vm->current_frame->slots + handler->locals;
+  close_up_values(vm, top);
+  vm->stack_top = top;
+  push(vm, OBJ_VAL(exception));
+}
+
 bool propagate_exception(b_vm *vm, bool is_assert) {
   b_obj_instance *exception = AS_INSTANCE(peek(vm, 0));
 
-  while (vm->frame_count > 0) {
+  for (;;) {
+    if (vm->frame_count == 0) {
+      if (vm->fiber == NULL) {
+        break;
+      }
+
+      // a fiber ends with the first exception it does not handle, which
+      // then goes on to whoever resumed it.
+      close_up_values(vm, vm->stack);
+      leave_fiber(vm, FIBER_DONE, OBJ_VAL(exception));
+      continue;
+    }
+
     vm->current_frame = &vm->frames[vm->frame_count - 1];
-    for (int i = vm->current_frame->handlers_count; i > 0; i--) {
-      b_exception_frame handler = vm->current_frame->handlers[i - 1];
-      b_obj_func *function = vm->current_frame->closure->function;
+    b_obj_func *function = vm->current_frame->closure->function;
+    b_blob *blob = &function->blob;
 
-      if (handler.address != 0 && is_instance_of(exception->klass, handler.klass->name->chars)) {
-        vm->current_frame->ip = &function->blob.code[handler.address];
-        return true;
-      } else if (handler.finally_address != 0) {
+    // the ip is already past the instruction that threw or made the call.
+    int offset = (int) (vm->current_frame->ip - blob->code);
+
+    for (int i = 0; i < blob->handler_count; i++) {
+      b_handler *handler = &blob->handlers[i];
+      if (offset <= handler->start || offset > handler->end) {
+        continue;
+      }
+
+      if (handler->address != 0) {
+        b_obj_string *type = AS_STRING(blob->constants.values[handler->type]);
+        b_value klass;
+        if (!table_get(&vm->globals, OBJ_VAL(type), &klass) || !IS_CLASS(klass)) {
+          if (!table_get(&function->module->values, OBJ_VAL(type), &klass) || !IS_CLASS(klass)) {
+            do_runtime_error(vm, "object of type '%s' is not an exception", type->chars);
+            return false;
+          }
+        }
+
+        if (is_instance_of(exception->klass, AS_CLASS(klass))) {
+          unwind(vm, handler, exception);
+          vm->current_frame->ip = &blob->code[handler->address];
+          return true;
+        }
+      }
+
+      if (handler->finally_address != 0) {
+        unwind(vm, handler, exception);
         push(vm, TRUE_VAL); // continue propagating once the 'finally' block completes
-        vm->current_frame->ip = &function->blob.code[handler.finally_address];
+        vm->current_frame->ip = &blob->code[handler->finally_address];
         return true;
       }
     }
@@ -96,7 +331,7 @@ bool propagate_exception(b_vm *vm, bool is_assert) {
   } else {
     fprintf(stderr, "Illegal State");
   }
-  if (table_get(&exception->properties, STRING_L_VAL("message", 7), &message)) {
+  if (instance_get_field(exception, STRING_L_VAL("message", 7), &message)) {
     char *error_message = value_to_string(vm, message)->chars;
     if(strlen(error_message) > 0) {
       fprintf(stderr, ": %s", error_message);
@@ -108,7 +343,8 @@ bool propagate_exception(b_vm *vm, bool is_assert) {
     fprintf(stderr, "\n");
   }
 
-  if (table_get(&exception->properties, STRING_L_VAL("stacktrace", 10), &trace)) {
+  if (instance_get_field(exception, STRING_L_VAL(STACK_TRACE_FIELD, STACK_TRACE_FIELD_LENGTH), &trace)
+      || get_stack_trace_field(vm, exception, AS_STRING(STRING_L_VAL(STACK_TRACE_FIELD, STACK_TRACE_FIELD_LENGTH)), &trace)) {
     char *trace_str = value_to_string(vm, trace)->chars;
     fprintf(stderr, "  StackTrace:\n%s\n", trace_str);
   }
@@ -116,19 +352,6 @@ bool propagate_exception(b_vm *vm, bool is_assert) {
   return false;
 }
 
-bool push_exception_handler(b_vm *vm, b_obj_class *type, int address, int finally_address) {
-  b_call_frame *frame = &vm->frames[vm->frame_count - 1];
-  if (frame->handlers_count == MAX_EXCEPTION_HANDLERS) {
-    do_runtime_error(vm, "too many nested exception handlers in one function");
-    return false;
-  }
-  frame->handlers[frame->handlers_count].address = address;
-  frame->handlers[frame->handlers_count].finally_address = finally_address;
-  frame->handlers[frame->handlers_count].klass = type;
-  frame->handlers_count++;
-  return true;
-}
-
 bool do_throw_exception(b_vm *vm, bool is_assert, const char *format, ...) {
 
   va_list args;
@@ -139,11 +362,7 @@ bool do_throw_exception(b_vm *vm, bool is_assert, const char *format, ...) {
 
   b_obj_instance *instance = create_exception(vm, take_string(vm, message, length));
   push(vm, OBJ_VAL(instance));
-
-  b_value stacktrace = get_stack_trace(vm);
-  push(vm, stacktrace);
-  table_set(vm, &instance->properties, STRING_L_VAL("stacktrace", 10), stacktrace);
-  pop(vm);
+  set_stack_trace(vm, instance);
 
   return propagate_exception(vm, is_assert);
 }
@@ -173,6 +392,7 @@ static void initialize_exceptions(b_vm *vm, b_obj_module *module) {
   write_blob(vm, &function->blob, 1 & 0xff, 0);
 
   int message_const = add_constant(vm, &function->blob, STRING_L_VAL("message", 7));
+  write_barrier_all(vm, &function->obj);
 
   // s_prop 1
   write_blob(vm, &function->blob, OP_SET_PROPERTY, 0);
@@ -198,24 +418,28 @@ static void initialize_exceptions(b_vm *vm, b_obj_module *module) {
   push(vm, OBJ_VAL(closure));
   table_set(vm, &klass->methods, OBJ_VAL(class_name), OBJ_VAL(closure));
   klass->initializer = OBJ_VAL(closure);
+  write_barrier_all(vm, &klass->obj);
 
   // set class properties
   table_set(vm, &klass->properties, STRING_L_VAL("message", 7), NIL_VAL);
-  table_set(vm, &klass->properties, STRING_L_VAL("stacktrace", 10), NIL_VAL);
+  // 'stacktrace' only becomes a field once it is read.
+  write_barrier_all(vm, &klass->obj);
+  table_set(vm, &klass->properties, STRING_L_VAL(TRACE_FIELD, TRACE_FIELD_LENGTH), NIL_VAL);
+  write_barrier_all(vm, &klass->obj);
 
   table_set(vm, &vm->globals, OBJ_VAL(class_name), OBJ_VAL(klass));
 
   pop(vm);
-  pop(vm); // assert error name
 
   vm->exception_class = klass;
 }
 
 inline b_obj_instance *create_exception(b_vm *vm, b_obj_string *message) {
+  push(vm, OBJ_VAL(message));
   b_obj_instance *instance = new_instance(vm, vm->exception_class);
   push(vm, OBJ_VAL(instance));
-  table_set(vm, &instance->properties, STRING_L_VAL("message", 7), OBJ_VAL(message));
-  pop(vm);
+  instance_set_field(vm, instance, STRING_L_VAL("message", 7), OBJ_VAL(message));
+  pop_n(vm, 2);
   return instance;
 }
 
@@ -261,6 +485,9 @@ void do_runtime_error(b_vm *vm, const char *format, ...) {
 }
 
 inline void push(b_vm *vm, b_value value) {
+  if (vm->stack_top == vm->stack + vm->stack_capacity) {
+    grow_stack(vm, 1);
+  }
   *vm->stack_top = value;
   vm->stack_top++;
 }
@@ -298,6 +525,7 @@ static void init_builtin_functions(b_vm *vm) {
   DEFINE_NATIVE(bytes);
   DEFINE_NATIVE(chr);
   DEFINE_NATIVE(delprop);
+  DEFINE_NATIVE(fiber);
   DEFINE_NATIVE(file);
   DEFINE_NATIVE(getprop);
   DEFINE_NATIVE(hasprop);
@@ -317,6 +545,7 @@ static void init_builtin_functions(b_vm *vm) {
   DEFINE_NATIVE(is_string);
   DEFINE_NATIVE(is_bytes);
   DEFINE_NATIVE(is_file);
+  DEFINE_NATIVE(is_fiber);
   DEFINE_NATIVE(is_iterable);
   DEFINE_NATIVE(instance_of);
   DEFINE_NATIVE(max);
@@ -336,6 +565,7 @@ static void init_builtin_functions(b_vm *vm) {
   DEFINE_NATIVE(to_number);
   DEFINE_NATIVE(to_string);
   DEFINE_NATIVE(typeof);
+  DEFINE_NATIVE(yield);
 }
 
 static void init_builtin_methods(b_vm *vm) {
@@ -345,6 +575,7 @@ static void init_builtin_methods(b_vm *vm) {
 #define DEFINE_FILE_METHOD(name) DEFINE_METHOD(file, name)
 #define DEFINE_BYTES_METHOD(name) DEFINE_METHOD(bytes, name)
 #define DEFINE_RANGE_METHOD(name) DEFINE_METHOD(range, name)
+#define DEFINE_FIBER_METHOD(name) DEFINE_METHOD(fiber, name)
 
   // string methods
   DEFINE_STRING_METHOD(length);
@@ -483,29 +714,64 @@ static void init_builtin_methods(b_vm *vm) {
   define_native_method(vm, &vm->methods_range, "@iter", native_method_range__iter__);
   define_native_method(vm, &vm->methods_range, "@itern", native_method_range__itern__);
 
+  // fiber
+  DEFINE_FIBER_METHOD(resume);
+  DEFINE_FIBER_METHOD(is_done);
+
 #undef DEFINE_STRING_METHOD
 #undef DEFINE_LIST_METHOD
 #undef DEFINE_DICT_METHOD
 #undef DEFINE_FILE_METHOD
 #undef DEFINE_BYTES_METHOD
 #undef DEFINE_RANGE_METHOD
+#undef DEFINE_FIBER_METHOD
 }
 
 void init_vm(b_vm *vm) {
 
+  vm->stack = (b_value *) malloc(sizeof(b_value) * STACK_START);
+  vm->stack_capacity = STACK_START;
+  vm->frames = (b_call_frame *) malloc(sizeof(b_call_frame) * FRAMES_START);
+  vm->frame_capacity = FRAMES_START;
+  if (vm->stack == NULL || vm->frames == NULL) {
+    out_of_memory();
+  }
+
   reset_stack(vm);
   vm->compiler = NULL;
   vm->objects = NULL;
+  vm->young_count = 0;
+  vm->young_capacity = 0;
+  vm->young = NULL;
   vm->exception_class = NULL;
   vm->current_frame = NULL;
+  vm->fiber = NULL;
   vm->root_file = NULL;
   vm->bytes_allocated = 0;
   vm->gc_protected = 0;
+  vm->gc_roots_capacity = 0;
+  vm->gc_roots = NULL;
   vm->next_gc = DEFAULT_GC_START; // default is 1mb. Can be modified via the -g flag.
+  vm->next_minor_gc = GC_NURSERY_SIZE;
+  vm->remembered_count = 0;
+  vm->remembered_capacity = 0;
+  vm->remembered = NULL;
+  vm->gc_minor = false;
+  vm->gc_busy = false;
+  vm->gc_phase = GC_IDLE;
+  vm->gc_step_budget = GC_STEP_BUDGET; // can be modified via the -i flag.
+  vm->gc_threads = GC_THREADS; // can be modified via the -t flag.
+  vm->gc_parallel = false;
+  vm->sweep_previous = NULL;
+  vm->sweep_cursor = NULL;
+  init_arena(&vm->arena);
   vm->is_repl = false;
   vm->mark_value = true;
   vm->show_warnings = false;
   vm->should_print_bytecode = false;
+  vm->should_optimize = false;
+  vm->should_use_registers = false;
+  vm->should_jit = false;
   vm->should_exit_after_bytecode = false;
 
   vm->gray_count = 0;
@@ -526,6 +792,7 @@ void init_vm(b_vm *vm) {
   init_table(&vm->methods_file);
   init_table(&vm->methods_bytes);
   init_table(&vm->methods_range);
+  init_table(&vm->methods_fiber);
 
   init_builtin_functions(vm);
   init_builtin_methods(vm);
@@ -544,6 +811,15 @@ void free_vm(b_vm *vm) {
   free_table(vm, &vm->methods_dict);
   free_table(vm, &vm->methods_file);
   free_table(vm, &vm->methods_bytes);
+  free_table(vm, &vm->methods_range);
+  free_table(vm, &vm->methods_fiber);
+
+  free(vm->frames);
+  free(vm->stack);
+  free(vm->gc_roots);
+  vm->frames = NULL;
+  vm->stack = vm->stack_top = NULL;
+  vm->gc_roots = NULL;
 }
 
 static bool call(b_vm *vm, b_obj_closure *closure, int arg_count) {
@@ -552,18 +828,21 @@ static bool call(b_vm *vm, b_obj_closure *closure, int arg_count) {
     push(vm, NIL_VAL);
   }
 
-  // handle variadic arguments...
+  // variadic arguments move below the callee, out of the way of the
+  // locals, and __args__ reads them from there until it has to be a list.
+  int va_count = 0;
   if (closure->function->is_variadic && arg_count >= closure->function->arity - 1) {
-    int va_args_start = arg_count - closure->function->arity;
-    b_obj_list *args_list = new_list(vm);
-    push(vm, OBJ_VAL(args_list));
+    int fixed = closure->function->arity; // the callee and named parameters
+    va_count = arg_count - (fixed - 1);
 
-    for (int i = va_args_start; i >= 0; i--) {
-      write_value_arr(vm, &args_list->items, peek(vm, i + 1));
-    }
-    arg_count -= va_args_start;
-    pop_n(vm, va_args_start + 2); // +1 for the gc protection push above
-    push(vm, OBJ_VAL(args_list));
+    b_value *base = vm->stack_top - arg_count - 1;
+    b_value va_args[UINT8_COUNT];
+    memcpy(va_args, base + fixed, sizeof(b_value) * va_count);
+    memmove(base + va_count, base, sizeof(b_value) * fixed);
+    memcpy(base, va_args, sizeof(b_value) * va_count);
+
+    push(vm, EMPTY_VAL);
+    arg_count = fixed;
   }
 
   if (arg_count != closure->function->arity) {
@@ -577,20 +856,60 @@ static bool call(b_vm *vm, b_obj_closure *closure, int arg_count) {
     }
   }
 
-  if (vm->frame_count == FRAMES_MAX) {
+  b_call_frame *frame = push_frame(vm);
+  if (frame == NULL) {
     pop_n(vm, arg_count);
     return throw_exception(vm, "stack overflow");
   }
-
-  b_call_frame *frame = &vm->frames[vm->frame_count++];
   frame->closure = closure;
   frame->ip = closure->function->blob.code;
 
   frame->slots = vm->stack_top - arg_count - 1;
+  frame->va_count = va_count;
+
+  if (vm->should_jit && jit_is_hot(vm, closure->function)) {
+    jit_run(vm, frame);
+  }
   return true;
 }
 
+void resume_fiber(b_vm *vm, b_obj_fiber *fiber, int arg_count) {
+  b_value *args = vm->stack_top - arg_count;
+  vm->stack_top = args - 1;
+
+  bool is_new = fiber->state == FIBER_NEW;
+  if (is_new) {
+    fiber->stack = (b_value *) malloc(sizeof(b_value) * FIBER_STACK_START);
+    fiber->frames = (b_call_frame *) malloc(sizeof(b_call_frame) * FIBER_FRAMES_START);
+    if (fiber->stack == NULL || fiber->frames == NULL) {
+      out_of_memory();
+    }
+    fiber->stack_top = fiber->stack;
+    fiber->stack_capacity = FIBER_STACK_START;
+    fiber->frame_capacity = FIBER_FRAMES_START;
+  }
+
+  fiber->state = FIBER_RUNNING;
+  fiber->parent = vm->fiber;
+  vm->fiber = fiber;
+  swap_fiber_stacks(vm, fiber);
+
+  // the arguments stay where they are on the other stack while they are
+  // copied over, since nothing runs in between.
+  if (is_new) {
+    push(vm, OBJ_VAL(fiber->closure));
+    for (int i = 0; i < arg_count; i++) {
+      push(vm, args[i]);
+    }
+    call(vm, fiber->closure, arg_count);
+  } else {
+    push(vm, arg_count > 0 ? args[0] : NIL_VAL);
+  }
+}
+
 static inline bool call_native_method(b_vm *vm, b_obj_native *native, int arg_count) {
+  // natives hold on to args, so whatever they push must fit without moving it.
+  ensure_stack(vm, STACK_HEADROOM);
   if (native->function(vm, arg_count, vm->stack_top - arg_count)) {
     CLEAR_GC();
     vm->stack_top -= arg_count;
@@ -680,7 +999,7 @@ static bool invoke_self(b_vm *vm, b_obj_string *name, int arg_count) {
       return call_value(vm, value, arg_count);
     }
 
-    if (table_get(&instance->properties, OBJ_VAL(name), &value)) {
+    if (instance_get_field(instance, OBJ_VAL(name), &value)) {
       vm->stack_top[-arg_count - 1] = value;
       return call_value(vm, value, arg_count);
     }
@@ -734,7 +1053,7 @@ static bool invoke(b_vm *vm, b_obj_string *name, int arg_count) {
       case OBJ_INSTANCE: {
         b_obj_instance *instance = AS_INSTANCE(receiver);
 
-        if (table_get(&instance->properties, OBJ_VAL(name), &value)) {
+        if (instance_get_field(instance, OBJ_VAL(name), &value)) {
           vm->stack_top[-arg_count - 1] = value;
           return call_value(vm, value, arg_count);
         }
@@ -784,6 +1103,12 @@ static bool invoke(b_vm *vm, b_obj_string *name, int arg_count) {
         }
         return throw_exception(vm, "Bytes has no method %s()", name->chars);
       }
+      case OBJ_FIBER: {
+        if (table_get(&vm->methods_fiber, OBJ_VAL(name), &value)) {
+          return call_native_method(vm, AS_NATIVE(value), arg_count);
+        }
+        return throw_exception(vm, "Fiber has no method %s()", name->chars);
+      }
       default: {
         return throw_exception(vm, "cannot call method %s on object of type %s",
                                name->chars, value_type(receiver));
@@ -792,6 +1117,380 @@ static bool invoke(b_vm *vm, b_obj_string *name, int arg_count) {
   }
 }
 
+static inline b_cache_entry *find_cache_entry(b_inline_cache *cache, b_obj_class *klass, b_shape *shape) {
+  int count = cache->count;
+  for (int i = 0; i < count; i++) {
+    b_cache_entry *entry = &cache->entries[i];
+    if (entry->klass == klass && entry->shape == shape && entry->version == klass->version) {
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+static inline void update_inline_cache(b_vm *vm, b_inline_cache *cache, b_obj_class *klass, b_shape *shape,
+                                       int slot, b_value value) {
+  b_cache_entry *entry = NULL;
+  for (int i = 0; i < cache->count; i++) {
+    if (cache->entries[i].klass == klass && cache->entries[i].shape == shape) {
+      entry = &cache->entries[i];
+      break;
+    }
+  }
+
+  if (entry == NULL) {
+    if (cache->count < INLINE_CACHE_SIZE) {
+      entry = &cache->entries[cache->count++];
+    } else {
+      // megamorphic site, evict one of the existing receivers.
+      uintptr_t key = shape != NULL ? (uintptr_t) shape : (uintptr_t) klass;
+      entry = &cache->entries[(key >> 4) % INLINE_CACHE_SIZE];
+    }
+  }
+
+  entry->klass = klass;
+  entry->shape = shape;
+  entry->version = klass->version;
+  entry->slot = slot;
+  entry->value = value;
+  // the cache belongs to the function running the instruction.
+  write_barrier_all(vm, &vm->current_frame->closure->function->obj);
+}
+
+// the methods of strings, lists and the other built-in types never change
+// once the vm is up, so a call site only has to remember the native it
+// found for each type of receiver.
+static inline b_table *builtin_methods(b_vm *vm, b_obj_type type) {
+  switch (type) {
+    case OBJ_STRING: return &vm->methods_string;
+    case OBJ_LIST: return &vm->methods_list;
+    case OBJ_DICT: return &vm->methods_dict;
+    case OBJ_FILE: return &vm->methods_file;
+    case OBJ_BYTES: return &vm->methods_bytes;
+    case OBJ_RANGE: return &vm->methods_range;
+    case OBJ_FIBER: return &vm->methods_fiber;
+    default: return NULL;
+  }
+}
+
+static inline b_cache_entry *find_builtin_entry(b_inline_cache *cache, b_obj_type type) {
+  for (int i = 0; i < cache->count; i++) {
+    b_cache_entry *entry = &cache->entries[i];
+    if (entry->klass == NULL && entry->slot == (int) type) {
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+static inline void update_builtin_cache(b_vm *vm, b_inline_cache *cache, b_obj_type type, b_value method) {
+  b_cache_entry *entry = cache->count < INLINE_CACHE_SIZE
+      ? &cache->entries[cache->count++]
+      : &cache->entries[type % INLINE_CACHE_SIZE];
+
+  entry->klass = NULL;
+  entry->shape = NULL;
+  entry->version = 0;
+  entry->slot = (int) type;
+  entry->value = method;
+  write_barrier_all(vm, &vm->current_frame->closure->function->obj);
+}
+
+static bool invoke_cached(b_vm *vm, b_obj_string *name, int arg_count, b_inline_cache *cache) {
+  b_value receiver = peek(vm, arg_count);
+
+  // dictionary mode instances do not have a stable layout to cache.
+  if (IS_INSTANCE(receiver) && AS_INSTANCE(receiver)->shape != NULL) {
+    b_obj_instance *instance = AS_INSTANCE(receiver);
+    b_shape *shape = instance->shape;
+    b_value value;
+
+    b_cache_entry *entry = find_cache_entry(cache, instance->klass, shape);
+    if (entry != NULL) {
+      if (entry->slot >= 0) {
+        value = instance->fields[entry->slot];
+        vm->stack_top[-arg_count - 1] = value;
+        return call_value(vm, value, arg_count);
+      }
+      return call_value(vm, entry->value, arg_count);
+    }
+
+    int slot = shape_find_slot(shape, OBJ_VAL(name));
+    if (slot >= 0) {
+      update_inline_cache(vm, cache, instance->klass, shape, slot, NIL_VAL);
+      value = instance->fields[slot];
+      vm->stack_top[-arg_count - 1] = value;
+      return call_value(vm, value, arg_count);
+    }
+
+    if (table_get(&instance->klass->methods, OBJ_VAL(name), &value)
+        && get_method_type(value) != TYPE_PRIVATE) {
+      update_inline_cache(vm, cache, instance->klass, shape, -1, value);
+      return call_value(vm, value, arg_count);
+    }
+  } else if (IS_OBJ(receiver)) {
+    b_obj_type type = OBJ_TYPE(receiver);
+    b_cache_entry *entry = find_builtin_entry(cache, type);
+    if (entry != NULL) {
+      return call_native_method(vm, AS_NATIVE(entry->value), arg_count);
+    }
+
+    b_table *methods = builtin_methods(vm, type);
+    b_value value;
+    if (methods != NULL && table_get(methods, OBJ_VAL(name), &value)) {
+      update_builtin_cache(vm, cache, type, value);
+      return call_native_method(vm, AS_NATIVE(value), arg_count);
+    }
+  }
+
+  return invoke(vm, name, arg_count);
+}
+
+static bool invoke_self_cached(b_vm *vm, b_obj_string *name, int arg_count, b_inline_cache *cache) {
+  b_value receiver = peek(vm, arg_count);
+
+  if (IS_INSTANCE(receiver)) {
+    b_obj_class *klass = AS_INSTANCE(receiver)->klass;
+
+    b_cache_entry *entry = find_cache_entry(cache, klass, NULL);
+    if (entry != NULL) {
+      return call_value(vm, entry->value, arg_count);
+    }
+
+    b_value value;
+    if (table_get(&klass->methods, OBJ_VAL(name), &value)) {
+      update_inline_cache(vm, cache, klass, NULL, -1, value);
+      return call_value(vm, value, arg_count);
+    }
+  }
+
+  return invoke_self(vm, name, arg_count);
+}
+
+static bool invoke_from_class_cached(b_vm *vm, b_obj_class *klass, b_obj_string *name,
+                                     int arg_count, b_inline_cache *cache) {
+  b_cache_entry *entry = find_cache_entry(cache, klass, NULL);
+  if (entry != NULL) {
+    return call_value(vm, entry->value, arg_count);
+  }
+
+  b_value value;
+  if (table_get(&klass->methods, OBJ_VAL(name), &value)
+      && get_method_type(value) != TYPE_PRIVATE) {
+    update_inline_cache(vm, cache, klass, NULL, -1, value);
+    return call_value(vm, value, arg_count);
+  }
+
+  return invoke_from_class(vm, klass, name, arg_count);
+}
+
+// replaces the instance on top of the stack with the cached field or bound
+// method for the site. returns false when the cache cannot answer.
+static inline bool get_cached_property(b_vm *vm, b_obj_instance *instance, b_inline_cache *cache) {
+  if (instance->shape == NULL) {
+    return false;
+  }
+
+  b_cache_entry *entry = find_cache_entry(cache, instance->klass, instance->shape);
+  if (entry == NULL) {
+    return false;
+  }
+
+  if (entry->slot >= 0) {
+    vm->stack_top[-1] = instance->fields[entry->slot];
+    return true;
+  }
+
+  // the shape had no field with this name when the entry was filled,
+  // so the method cannot be shadowed by one.
+  b_obj_bound *bound = new_bound_method(vm, peek(vm, 0), AS_CLOSURE(entry->value));
+  vm->stack_top[-1] = OBJ_VAL(bound);
+  return true;
+}
+
+// returns the entry for the global in the module's values table through
+// the slot the compiler assigned to it. the slot remembers where the entry
+// was last found so the table is only probed when it has moved.
+inline b_entry *find_global_entry(b_obj_module *module, uint16_t slot, b_obj_string *name) {
+  b_table *values = &module->values;
+  int index = module->slots[slot];
+
+  if (index >= 0 && index < values->capacity) {
+    b_entry *entry = &values->entries[index];
+    if (IS_STRING(entry->key) && AS_STRING(entry->key) == name) {
+      return entry;
+    }
+  }
+
+  b_entry *entry = table_get_entry(values, OBJ_VAL(name));
+  if (entry != NULL) {
+    module->slots[slot] = (int) (entry - values->entries);
+  }
+  return entry;
+}
+
+// reads an index without going through a double when it is an integer.
+// integers beyond the range of an int become INT_MIN so that they fail
+// every bounds check.
+static inline int index_value(b_value value) {
+  if (IS_INTEGER(value)) {
+    int64_t index = AS_INTEGER(value);
+    return index < INT_MIN || index > INT_MAX ? INT_MIN : (int) index;
+  }
+  return (int) AS_NUMBER(value);
+}
+
+// steps the key of a numerically indexed iterable exactly like the @itern
+// methods of lists, strings, bytes and ranges do.
+static inline b_iter_result next_index(b_value *state, int length, int *index) {
+  b_value key = state[1];
+
+  if (IS_NIL(key)) {
+    if (length == 0) {
+      state[1] = FALSE_VAL;
+      return ITER_DONE;
+    }
+    *index = 0;
+  } else if (IS_NUMBER(key)) {
+    int current = index_value(key);
+    if (current >= length - 1) {
+      state[1] = NIL_VAL;
+      return ITER_DONE;
+    }
+    *index = current + 1;
+  } else {
+    // let @itern raise the error.
+    return ITER_INVOKE;
+  }
+
+  state[1] = INTEGER_VAL(*index);
+  return ITER_CONTINUE;
+}
+
+// utf-8 strings remember the code point index and byte offset of the last
+// character in the cursor so that walking them is not quadratic.
+#define UTF8_CURSOR_SCALE 67108864.0 // 2^26
+
+static inline void utf8_next_char(b_obj_string *string, b_value *cursor, int index, int *start, int *end) {
+  bool can_cache = string->length < (int) UTF8_CURSOR_SCALE;
+
+  if (can_cache && IS_NUMBER(*cursor)
+      && (int) (AS_NUMBER(*cursor) / UTF8_CURSOR_SCALE) == index - 1) {
+    int offset = (int) fmod(AS_NUMBER(*cursor), UTF8_CURSOR_SCALE) + 1;
+    while (offset < string->length && (string->chars[offset] & 0xc0) == 0x80) {
+      offset++;
+    }
+    *start = offset;
+    *end = offset + 1;
+    while (*end < string->length && (string->chars[*end] & 0xc0) == 0x80) {
+      (*end)++;
+    }
+  } else {
+    *start = index;
+    *end = index + 1;
+    utf8slice(string->chars, start, end);
+  }
+
+  if (can_cache) {
+    *cursor = NUMBER_VAL((double) index * UTF8_CURSOR_SCALE + *start);
+  }
+}
+
+// moves a for-in loop over a built-in iterable to its next item. state
+// holds the iterable, the key, the value and a cursor the loop keeps for
+// whichever iterable it walks.
+b_iter_result iterate(b_vm *vm, b_value *state) {
+  if (!IS_OBJ(state[0])) {
+    return ITER_INVOKE;
+  }
+
+  int index;
+  b_iter_result result;
+
+  switch (AS_OBJ(state[0])->type) {
+    case OBJ_LIST: {
+      b_obj_list *list = AS_LIST(state[0]);
+      if ((result = next_index(state, list->items.count, &index)) == ITER_CONTINUE) {
+        state[2] = index >= 0 ? list->items.values[index] : NIL_VAL;
+      }
+      return result;
+    }
+
+    case OBJ_RANGE: {
+      b_obj_range *range = AS_RANGE(state[0]);
+      if ((result = next_index(state, range->range, &index)) == ITER_CONTINUE) {
+        if (index < 0) {
+          state[2] = NIL_VAL;
+        } else {
+          state[2] = INTEGER_VAL(range->lower > range->upper ? range->lower - index : range->lower + index);
+        }
+      } else if (result == ITER_DONE) {
+        state[1] = NIL_VAL;
+      }
+      return result;
+    }
+
+    case OBJ_STRING: {
+      b_obj_string *string = AS_STRING(state[0]);
+      int length = string->is_ascii ? string->length : string->utf8_length;
+      if ((result = next_index(state, length, &index)) == ITER_CONTINUE) {
+        if (index < 0) {
+          state[2] = NIL_VAL;
+        } else if (string->is_ascii) {
+          state[2] = OBJ_VAL(copy_string(vm, string->chars + index, 1));
+        } else {
+          int start, end;
+          utf8_next_char(string, &state[3], index, &start, &end);
+          state[2] = OBJ_VAL(copy_string(vm, string->chars + start, end - start));
+        }
+      }
+      return result;
+    }
+
+    case OBJ_BYTES: {
+      b_obj_bytes *bytes = AS_BYTES(state[0]);
+      if ((result = next_index(state, bytes->bytes.count, &index)) == ITER_CONTINUE) {
+        state[2] = index >= 0 ? INTEGER_VAL(bytes->bytes.bytes[index]) : NIL_VAL;
+      }
+      return result;
+    }
+
+    case OBJ_DICT: {
+      b_obj_dict *dict = AS_DICT(state[0]);
+      b_value_arr *names = &dict->names;
+
+      if (IS_NIL(state[1])) {
+        if (names->count == 0) {
+          state[1] = FALSE_VAL;
+          return ITER_DONE;
+        }
+        index = 0;
+      } else {
+        // the cursor holds the position of the current key unless the
+        // body changed the key or removed it from the dictionary.
+        index = IS_NUMBER(state[3]) ? (int) AS_NUMBER(state[3]) : -1;
+        if (index < 0 || index >= names->count || !values_equal(names->values[index], state[1])) {
+          for (index = 0; index < names->count && !values_equal(names->values[index], state[1]); index++);
+        }
+        if (++index >= names->count) {
+          state[1] = NIL_VAL;
+          return ITER_DONE;
+        }
+      }
+
+      state[1] = names->values[index];
+      state[3] = INTEGER_VAL(index);
+      if (!table_get(&dict->items, state[1], &state[2])) {
+        state[2] = NIL_VAL;
+      }
+      return ITER_CONTINUE;
+    }
+
+    default:
+      return ITER_INVOKE;
+  }
+}
+
 static inline bool bind_method(b_vm *vm, b_obj_class *klass, b_obj_string *name) {
   b_value method;
   if (table_get(&klass->methods, OBJ_VAL(name), &method)) {
@@ -805,6 +1504,13 @@ static inline bool bind_method(b_vm *vm, b_obj_class *klass, b_obj_string *name)
     return true;
   }
 
+  b_value value;
+  if (IS_INSTANCE(peek(vm, 0)) && get_stack_trace_field(vm, AS_INSTANCE(peek(vm, 0)), name, &value)) {
+    pop(vm);
+    push(vm, value);
+    return true;
+  }
+
   return throw_exception(vm, "undefined property '%s'", name->chars);
 }
 
@@ -832,20 +1538,14 @@ static b_obj_up_value *capture_up_value(b_vm *vm, b_value *local) {
   return created_up_value;
 }
 
-static inline void close_up_values(b_vm *vm, const b_value *last) {
-  while (vm->open_up_values != NULL && vm->open_up_values->location >= last) {
-    b_obj_up_value *up_value = vm->open_up_values;
-    up_value->closed = *up_value->location;
-    up_value->location = &up_value->closed;
-    vm->open_up_values = up_value->next;
-  }
-}
-
 static inline void define_method(b_vm *vm, b_obj_string *name) {
   b_value method = peek(vm, 0);
   b_obj_class *klass = AS_CLASS(peek(vm, 1));
 
   table_set(vm, &klass->methods, OBJ_VAL(name), method);
+  write_barrier(vm, &klass->obj, OBJ_VAL(name));
+  write_barrier(vm, &klass->obj, method);
+  klass->version++;
   if (get_method_type(method) == TYPE_INITIALIZER) {
     klass->initializer = method;
   }
@@ -861,6 +1561,8 @@ static inline void define_property(b_vm *vm, b_obj_string *name, bool is_static)
   } else {
     table_set(vm, &klass->static_properties, OBJ_VAL(name), property);
   }
+  write_barrier(vm, &klass->obj, OBJ_VAL(name));
+  write_barrier(vm, &klass->obj, property);
   pop(vm);
 }
 
@@ -898,16 +1600,9 @@ inline bool is_false(b_value value) {
   return false;
 }
 
-bool is_instance_of(b_obj_class *klass1, char *klass2_name) {
-  while (klass1 != NULL) {
-    if ((int) strlen(klass2_name) == klass1->name->length
-        && memcmp(klass1->name->chars, klass2_name, klass1->name->length) == 0) {
-      return true;
-    }
-    klass1 = klass1->superclass;
-  }
-
-  return false;
+bool is_instance_of(b_obj_class *klass1, b_obj_class *klass2) {
+  return klass1 == klass2
+      || (klass2->depth < klass1->depth && klass1->supers[klass2->depth] == klass2);
 }
 
 inline bool dict_set_entry(b_vm *vm, b_obj_dict *dict, b_value key, b_value value) {
@@ -915,6 +1610,8 @@ inline bool dict_set_entry(b_vm *vm, b_obj_dict *dict, b_value key, b_value valu
   if (!table_get(&dict->items, key, &temp_value)) {
     write_value_arr(vm, &dict->names, key); // add key if it doesn't exist.
   }
+  write_barrier(vm, &dict->obj, key);
+  write_barrier(vm, &dict->obj, value);
   return table_set(vm, &dict->items, key, value);
 }
 
@@ -949,11 +1646,11 @@ static b_obj_list *add_list(b_vm *vm, b_obj_list *a, b_obj_list *b) {
   push(vm, OBJ_VAL(list));
 
   for (int i = 0; i < a->items.count; i++) {
-    write_value_arr(vm, &list->items, a->items.values[i]);
+    write_list(vm, list, a->items.values[i]);
   }
 
   for (int i = 0; i < b->items.count; i++) {
-    write_value_arr(vm, &list->items, b->items.values[i]);
+    write_list(vm, list, b->items.values[i]);
   }
 
   pop(vm);
@@ -972,7 +1669,7 @@ static inline b_obj_bytes *add_bytes(b_vm *vm, b_obj_bytes *a, b_obj_bytes *b) {
 static inline void multiply_list(b_vm *vm, b_obj_list *a, b_obj_list *new_list, int times) {
   for (int i = 0; i < times; i++) {
     for (int j = 0; j < a->items.count; j++) {
-      write_value_arr(vm, &new_list->items, a->items.values[j]);
+      write_list(vm, new_list, a->items.values[j]);
     }
   }
 }
@@ -1017,7 +1714,7 @@ static bool string_get_index(b_vm *vm, b_obj_string *string, bool will_assign) {
     return throw_exception(vm, "strings are numerically indexed");
   }
 
-  int index = AS_NUMBER(lower);
+  int index = index_value(lower);
   int length = string->is_ascii ? string->length : string->utf8_length;
   int real_index = index;
   if (index < 0)
@@ -1092,7 +1789,7 @@ static bool bytes_get_index(b_vm *vm, b_obj_bytes *bytes, bool will_assign) {
     return throw_exception(vm, "bytes are numerically indexed");
   }
 
-  int index = AS_NUMBER(lower);
+  int index = index_value(lower);
   int real_index = index;
   if (index < 0)
     index = bytes->bytes.count + index;
@@ -1133,18 +1830,53 @@ static bool bytes_get_ranged_index(b_vm *vm, b_obj_bytes *bytes, bool will_assig
     return true;
   }
 
-  if (upper_index < 0)
-    upper_index = bytes->bytes.count + upper_index;
-
-  if (upper_index > bytes->bytes.count)
-    upper_index = bytes->bytes.count;
+  if (upper_index < 0)
+    upper_index = bytes->bytes.count + upper_index;
+
+  if (upper_index > bytes->bytes.count)
+    upper_index = bytes->bytes.count;
+
+  if (!will_assign) {
+    pop_n(vm, 3); // +1 for the list itself
+  }
+  push(vm, OBJ_VAL(copy_bytes(vm, bytes->bytes.bytes + lower_index,
+                              upper_index - lower_index)));
+  return true;
+}
+
+// copies the variadic arguments of the frame into the list __args__ is from
+// then on.
+static void materialize_args(b_vm *vm, b_call_frame *frame) {
+  int slot = frame->closure->function->arity;
+  b_obj_list *list = new_list(vm);
+  frame->slots[slot] = OBJ_VAL(list);
+  for (int i = 0; i < frame->va_count; i++) {
+    write_list(vm, list, frame->slots[i - frame->va_count]);
+  }
+}
+
+// reads __args__[index] while the variadic arguments are still on the stack.
+static bool args_get_index(b_vm *vm, b_call_frame *frame) {
+  b_value lower = peek(vm, 0);
+
+  if (!IS_NUMBER(lower)) {
+    pop(vm);
+    return throw_exception(vm, "list are numerically indexed");
+  }
+
+  int index = index_value(lower);
+  int real_index = index;
+  if (index < 0)
+    index = frame->va_count + index;
 
-  if (!will_assign) {
-    pop_n(vm, 3); // +1 for the list itself
+  if (index < frame->va_count && index >= 0) {
+    pop_n(vm, 2);
+    push(vm, frame->slots[index - frame->va_count]);
+    return true;
+  } else {
+    pop(vm);
+    return throw_exception(vm, "list index %d out of range", real_index);
   }
-  push(vm, OBJ_VAL(copy_bytes(vm, bytes->bytes.bytes + lower_index,
-                              upper_index - lower_index)));
-  return true;
 }
 
 static bool list_get_index(b_vm *vm, b_obj_list *list, bool will_assign) {
@@ -1155,7 +1887,7 @@ static bool list_get_index(b_vm *vm, b_obj_list *list, bool will_assign) {
     return throw_exception(vm, "list are numerically indexed");
   }
 
-  int index = AS_NUMBER(lower);
+  int index = index_value(lower);
   int real_index = index;
   if (index < 0)
     index = list->items.count + index;
@@ -1206,7 +1938,7 @@ static bool list_get_ranged_index(b_vm *vm, b_obj_list *list, bool will_assign)
   push(vm, OBJ_VAL(n_list)); // gc protect
 
   for (int i = lower_index; i < upper_index; i++) {
-    write_value_arr(vm, &n_list->items, list->items.values[i]);
+    write_list(vm, n_list, list->items.values[i]);
   }
   pop(vm);  // clear gc protect
 
@@ -1228,6 +1960,8 @@ static inline void dict_set_index(b_vm *vm, b_obj_dict *dict, b_value index, b_v
 
 static inline void module_set_index(b_vm *vm, b_obj_module *module, b_value index, b_value value) {
   table_set(vm, &module->values, index, value);
+  write_barrier(vm, &module->obj, index);
+  write_barrier(vm, &module->obj, value);
   pop_n(vm, 3); // pop the value, index and dict out
 
   // leave the value on the stack for consumption
@@ -1241,11 +1975,12 @@ static bool list_set_index(b_vm *vm, b_obj_list *list, b_value index, b_value va
     return throw_exception(vm, "list are numerically indexed");
   }
 
-  int _position = AS_NUMBER(index);
+  int _position = index_value(index);
   int position = _position < 0 ? list->items.count + _position : _position;
 
   if (position < list->items.count && position > -(list->items.count)) {
     list->items.values[position] = value;
+    write_barrier(vm, &list->obj, value);
     pop_n(vm, 3); // pop the value, index and list out
 
     // leave the value on the stack for consumption
@@ -1267,7 +2002,7 @@ static bool bytes_set_index(b_vm *vm, b_obj_bytes *bytes, b_value index, b_value
     return throw_exception(vm, "invalid byte. bytes are numbers between 0 and 255.");
   }
 
-  int _position = AS_NUMBER(index);
+  int _position = index_value(index);
   int byte = AS_NUMBER(value);
 
   int position = _position < 0 ? bytes->bytes.count + _position : _position;
@@ -1354,37 +2089,59 @@ static bool concatenate(b_vm *vm) {
   return true;
 }
 
-static inline int floor_div(double a, double b) {
-  int d = (int) a / (int) b;
-  return d - ((d * b == a) & ((a < 0) ^ (b < 0)));
-}
-
-static inline double modulo(double a, double b) {
-  double r = fmod(a, b);
-  if (r!=0 && ((r<0) != (b<0))) {
-    r += b;
-  }
-  return r;
+// a register operand is a slot of the frame, or a constant when
+// REG_CONSTANT is set.
+static inline b_value register_value(b_call_frame *frame, b_value *constants, uint16_t operand) {
+  return (operand & REG_CONSTANT) ? constants[operand & ~REG_CONSTANT] : frame->slots[operand];
 }
 
 b_ptr_result run(b_vm *vm) {
-  vm->current_frame = &vm->frames[vm->frame_count - 1];
+  // the instruction pointer and constant table of the executing frame are
+  // kept in locals and only written back to the frame when something outside
+  // of this loop may need them (calls, returns and exceptions).
+  b_call_frame *frame;
+  uint8_t *ip;
+  b_value *constants;
+
+#define STORE_FRAME() frame->ip = ip
+
+#define LOAD_FRAME()                                                           \
+  do {                                                                         \
+    if (vm->frame_count == 0) {                                                \
+      return PTR_RUNTIME_ERR;                                                  \
+    }                                                                          \
+    frame = vm->current_frame = &vm->frames[vm->frame_count - 1];              \
+    ip = frame->ip;                                                            \
+    constants = frame->closure->function->blob.constants.values;               \
+  } while (false)
+
+#define RUNTIME_ERROR(...)                                                     \
+  do {                                                                         \
+    STORE_FRAME();                                                             \
+    if (!throw_exception(vm, ##__VA_ARGS__)) {                                 \
+      EXIT_VM();                                                               \
+    }                                                                          \
+    LOAD_FRAME();                                                              \
+  } while (false)
+
+  LOAD_FRAME();
 
-#define READ_BYTE() (*vm->current_frame->ip++)
+#define READ_BYTE() (*ip++)
 
 #define READ_SHORT()                                                           \
-  (vm->current_frame->ip += 2, (uint16_t)((vm->current_frame->ip[-2] << 8) | vm->current_frame->ip[-1]))
+  (ip += 2, (uint16_t)((ip[-2] << 8) | ip[-1]))
 
-#define READ_CONSTANT()                                                        \
-  (vm->current_frame->closure->function->blob.constants.values[READ_SHORT()])
+#define READ_CONSTANT() (constants[READ_SHORT()])
 
 #define READ_STRING() (AS_STRING(READ_CONSTANT()))
 
+#define READ_CACHE() (&frame->closure->function->blob.caches[READ_SHORT()])
+
 #define BINARY_OP(type, op)                                                    \
   do {                                                                         \
     if ((!IS_NUMBER(peek(vm, 0)) && !IS_BOOL(peek(vm, 0))) ||                  \
         (!IS_NUMBER(peek(vm, 1)) && !IS_BOOL(peek(vm, 1)))) {                  \
-      runtime_error("unsupported operand %s for %s and %s", #op,          \
+      RUNTIME_ERROR("unsupported operand %s for %s and %s", #op,          \
                      value_type(peek(vm, 0)), value_type(peek(vm, 1)));        \
                      break;        \
     }                                                                          \
@@ -1395,16 +2152,112 @@ b_ptr_result run(b_vm *vm) {
     push(vm, type(a op b));                                                    \
   } while (false)
 
+// rewrites the instruction being executed into its number specialized
+// form when both operands are numbers.
+#define QUICKEN(quick)                                                         \
+  if (IS_NUMBER(peek(vm, 0)) && IS_NUMBER(peek(vm, 1))) {                      \
+    ip[-1] = quick;                                                            \
+  }
+
+// runs a quickened instruction while both operands are numbers. otherwise,
+// reverts the instruction to its generic form and executes that instead.
+#define QUICK_BINARY_OP(type, op, generic)                                     \
+  do {                                                                         \
+    b_value _b = peek(vm, 0), _a = peek(vm, 1);                                \
+    if (IS_NUMBER(_a) && IS_NUMBER(_b)) {                                      \
+      vm->stack_top[-2] = type(AS_NUMBER(_a) op AS_NUMBER(_b));                \
+      vm->stack_top--;                                                         \
+    } else {                                                                   \
+      ip[-1] = generic;                                                        \
+      ip--;                                                                    \
+    }                                                                          \
+  } while (false)
+
+// the arithmetic counterpart of BINARY_OP that keeps integers integers.
+#define ARITHMETIC_OP(function, op)                                            \
+  do {                                                                         \
+    b_value _b = peek(vm, 0), _a = peek(vm, 1);                                \
+    if (IS_NUMBER(_a) && IS_NUMBER(_b)) {                                      \
+      vm->stack_top[-2] = function(_a, _b);                                    \
+      vm->stack_top--;                                                         \
+    } else {                                                                   \
+      BINARY_OP(NUMBER_VAL, op);                                               \
+    }                                                                          \
+  } while (false)
+
+#define QUICK_ARITHMETIC_OP(function, generic)                                 \
+  do {                                                                         \
+    b_value _b = peek(vm, 0), _a = peek(vm, 1);                                \
+    if (IS_NUMBER(_a) && IS_NUMBER(_b)) {                                      \
+      vm->stack_top[-2] = function(_a, _b);                                    \
+      vm->stack_top--;                                                         \
+    } else {                                                                   \
+      ip[-1] = generic;                                                        \
+      ip--;                                                                    \
+    }                                                                          \
+  } while (false)
+
+// compares the two values on top of the stack and jumps forward when the
+// comparison fails, leaving nothing on the stack.
+#define COMPARE_JUMP(op)                                                       \
+  do {                                                                         \
+    uint16_t _offset = READ_SHORT();                                           \
+    b_value _b = peek(vm, 0), _a = peek(vm, 1);                                \
+    if ((!IS_NUMBER(_b) && !IS_BOOL(_b)) || (!IS_NUMBER(_a) && !IS_BOOL(_a))) {\
+      RUNTIME_ERROR("unsupported operand %s for %s and %s", #op,               \
+                     value_type(_b), value_type(_a));                          \
+      break;                                                                   \
+    }                                                                          \
+    double b = IS_BOOL(_b) ? (AS_BOOL(_b) ? 1 : 0) : AS_NUMBER(_b);            \
+    double a = IS_BOOL(_a) ? (AS_BOOL(_a) ? 1 : 0) : AS_NUMBER(_a);            \
+    vm->stack_top -= 2;                                                        \
+    if (!(a op b)) {                                                           \
+      ip += _offset;                                                           \
+    }                                                                          \
+  } while (false)
+
+#define READ_REGISTER() (register_value(frame, constants, READ_SHORT()))
+
+// computes with two number registers and skips the stack instructions
+// behind it. anything else falls through to them.
+#define REGISTER_BINARY_OP(function)                                           \
+  do {                                                                         \
+    uint16_t _dst = READ_SHORT();                                              \
+    b_value _a = READ_REGISTER();                                              \
+    b_value _b = READ_REGISTER();                                              \
+    uint16_t _skip = READ_SHORT();                                             \
+    if (IS_NUMBER(_a) && IS_NUMBER(_b)) {                                      \
+      b_value _result = function(_a, _b);                                      \
+      if (_dst == REG_PUSH) {                                                  \
+        push(vm, _result);                                                     \
+      } else {                                                                 \
+        frame->slots[_dst] = _result;                                          \
+      }                                                                        \
+      ip += _skip;                                                             \
+    }                                                                          \
+  } while (false)
+
+#define REGISTER_COMPARE_JUMP(op)                                              \
+  do {                                                                         \
+    b_value _a = READ_REGISTER();                                              \
+    b_value _b = READ_REGISTER();                                              \
+    uint16_t _skip = READ_SHORT();                                             \
+    uint16_t _jump = READ_SHORT();                                             \
+    if (IS_NUMBER(_a) && IS_NUMBER(_b)) {                                      \
+      ip += AS_NUMBER(_a) op AS_NUMBER(_b) ? _skip : _jump;                    \
+    }                                                                          \
+  } while (false)
+
 #define BINARY_BIT_OP(op)                                                \
   do {                                                                         \
     if ((!IS_NUMBER(peek(vm, 0)) && !IS_BOOL(peek(vm, 0))) ||                  \
         (!IS_NUMBER(peek(vm, 1)) && !IS_BOOL(peek(vm, 1)))) {                  \
-      runtime_error("unsupported operand %s for %s and %s", #op,          \
+      RUNTIME_ERROR("unsupported operand %s for %s and %s", #op,          \
                      value_type(peek(vm, 0)), value_type(peek(vm, 1)));        \
                      break;       \
     }                                                                          \
-    long b = AS_NUMBER(pop(vm));                                       \
-    long a = AS_NUMBER(pop(vm));                        \
+    long b = AS_LONG(pop(vm));                                       \
+    long a = AS_LONG(pop(vm));                        \
     push(vm, INTEGER_VAL(a op b));                                          \
   } while (false)
 
@@ -1412,7 +2265,7 @@ b_ptr_result run(b_vm *vm) {
   do {                                                                         \
     if ((!IS_NUMBER(peek(vm, 0)) && !IS_BOOL(peek(vm, 0))) ||                  \
         (!IS_NUMBER(peek(vm, 1)) && !IS_BOOL(peek(vm, 1)))) {                  \
-      runtime_error("unsupported operand %s for %s and %s", #op,          \
+      RUNTIME_ERROR("unsupported operand %s for %s and %s", #op,          \
                      value_type(peek(vm, 0)), value_type(peek(vm, 1)));        \
                      break;        \
     }                                                                          \
@@ -1423,6 +2276,119 @@ b_ptr_result run(b_vm *vm) {
     push(vm, type(op(a, b)));                                                  \
   } while (false)
 
+#if USE_COMPUTED_GOTO && !(defined(DEBUG_STACK) && DEBUG_STACK)
+  // direct threaded dispatch: every handler jumps straight to the next one
+  // instead of going back through the switch.
+  static void *dispatch_table[UINT8_COUNT] = {
+      [0 ... UINT8_MAX] = &&code_default,
+      [OP_DEFINE_GLOBAL] = &&code_OP_DEFINE_GLOBAL,
+      [OP_GET_GLOBAL] = &&code_OP_GET_GLOBAL,
+      [OP_SET_GLOBAL] = &&code_OP_SET_GLOBAL,
+      [OP_GET_LOCAL] = &&code_OP_GET_LOCAL,
+      [OP_GET_UP_VALUE] = &&code_OP_GET_UP_VALUE,
+      [OP_SET_LOCAL] = &&code_OP_SET_LOCAL,
+      [OP_SET_UP_VALUE] = &&code_OP_SET_UP_VALUE,
+      [OP_CLOSE_UP_VALUE] = &&code_OP_CLOSE_UP_VALUE,
+      [OP_GET_PROPERTY] = &&code_OP_GET_PROPERTY,
+      [OP_GET_SELF_PROPERTY] = &&code_OP_GET_SELF_PROPERTY,
+      [OP_SET_PROPERTY] = &&code_OP_SET_PROPERTY,
+      [OP_JUMP_IF_FALSE] = &&code_OP_JUMP_IF_FALSE,
+      [OP_JUMP] = &&code_OP_JUMP,
+      [OP_LOOP] = &&code_OP_LOOP,
+      [OP_EQUAL] = &&code_OP_EQUAL,
+      [OP_GREATER] = &&code_OP_GREATER,
+      [OP_LESS] = &&code_OP_LESS,
+      [OP_EMPTY] = &&code_OP_EMPTY,
+      [OP_NIL] = &&code_OP_NIL,
+      [OP_TRUE] = &&code_OP_TRUE,
+      [OP_FALSE] = &&code_OP_FALSE,
+      [OP_ADD] = &&code_OP_ADD,
+      [OP_SUBTRACT] = &&code_OP_SUBTRACT,
+      [OP_MULTIPLY] = &&code_OP_MULTIPLY,
+      [OP_DIVIDE] = &&code_OP_DIVIDE,
+      [OP_F_DIVIDE] = &&code_OP_F_DIVIDE,
+      [OP_REMINDER] = &&code_OP_REMINDER,
+      [OP_POW] = &&code_OP_POW,
+      [OP_NEGATE] = &&code_OP_NEGATE,
+      [OP_NOT] = &&code_OP_NOT,
+      [OP_BIT_NOT] = &&code_OP_BIT_NOT,
+      [OP_AND] = &&code_OP_AND,
+      [OP_OR] = &&code_OP_OR,
+      [OP_XOR] = &&code_OP_XOR,
+      [OP_LSHIFT] = &&code_OP_LSHIFT,
+      [OP_RSHIFT] = &&code_OP_RSHIFT,
+      [OP_ONE] = &&code_OP_ONE,
+      [OP_CONSTANT] = &&code_OP_CONSTANT,
+      [OP_ECHO] = &&code_OP_ECHO,
+      [OP_POP] = &&code_OP_POP,
+      [OP_DUP] = &&code_OP_DUP,
+      [OP_POP_N] = &&code_OP_POP_N,
+      [OP_ASSERT] = &&code_OP_ASSERT,
+      [OP_DIE] = &&code_OP_DIE,
+      [OP_CLOSURE] = &&code_OP_CLOSURE,
+      [OP_CALL] = &&code_OP_CALL,
+      [OP_TAIL_CALL] = &&code_OP_TAIL_CALL,
+      [OP_INVOKE] = &&code_OP_INVOKE,
+      [OP_INVOKE_SELF] = &&code_OP_INVOKE_SELF,
+      [OP_RETURN] = &&code_OP_RETURN,
+      [OP_CLASS] = &&code_OP_CLASS,
+      [OP_METHOD] = &&code_OP_METHOD,
+      [OP_CLASS_PROPERTY] = &&code_OP_CLASS_PROPERTY,
+      [OP_INHERIT] = &&code_OP_INHERIT,
+      [OP_GET_SUPER] = &&code_OP_GET_SUPER,
+      [OP_SUPER_INVOKE] = &&code_OP_SUPER_INVOKE,
+      [OP_SUPER_INVOKE_SELF] = &&code_OP_SUPER_INVOKE_SELF,
+      [OP_RANGE] = &&code_OP_RANGE,
+      [OP_LIST] = &&code_OP_LIST,
+      [OP_DICT] = &&code_OP_DICT,
+      [OP_GET_INDEX] = &&code_OP_GET_INDEX,
+      [OP_GET_RANGED_INDEX] = &&code_OP_GET_RANGED_INDEX,
+      [OP_SET_INDEX] = &&code_OP_SET_INDEX,
+      [OP_CALL_IMPORT] = &&code_OP_CALL_IMPORT,
+      [OP_NATIVE_MODULE] = &&code_OP_NATIVE_MODULE,
+      [OP_SELECT_IMPORT] = &&code_OP_SELECT_IMPORT,
+      [OP_SELECT_NATIVE_IMPORT] = &&code_OP_SELECT_NATIVE_IMPORT,
+      [OP_IMPORT_ALL_NATIVE] = &&code_OP_IMPORT_ALL_NATIVE,
+      [OP_EJECT_IMPORT] = &&code_OP_EJECT_IMPORT,
+      [OP_EJECT_NATIVE_IMPORT] = &&code_OP_EJECT_NATIVE_IMPORT,
+      [OP_IMPORT_ALL] = &&code_OP_IMPORT_ALL,
+      [OP_PUBLISH_TRY] = &&code_OP_PUBLISH_TRY,
+      [OP_STRINGIFY] = &&code_OP_STRINGIFY,
+      [OP_SWITCH] = &&code_OP_SWITCH,
+      [OP_CHOICE] = &&code_OP_CHOICE,
+      [OP_ITER_PREP] = &&code_OP_ITER_PREP,
+      [OP_ITER_NEXT] = &&code_OP_ITER_NEXT,
+      [OP_GET_ARGS] = &&code_OP_GET_ARGS,
+      [OP_ARGS_LENGTH] = &&code_OP_ARGS_LENGTH,
+      [OP_ADD_NUM] = &&code_OP_ADD_NUM,
+      [OP_SUBTRACT_NUM] = &&code_OP_SUBTRACT_NUM,
+      [OP_MULTIPLY_NUM] = &&code_OP_MULTIPLY_NUM,
+      [OP_DIVIDE_NUM] = &&code_OP_DIVIDE_NUM,
+      [OP_GREATER_NUM] = &&code_OP_GREATER_NUM,
+      [OP_LESS_NUM] = &&code_OP_LESS_NUM,
+      [OP_GET_LOCALS] = &&code_OP_GET_LOCALS,
+      [OP_GET_LOCAL_CONSTANT] = &&code_OP_GET_LOCAL_CONSTANT,
+      [OP_SET_LOCAL_POP] = &&code_OP_SET_LOCAL_POP,
+      [OP_POP_JUMP_IF_FALSE] = &&code_OP_POP_JUMP_IF_FALSE,
+      [OP_LESS_JUMP] = &&code_OP_LESS_JUMP,
+      [OP_GREATER_JUMP] = &&code_OP_GREATER_JUMP,
+      [OP_INVOKE_LOCAL] = &&code_OP_INVOKE_LOCAL,
+      [OP_REG_MOVE] = &&code_OP_REG_MOVE,
+      [OP_REG_ADD] = &&code_OP_REG_ADD,
+      [OP_REG_SUBTRACT] = &&code_OP_REG_SUBTRACT,
+      [OP_REG_MULTIPLY] = &&code_OP_REG_MULTIPLY,
+      [OP_REG_DIVIDE] = &&code_OP_REG_DIVIDE,
+      [OP_REG_LESS_JUMP] = &&code_OP_REG_LESS_JUMP,
+      [OP_REG_GREATER_JUMP] = &&code_OP_REG_GREATER_JUMP,
+  };
+
+#define CASE(code) case code: code_##code:
+#define DISPATCH() goto *dispatch_table[READ_BYTE()]
+#else
+#define CASE(code) case code:
+#define DISPATCH() break
+#endif
+
   for (;;) {
     // try...finally... (i.e. try without a catch but finally
     // whose try body raises an exception)
@@ -1441,24 +2407,22 @@ b_ptr_result run(b_vm *vm) {
       }
       printf("\n");
       disassemble_instruction(
-          &vm->current_frame->closure->function->blob,
-          (int) (vm->current_frame->ip - vm->current_frame->closure->function->blob.code));
+          &frame->closure->function->blob,
+          (int) (ip - frame->closure->function->blob.code));
 #endif
 
-    uint8_t instruction;
-
-    switch (instruction = READ_BYTE()) {
+    switch (READ_BYTE()) {
 
-      case OP_CONSTANT: {
+      CASE(OP_CONSTANT) {
         b_value constant = READ_CONSTANT();
         push(vm, constant);
-        break;
+        DISPATCH();
       }
 
-      case OP_ADD: {
+      CASE(OP_ADD) {
         if (IS_STRING(peek(vm, 0)) || IS_STRING(peek(vm, 1))) {
           if (!concatenate(vm)) {
-            runtime_error("unsupported operand + for %s and %s", value_type(peek(vm, 0)), value_type(peek(vm, 1)));
+            RUNTIME_ERROR("unsupported operand + for %s and %s", value_type(peek(vm, 0)), value_type(peek(vm, 1)));
             break;
           }
         } else if (IS_LIST(peek(vm, 0)) && IS_LIST(peek(vm, 1))) {
@@ -1472,15 +2436,17 @@ b_ptr_result run(b_vm *vm) {
           pop_n(vm, 2);
           push(vm, result);
         } else {
-          BINARY_OP(NUMBER_VAL, +);
+          QUICKEN(OP_ADD_NUM);
+          ARITHMETIC_OP(add_numbers, +);
         }
-        break;
+        DISPATCH();
       }
-      case OP_SUBTRACT: {
-        BINARY_OP(NUMBER_VAL, -);
-        break;
+      CASE(OP_SUBTRACT) {
+        QUICKEN(OP_SUBTRACT_NUM);
+        ARITHMETIC_OP(subtract_numbers, -);
+        DISPATCH();
       }
-      case OP_MULTIPLY: {
+      CASE(OP_MULTIPLY) {
         if (IS_STRING(peek(vm, 1)) && IS_NUMBER(peek(vm, 0))) {
           double number = AS_NUMBER(peek(vm, 0));
           b_obj_string *string = AS_STRING(peek(vm, 1));
@@ -1498,117 +2464,127 @@ b_ptr_result run(b_vm *vm) {
           push(vm, OBJ_VAL(n_list));
           break;
         }
-        BINARY_OP(NUMBER_VAL, *);
-        break;
+        QUICKEN(OP_MULTIPLY_NUM);
+        ARITHMETIC_OP(multiply_numbers, *);
+        DISPATCH();
       }
-      case OP_DIVIDE: {
+      CASE(OP_DIVIDE) {
+        QUICKEN(OP_DIVIDE_NUM);
         BINARY_OP(NUMBER_VAL, /);
-        break;
+        DISPATCH();
       }
-      case OP_REMINDER: {
+      CASE(OP_REMINDER) {
         BINARY_MOD_OP(NUMBER_VAL, modulo);
-        break;
+        DISPATCH();
       }
-      case OP_POW: {
+      CASE(OP_POW) {
         BINARY_MOD_OP(NUMBER_VAL, pow);
-        break;
+        DISPATCH();
       }
-      case OP_F_DIVIDE: {
+      CASE(OP_F_DIVIDE) {
         BINARY_MOD_OP(NUMBER_VAL, floor_div);
-        break;
+        DISPATCH();
       }
-      case OP_NEGATE: {
+      CASE(OP_NEGATE) {
         if (!IS_NUMBER(peek(vm, 0))) {
-          runtime_error("operator - not defined for object of type %s", value_type(peek(vm, 0)));
+          RUNTIME_ERROR("operator - not defined for object of type %s", value_type(peek(vm, 0)));
           break;
         }
-        push(vm, NUMBER_VAL(-AS_NUMBER(pop(vm))));
-        break;
+        push(vm, negate_number(pop(vm)));
+        DISPATCH();
       }
-      case OP_BIT_NOT: {
+      CASE(OP_BIT_NOT) {
         if (!IS_NUMBER(peek(vm, 0))) {
-          runtime_error("operator ~ not defined for object of type %s", value_type(peek(vm, 0)));
+          RUNTIME_ERROR("operator ~ not defined for object of type %s", value_type(peek(vm, 0)));
           break;
         }
         push(vm, INTEGER_VAL(~((int) AS_NUMBER(pop(vm)))));
-        break;
+        DISPATCH();
       }
-      case OP_AND: {
+      CASE(OP_AND) {
         BINARY_BIT_OP(&);
-        break;
+        DISPATCH();
       }
-      case OP_OR: {
+      CASE(OP_OR) {
         BINARY_BIT_OP(|);
-        break;
+        DISPATCH();
       }
-      case OP_XOR: {
+      CASE(OP_XOR) {
         BINARY_BIT_OP(^);
-        break;
+        DISPATCH();
       }
-      case OP_LSHIFT: {
+      CASE(OP_LSHIFT) {
         BINARY_BIT_OP(<<);
-        break;
+        DISPATCH();
       }
-      case OP_RSHIFT: {
+      CASE(OP_RSHIFT) {
         BINARY_BIT_OP(>>);
-        break;
+        DISPATCH();
       }
-      case OP_ONE: {
-        push(vm, NUMBER_VAL(1));
-        break;
+      CASE(OP_ONE) {
+        push(vm, INTEGER_VAL(1));
+        DISPATCH();
       }
 
         // comparisons
-      case OP_EQUAL: {
+      CASE(OP_EQUAL) {
         b_value b = pop(vm);
         b_value a = pop(vm);
         push(vm, BOOL_VAL(values_equal(a, b)));
-        break;
+        DISPATCH();
       }
-      case OP_GREATER: {
+      CASE(OP_GREATER) {
+        QUICKEN(OP_GREATER_NUM);
         BINARY_OP(BOOL_VAL, >);
-        break;
+        DISPATCH();
       }
-      case OP_LESS: {
+      CASE(OP_LESS) {
+        QUICKEN(OP_LESS_NUM);
         BINARY_OP(BOOL_VAL, <);
-        break;
+        DISPATCH();
       }
 
-      case OP_NOT:
+      CASE(OP_NOT)
         push(vm, BOOL_VAL(is_false(pop(vm))));
-        break;
-      case OP_NIL:
+        DISPATCH();
+      CASE(OP_NIL)
         push(vm, NIL_VAL);
-        break;
-      case OP_EMPTY:
+        DISPATCH();
+      CASE(OP_EMPTY)
         push(vm, EMPTY_VAL);
-        break;
-      case OP_TRUE:
+        DISPATCH();
+      CASE(OP_TRUE)
         push(vm, BOOL_VAL(true));
-        break;
-      case OP_FALSE:
+        DISPATCH();
+      CASE(OP_FALSE)
         push(vm, BOOL_VAL(false));
         break;
 
-      case OP_JUMP: {
+      CASE(OP_JUMP) {
         uint16_t offset = READ_SHORT();
-        vm->current_frame->ip += offset;
-        break;
+        ip += offset;
+        DISPATCH();
       }
-      case OP_JUMP_IF_FALSE: {
+      CASE(OP_JUMP_IF_FALSE) {
         uint16_t offset = READ_SHORT();
         if (is_false(peek(vm, 0))) {
-          vm->current_frame->ip += offset;
+          ip += offset;
         }
-        break;
+        DISPATCH();
       }
-      case OP_LOOP: {
+      CASE(OP_LOOP) {
         uint16_t offset = READ_SHORT();
-        vm->current_frame->ip -= offset;
-        break;
+        ip -= offset;
+
+        if (vm->should_jit && jit_is_hot(vm, frame->closure->function)) {
+          STORE_FRAME();
+          jit_run(vm, frame);
+          LOAD_FRAME();
+        }
+        DISPATCH();
       }
 
-      case OP_ECHO: {
+      CASE(OP_ECHO) {
         b_value val = peek(vm, 0);
         if (vm->is_repl) {
           echo_value(val);
@@ -1619,10 +2595,10 @@ b_ptr_result run(b_vm *vm) {
           printf("\n");
         }
         pop(vm);
-        break;
+        DISPATCH();
       }
 
-      case OP_STRINGIFY: {
+      CASE(OP_STRINGIFY) {
         if (!IS_STRING(peek(vm, 0)) && !IS_NIL(peek(vm, 0))) {
           b_obj_string *value = value_to_string(vm, pop(vm));
           if (value->length != 0) {
@@ -1631,88 +2607,110 @@ b_ptr_result run(b_vm *vm) {
             push(vm, NIL_VAL);
           }
         }
-        break;
+        DISPATCH();
       }
 
-      case OP_DUP: {
+      CASE(OP_DUP) {
         push(vm, peek(vm, 0));
-        break;
+        DISPATCH();
       }
-      case OP_POP: {
+      CASE(OP_POP) {
         pop(vm);
-        break;
+        DISPATCH();
       }
-      case OP_POP_N: {
+      CASE(OP_POP_N) {
         pop_n(vm, READ_SHORT());
-        break;
+        DISPATCH();
       }
-      case OP_CLOSE_UP_VALUE: {
+      CASE(OP_CLOSE_UP_VALUE) {
         close_up_values(vm, vm->stack_top - 1);
         pop(vm);
-        break;
+        DISPATCH();
       }
 
-      case OP_DEFINE_GLOBAL: {
+      CASE(OP_DEFINE_GLOBAL) {
         b_obj_string *name = READ_STRING();
+        uint16_t slot = READ_SHORT();
         if(IS_EMPTY(peek(vm, 0))) {
-          runtime_error(ERR_CANT_ASSIGN_EMPTY);
+          RUNTIME_ERROR(ERR_CANT_ASSIGN_EMPTY);
           break;
         }
-        table_set(vm, &vm->current_frame->closure->function->module->values, OBJ_VAL(name), peek(vm, 0));
+        b_obj_module *module = frame->closure->function->module;
+        b_entry *entry = find_global_entry(module, slot, name);
+        if (entry != NULL) {
+          entry->value = peek(vm, 0);
+        } else {
+          table_set(vm, &module->values, OBJ_VAL(name), peek(vm, 0));
+          write_barrier(vm, &module->obj, OBJ_VAL(name));
+        }
+        write_barrier(vm, &module->obj, peek(vm, 0));
         pop(vm);
 
 #if defined(DEBUG_TABLE) && DEBUG_TABLE
         table_print(&vm->globals);
 #endif
-        break;
+        DISPATCH();
       }
 
-      case OP_GET_GLOBAL: {
+      CASE(OP_GET_GLOBAL) {
         b_obj_string *name = READ_STRING();
+        uint16_t slot = READ_SHORT();
+        b_entry *entry = find_global_entry(frame->closure->function->module, slot, name);
+        if (entry != NULL) {
+          push(vm, entry->value);
+          DISPATCH();
+        }
+
         b_value value;
-        if (!table_get(&vm->current_frame->closure->function->module->values, OBJ_VAL(name), &value)) {
-          if (!table_get(&vm->globals, OBJ_VAL(name), &value)) {
-            runtime_error("'%s' is undefined in this scope", name->chars);
-            break;
-          }
+        if (!table_get(&vm->globals, OBJ_VAL(name), &value)) {
+          RUNTIME_ERROR("'%s' is undefined in this scope", name->chars);
+          break;
         }
         push(vm, value);
-        break;
+        DISPATCH();
       }
 
-      case OP_SET_GLOBAL: {
+      CASE(OP_SET_GLOBAL) {
         if(IS_EMPTY(peek(vm, 0))) {
-          runtime_error(ERR_CANT_ASSIGN_EMPTY);
+          RUNTIME_ERROR(ERR_CANT_ASSIGN_EMPTY);
           break;
         }
 
         b_obj_string *name = READ_STRING();
-        b_table *table = &vm->current_frame->closure->function->module->values;
-        if (table_set(vm, table, OBJ_VAL(name), peek(vm, 0))) {
-          table_delete(table, OBJ_VAL(name));
-          runtime_error("%s is undefined in this scope", name->chars);
+        uint16_t slot = READ_SHORT();
+        b_obj_module *module = frame->closure->function->module;
+        b_entry *entry = find_global_entry(module, slot, name);
+        if (entry == NULL) {
+          RUNTIME_ERROR("%s is undefined in this scope", name->chars);
           break;
         }
-        break;
+        entry->value = peek(vm, 0);
+        write_barrier(vm, &module->obj, entry->value);
+        DISPATCH();
       }
 
-      case OP_GET_LOCAL: {
+      CASE(OP_GET_LOCAL) {
         uint16_t slot = READ_SHORT();
-        push(vm, vm->current_frame->slots[slot]);
-        break;
+        push(vm, frame->slots[slot]);
+        DISPATCH();
       }
-      case OP_SET_LOCAL: {
+      CASE(OP_SET_LOCAL) {
         uint16_t slot = READ_SHORT();
         if(IS_EMPTY(peek(vm, 0))) {
-          runtime_error(ERR_CANT_ASSIGN_EMPTY);
+          RUNTIME_ERROR(ERR_CANT_ASSIGN_EMPTY);
           break;
         }
-        vm->current_frame->slots[slot] = peek(vm, 0);
-        break;
+        frame->slots[slot] = peek(vm, 0);
+        DISPATCH();
       }
 
-      case OP_GET_PROPERTY: {
+      CASE(OP_GET_PROPERTY) {
         b_obj_string *name = READ_STRING();
+        b_inline_cache *cache = READ_CACHE();
+
+        if (IS_INSTANCE(peek(vm, 0)) && get_cached_property(vm, AS_INSTANCE(peek(vm, 0)), cache)) {
+          DISPATCH();
+        }
 
         if (IS_OBJ(peek(vm, 0))) {
           b_value value;
@@ -1722,7 +2720,7 @@ b_ptr_result run(b_vm *vm) {
               b_obj_module *module = AS_MODULE(peek(vm, 0));
               if (table_get(&module->values, OBJ_VAL(name), &value)) {
                 if (name->length > 0 && name->chars[0] == '_') {
-                  runtime_error("cannot get private module property '%s'", name->chars);
+                  RUNTIME_ERROR("cannot get private module property '%s'", name->chars);
                   break;
                 }
 
@@ -1731,14 +2729,14 @@ b_ptr_result run(b_vm *vm) {
                 break;
               }
 
-              runtime_error("%s module does not define '%s'", module->name, name->chars);
+              RUNTIME_ERROR("%s module does not define '%s'", module->name, name->chars);
               break;
             }
             case OBJ_CLASS: {
               if (table_get(&AS_CLASS(peek(vm, 0))->methods, OBJ_VAL(name), &value)) {
                 if (get_method_type(value) == TYPE_STATIC) {
                   if (name->length > 0 && name->chars[0] == '_') {
-                    runtime_error("cannot call private property '%s' of class %s",
+                    RUNTIME_ERROR("cannot call private property '%s' of class %s",
                                   name->chars, AS_CLASS(peek(vm, 0))->name->chars);
                     break;
                   }
@@ -1748,7 +2746,7 @@ b_ptr_result run(b_vm *vm) {
                 }
               } else if (table_get(&AS_CLASS(peek(vm, 0))->static_properties, OBJ_VAL(name), &value)) {
                 if (name->length > 0 && name->chars[0] == '_') {
-                  runtime_error("cannot call private property '%s' of class %s",
+                  RUNTIME_ERROR("cannot call private property '%s' of class %s",
                                 name->chars, AS_CLASS(peek(vm, 0))->name->chars);
                   break;
                 }
@@ -1757,34 +2755,44 @@ b_ptr_result run(b_vm *vm) {
                 break;
               }
 
-              runtime_error("class %s does not have a static property or method named '%s'",
+              RUNTIME_ERROR("class %s does not have a static property or method named '%s'",
                             AS_CLASS(peek(vm, 0))->name->chars, name->chars);
               break;
             }
             case OBJ_INSTANCE: {
               b_obj_instance *instance = AS_INSTANCE(peek(vm, 0));
-              if (table_get(&instance->properties, OBJ_VAL(name), &value)) {
+              if (instance_get_field(instance, OBJ_VAL(name), &value)) {
                 if (name->length > 0 && name->chars[0] == '_') {
-                  runtime_error("cannot call private property '%s' from instance of %s",
+                  RUNTIME_ERROR("cannot call private property '%s' from instance of %s",
                                 name->chars, instance->klass->name->chars);
                   break;
                 }
+                if (instance->shape != NULL) {
+                  update_inline_cache(vm, cache, instance->klass, instance->shape,
+                                      shape_find_slot(instance->shape, OBJ_VAL(name)), NIL_VAL);
+                }
                 pop(vm); // pop the instance...
                 push(vm, value);
                 break;
               }
 
               if (name->length > 0 && name->chars[0] == '_') {
-                runtime_error("cannot bind private property '%s' to instance of %s",
+                RUNTIME_ERROR("cannot bind private property '%s' to instance of %s",
                               name->chars, instance->klass->name->chars);
                 break;
               }
 
+              STORE_FRAME();
               if (bind_method(vm, instance->klass, name)) {
+                LOAD_FRAME();
+                if (IS_BOUND(peek(vm, 0)) && instance->shape != NULL) {
+                  update_inline_cache(vm, cache, instance->klass, instance->shape, -1,
+                                      OBJ_VAL(AS_BOUND(peek(vm, 0))->method));
+                }
                 break;
               }
 
-              runtime_error("instance of class %s does not have a property or method named '%s'",
+              RUNTIME_ERROR("instance of class %s does not have a property or method named '%s'",
                             AS_INSTANCE(peek(vm, 0))->klass->name->chars, name->chars);
               break;
             }
@@ -1795,7 +2803,7 @@ b_ptr_result run(b_vm *vm) {
                 break;
               }
 
-              runtime_error("class String has no named property '%s'", name->chars);
+              RUNTIME_ERROR("class String has no named property '%s'", name->chars);
               break;
             }
             case OBJ_LIST: {
@@ -1805,7 +2813,7 @@ b_ptr_result run(b_vm *vm) {
                 break;
               }
 
-              runtime_error("class List has no named property '%s'", name->chars);
+              RUNTIME_ERROR("class List has no named property '%s'", name->chars);
               break;
             }
             case OBJ_RANGE: {
@@ -1815,7 +2823,7 @@ b_ptr_result run(b_vm *vm) {
                 break;
               }
 
-              runtime_error("class Range has no named property '%s'", name->chars);
+              RUNTIME_ERROR("class Range has no named property '%s'", name->chars);
               break;
             }
             case OBJ_DICT: {
@@ -1826,7 +2834,7 @@ b_ptr_result run(b_vm *vm) {
                 break;
               }
 
-              runtime_error("unknown key or class Dict property '%s'", name->chars);
+              RUNTIME_ERROR("unknown key or class Dict property '%s'", name->chars);
               break;
             }
             case OBJ_BYTES: {
@@ -1836,7 +2844,17 @@ b_ptr_result run(b_vm *vm) {
                 break;
               }
 
-              runtime_error("class Bytes has no named property '%s'", name->chars);
+              RUNTIME_ERROR("class Bytes has no named property '%s'", name->chars);
+              break;
+            }
+            case OBJ_FIBER: {
+              if (table_get(&vm->methods_fiber, OBJ_VAL(name), &value)) {
+                pop(vm); // pop the fiber...
+                push(vm, value);
+                break;
+              }
+
+              RUNTIME_ERROR("class Fiber has no named property '%s'", name->chars);
               break;
             }
             case OBJ_FILE: {
@@ -1846,38 +2864,53 @@ b_ptr_result run(b_vm *vm) {
                 break;
               }
 
-              runtime_error("class File has no named property '%s'", name->chars);
+              RUNTIME_ERROR("class File has no named property '%s'", name->chars);
               break;
             }
             default: {
-              runtime_error("object of type %s does not carry properties", value_type(peek(vm, 0)));
+              RUNTIME_ERROR("object of type %s does not carry properties", value_type(peek(vm, 0)));
               break;
             }
           }
         } else {
-          runtime_error("'%s' of type %s does not have properties", value_to_string(vm, peek(vm, 0))->chars, value_type(peek(vm, 0)));
+          RUNTIME_ERROR("'%s' of type %s does not have properties", value_to_string(vm, peek(vm, 0))->chars, value_type(peek(vm, 0)));
           break;
         }
-        break;
+        DISPATCH();
       }
 
-      case OP_GET_SELF_PROPERTY: {
+      CASE(OP_GET_SELF_PROPERTY) {
         b_obj_string *name = READ_STRING();
+        b_inline_cache *cache = READ_CACHE();
         b_value value;
 
         if (IS_INSTANCE(peek(vm, 0))) {
           b_obj_instance *instance = AS_INSTANCE(peek(vm, 0));
-          if (table_get(&instance->properties, OBJ_VAL(name), &value)) {
+          if (get_cached_property(vm, instance, cache)) {
+            DISPATCH();
+          }
+
+          if (instance_get_field(instance, OBJ_VAL(name), &value)) {
+            if (instance->shape != NULL) {
+              update_inline_cache(vm, cache, instance->klass, instance->shape,
+                                  shape_find_slot(instance->shape, OBJ_VAL(name)), NIL_VAL);
+            }
             pop(vm); // pop the instance...
             push(vm, value);
             break;
           }
 
+          STORE_FRAME();
           if (bind_method(vm, instance->klass, name)) {
+            LOAD_FRAME();
+            if (IS_BOUND(peek(vm, 0)) && instance->shape != NULL) {
+              update_inline_cache(vm, cache, instance->klass, instance->shape, -1,
+                                  OBJ_VAL(AS_BOUND(peek(vm, 0))->method));
+            }
             break;
           }
 
-          runtime_error("instance of class %s does not have a property or method named '%s'",
+          RUNTIME_ERROR("instance of class %s does not have a property or method named '%s'",
                         AS_INSTANCE(peek(vm, 0))->klass->name->chars, name->chars);
           break;
         } else if (IS_CLASS(peek(vm, 0))) {
@@ -1893,7 +2926,7 @@ b_ptr_result run(b_vm *vm) {
             push(vm, value);
             break;
           }
-          runtime_error("class %s does not have a static property or method named '%s'",
+          RUNTIME_ERROR("class %s does not have a static property or method named '%s'",
                         klass->name->chars, name->chars);
           break;
         } else if (IS_MODULE(peek(vm, 0))) {
@@ -1904,20 +2937,20 @@ b_ptr_result run(b_vm *vm) {
             break;
           }
 
-          runtime_error("module %s does not define '%s'", module->name, name->chars);
+          RUNTIME_ERROR("module %s does not define '%s'", module->name, name->chars);
           break;
         }
 
-        runtime_error("'%s' of type %s does not have properties", value_to_string(vm, peek(vm, 0))->chars, value_type(peek(vm, 0)));
-        break;
+        RUNTIME_ERROR("'%s' of type %s does not have properties", value_to_string(vm, peek(vm, 0))->chars, value_type(peek(vm, 0)));
+        DISPATCH();
       }
 
-      case OP_SET_PROPERTY: {
+      CASE(OP_SET_PROPERTY) {
         if (!IS_INSTANCE(peek(vm, 1)) && !IS_DICT(peek(vm, 1))) {
-          runtime_error("object of type %s can not carry properties", value_type(peek(vm, 1)));
+          RUNTIME_ERROR("object of type %s can not carry properties", value_type(peek(vm, 1)));
           break;
         } else  if(IS_EMPTY(peek(vm, 0))) {
-          runtime_error(ERR_CANT_ASSIGN_EMPTY);
+          RUNTIME_ERROR(ERR_CANT_ASSIGN_EMPTY);
           break;
         }
 
@@ -1925,7 +2958,7 @@ b_ptr_result run(b_vm *vm) {
 
         if (IS_INSTANCE(peek(vm, 1))) {
           b_obj_instance *instance = AS_INSTANCE(peek(vm, 1));
-          table_set(vm, &instance->properties, OBJ_VAL(name), peek(vm, 0));
+          instance_set_field(vm, instance, OBJ_VAL(name), peek(vm, 0));
 
           b_value value = pop(vm);
           pop(vm); // removing the instance object
@@ -1938,10 +2971,10 @@ b_ptr_result run(b_vm *vm) {
           pop(vm); // removing the dictionary object
           push(vm, value);
         }
-        break;
+        DISPATCH();
       }
 
-      case OP_CLOSURE: {
+      CASE(OP_CLOSURE) {
         b_obj_func *function = AS_FUNCTION(READ_CONSTANT());
         b_obj_closure *closure = new_closure(vm, function);
         push(vm, OBJ_VAL(closure));
@@ -1951,77 +2984,112 @@ b_ptr_result run(b_vm *vm) {
           int index = READ_SHORT();
 
           if (is_local) {
-            closure->up_values[i] = capture_up_value(vm, vm->current_frame->slots + index);
+            // a closure sees __args__ as a list.
+            if (IS_EMPTY(frame->slots[index]) && index == frame->closure->function->arity
+                && frame->closure->function->is_variadic) {
+              materialize_args(vm, frame);
+            }
+            closure->up_values[i] = capture_up_value(vm, frame->slots + index);
           } else {
             closure->up_values[i] =
-                ((b_obj_closure *) vm->current_frame->closure)->up_values[index];
+                ((b_obj_closure *) frame->closure)->up_values[index];
           }
+          // capturing can collect and promote the closure.
+          write_barrier(vm, &closure->obj, OBJ_VAL(closure->up_values[i]));
         }
 
-        break;
+        DISPATCH();
       }
-      case OP_GET_UP_VALUE: {
+      CASE(OP_GET_UP_VALUE) {
         int index = READ_SHORT();
-        push(vm, *((b_obj_closure *) vm->current_frame->closure)->up_values[index]->location);
-        break;
+        push(vm, *((b_obj_closure *) frame->closure)->up_values[index]->location);
+        DISPATCH();
       }
-      case OP_SET_UP_VALUE: {
+      CASE(OP_SET_UP_VALUE) {
         int index = READ_SHORT();
         if(IS_EMPTY(peek(vm, 0))) {
-          runtime_error(ERR_CANT_ASSIGN_EMPTY);
+          RUNTIME_ERROR(ERR_CANT_ASSIGN_EMPTY);
           break;
         }
-        *((b_obj_closure *) vm->current_frame->closure)->up_values[index]->location =
-            peek(vm, 0);
-        break;
+        b_obj_up_value *up_value = ((b_obj_closure *) frame->closure)->up_values[index];
+        *up_value->location = peek(vm, 0);
+        up_value_barrier(vm, up_value);
+        DISPATCH();
       }
 
-      case OP_CALL: {
+      CASE(OP_CALL) {
         int arg_count = READ_BYTE();
+        STORE_FRAME();
         if (!call_value(vm, peek(vm, arg_count), arg_count)) {
           EXIT_VM();
         }
-        vm->current_frame = &vm->frames[vm->frame_count - 1];
-        break;
+        LOAD_FRAME();
+        DISPATCH();
+      }
+      CASE(OP_TAIL_CALL) {
+        int arg_count = READ_BYTE();
+        b_value callee = peek(vm, arg_count);
+        STORE_FRAME();
+
+        // a function called in tail position takes over the frame of the
+        // caller. whatever else is called runs like a normal call before the
+        // OP_RETURN after it.
+        if (IS_CLOSURE(callee) || IS_BOUND(callee)) {
+          b_value *base = frame->slots - frame->va_count;
+          close_up_values(vm, frame->slots);
+          memmove(base, vm->stack_top - arg_count - 1, sizeof(b_value) * (arg_count + 1));
+          vm->stack_top = base + arg_count + 1;
+          vm->frame_count--;
+        }
+
+        if (!call_value(vm, callee, arg_count)) {
+          EXIT_VM();
+        }
+        LOAD_FRAME();
+        DISPATCH();
       }
-      case OP_INVOKE: {
+      CASE(OP_INVOKE) {
         b_obj_string *method = READ_STRING();
         int arg_count = READ_BYTE();
-        if (!invoke(vm, method, arg_count)) {
+        b_inline_cache *cache = READ_CACHE();
+        STORE_FRAME();
+        if (!invoke_cached(vm, method, arg_count, cache)) {
           EXIT_VM();
         }
-        vm->current_frame = &vm->frames[vm->frame_count - 1];
-        break;
+        LOAD_FRAME();
+        DISPATCH();
       }
-      case OP_INVOKE_SELF: {
+      CASE(OP_INVOKE_SELF) {
         b_obj_string *method = READ_STRING();
         int arg_count = READ_BYTE();
-        if (!invoke_self(vm, method, arg_count)) {
+        b_inline_cache *cache = READ_CACHE();
+        STORE_FRAME();
+        if (!invoke_self_cached(vm, method, arg_count, cache)) {
           EXIT_VM();
         }
-        vm->current_frame = &vm->frames[vm->frame_count - 1];
-        break;
+        LOAD_FRAME();
+        DISPATCH();
       }
 
-      case OP_CLASS: {
+      CASE(OP_CLASS) {
         b_obj_string *name = READ_STRING();
         push(vm, OBJ_VAL(new_class(vm, name)));
-        break;
+        DISPATCH();
       }
-      case OP_METHOD: {
+      CASE(OP_METHOD) {
         b_obj_string *name = READ_STRING();
         define_method(vm, name);
-        break;
+        DISPATCH();
       }
-      case OP_CLASS_PROPERTY: {
+      CASE(OP_CLASS_PROPERTY) {
         b_obj_string *name = READ_STRING();
         int is_static = READ_BYTE();
         define_property(vm, name, is_static == 1);
-        break;
+        DISPATCH();
       }
-      case OP_INHERIT: {
+      CASE(OP_INHERIT) {
         if (!IS_CLASS(peek(vm, 1))) {
-          runtime_error("cannot inherit from non-class object");
+          RUNTIME_ERROR("cannot inherit from non-class object");
           break;
         }
 
@@ -2029,39 +3097,54 @@ b_ptr_result run(b_vm *vm) {
         b_obj_class *subclass = AS_CLASS(peek(vm, 0));
         table_add_all(vm, &superclass->properties, &subclass->properties);
         table_add_all(vm, &superclass->methods, &subclass->methods);
+
+        b_obj_class **supers = ALLOCATE(b_obj_class *, superclass->depth + 1);
+        if (superclass->depth > 0) {
+          memcpy(supers, superclass->supers, sizeof(b_obj_class *) * superclass->depth);
+        }
+        supers[superclass->depth] = superclass;
+        subclass->supers = supers;
+        subclass->depth = superclass->depth + 1;
         subclass->superclass = superclass;
+        write_barrier_all(vm, &subclass->obj);
+        subclass->version++;
         pop(vm); // pop the subclass
-        break;
+        DISPATCH();
       }
-      case OP_GET_SUPER: {
+      CASE(OP_GET_SUPER) {
         b_obj_string *name = READ_STRING();
         b_obj_class *klass = AS_CLASS(peek(vm, 0));
+        STORE_FRAME();
         if (!bind_method(vm, klass->superclass, name)) {
-          runtime_error("class %s does not define a function %s", klass->name->chars, name->chars);
+          RUNTIME_ERROR("class %s does not define a function %s", klass->name->chars, name->chars);
         }
-        break;
+        LOAD_FRAME();
+        DISPATCH();
       }
-      case OP_SUPER_INVOKE: {
+      CASE(OP_SUPER_INVOKE) {
         b_obj_string *method = READ_STRING();
         int arg_count = READ_BYTE();
+        b_inline_cache *cache = READ_CACHE();
         b_obj_class *klass = AS_CLASS(pop(vm));
-        if (!invoke_from_class(vm, klass, method, arg_count)) {
+        STORE_FRAME();
+        if (!invoke_from_class_cached(vm, klass, method, arg_count, cache)) {
           EXIT_VM();
         }
-        vm->current_frame = &vm->frames[vm->frame_count - 1];
-        break;
+        LOAD_FRAME();
+        DISPATCH();
       }
-      case OP_SUPER_INVOKE_SELF: {
+      CASE(OP_SUPER_INVOKE_SELF) {
         int arg_count = READ_BYTE();
         b_obj_class *klass = AS_CLASS(pop(vm));
+        STORE_FRAME();
         if (!invoke_from_class(vm, klass, klass->name, arg_count)) {
           EXIT_VM();
         }
-        vm->current_frame = &vm->frames[vm->frame_count - 1];
-        break;
+        LOAD_FRAME();
+        DISPATCH();
       }
 
-      case OP_LIST: {
+      CASE(OP_LIST) {
         int count = READ_SHORT();
         b_obj_list *list = new_list(vm);
         vm->stack_top[-count - 1] = OBJ_VAL(list);
@@ -2070,22 +3153,22 @@ b_ptr_result run(b_vm *vm) {
           write_list(vm, list, peek(vm, i));
         }
         pop_n(vm, count);
-        break;
+        DISPATCH();
       }
-      case OP_RANGE: {
+      CASE(OP_RANGE) {
         b_value _upper = peek(vm, 0), _lower = peek(vm, 1);
 
         if (!IS_NUMBER(_upper) || !IS_NUMBER(_lower)) {
-          runtime_error("invalid range boundaries");
+          RUNTIME_ERROR("invalid range boundaries");
           break;
         }
 
-        double lower = AS_NUMBER(_lower), upper = AS_NUMBER(_upper);
+        int lower = index_value(_lower), upper = index_value(_upper);
         pop_n(vm, 2);
         push(vm, OBJ_VAL(new_range(vm, lower, upper)));
-        break;
+        DISPATCH();
       }
-      case OP_DICT: {
+      CASE(OP_DICT) {
         int count = READ_SHORT() * 2; // 1 for key, 1 for value
         b_obj_dict *dict = new_dict(vm);
         vm->stack_top[-count - 1] = OBJ_VAL(dict);
@@ -2093,18 +3176,19 @@ b_ptr_result run(b_vm *vm) {
         for (int i = 0; i < count; i += 2) {
           b_value name = vm->stack_top[-count + i];
           if(!IS_STRING(name) && !IS_NUMBER(name) && !IS_BOOL(name)) {
-            runtime_error("dictionary key must be one of string, number or boolean");
+            RUNTIME_ERROR("dictionary key must be one of string, number or boolean");
           }
           b_value value = vm->stack_top[-count + i + 1];
           dict_set_entry(vm, dict, name, value);
         }
         pop_n(vm, count);
-        break;
+        DISPATCH();
       }
 
-      case OP_GET_RANGED_INDEX: {
+      CASE(OP_GET_RANGED_INDEX) {
         uint8_t will_assign = READ_BYTE();
 
+        STORE_FRAME();
         bool is_gotten = true;
         if (IS_OBJ(peek(vm, 2))) {
           switch (AS_OBJ(peek(vm, 2))->type) {
@@ -2135,14 +3219,16 @@ b_ptr_result run(b_vm *vm) {
           is_gotten = false;
         }
 
+        LOAD_FRAME();
         if (!is_gotten) {
-          runtime_error("cannot range index object of type %s", value_type(peek(vm, 2)));
+          RUNTIME_ERROR("cannot range index object of type %s", value_type(peek(vm, 2)));
         }
-        break;
+        DISPATCH();
       }
-      case OP_GET_INDEX: {
+      CASE(OP_GET_INDEX) {
         uint8_t will_assign = READ_BYTE();
 
+        STORE_FRAME();
         bool is_gotten = true;
         if (IS_OBJ(peek(vm, 1))) {
           switch (AS_OBJ(peek(vm, 1))->type) {
@@ -2181,17 +3267,24 @@ b_ptr_result run(b_vm *vm) {
               break;
             }
           }
+        } else if (IS_EMPTY(peek(vm, 1))) {
+          // only __args__ is ever indexed while EMPTY.
+          if (!args_get_index(vm, frame)) {
+            EXIT_VM();
+          }
         } else {
           is_gotten = false;
         }
 
+        LOAD_FRAME();
         if (!is_gotten) {
-          runtime_error("cannot index object of type %s", value_type(peek(vm, 1)));
+          RUNTIME_ERROR("cannot index object of type %s", value_type(peek(vm, 1)));
         }
-        break;
+        DISPATCH();
       }
 
-      case OP_SET_INDEX: {
+      CASE(OP_SET_INDEX) {
+        STORE_FRAME();
         bool is_set = true;
         if (IS_OBJ(peek(vm, 2))) {
 
@@ -2199,7 +3292,7 @@ b_ptr_result run(b_vm *vm) {
           b_value index = peek(vm, 1);
 
           if(IS_EMPTY(value)) {
-            runtime_error(ERR_CANT_ASSIGN_EMPTY);
+            RUNTIME_ERROR(ERR_CANT_ASSIGN_EMPTY);
             break;
           }
 
@@ -2211,7 +3304,7 @@ b_ptr_result run(b_vm *vm) {
               break;
             }
             case OBJ_STRING: {
-              runtime_error("strings do not support object assignment");
+              RUNTIME_ERROR("strings do not support object assignment");
               break;
             }
             case OBJ_DICT: {
@@ -2237,67 +3330,82 @@ b_ptr_result run(b_vm *vm) {
           is_set = false;
         }
 
+        LOAD_FRAME();
         if (!is_set) {
-          runtime_error("type of %s is not a valid iterable", value_type(peek(vm, 3)));
+          RUNTIME_ERROR("type of %s is not a valid iterable", value_type(peek(vm, 3)));
         }
-        break;
+        DISPATCH();
       }
 
-      case OP_RETURN: {
+      CASE(OP_RETURN) {
         b_value result = pop(vm);
 
-        close_up_values(vm, vm->current_frame->slots);
+        close_up_values(vm, frame->slots);
 
         vm->frame_count--;
         if (vm->frame_count == 0) {
-          pop(vm);
-          return PTR_OK;
+          if (vm->fiber == NULL) {
+            pop(vm);
+            return PTR_OK;
+          }
+          // resume() gives nil for a fiber that ends without a value.
+          leave_fiber(vm, FIBER_DONE, IS_EMPTY(result) ? NIL_VAL : result);
+        } else {
+          vm->stack_top = frame->slots - frame->va_count;
+          push(vm, result);
         }
 
-        vm->stack_top = vm->current_frame->slots;
-        push(vm, result);
+        LOAD_FRAME();
 
-        vm->current_frame = &vm->frames[vm->frame_count - 1];
-        break;
+        // go back to native code if the caller came from there.
+        if (frame->closure->function->jit != NULL) {
+          jit_run(vm, frame);
+          LOAD_FRAME();
+        }
+        DISPATCH();
       }
 
-      case OP_CALL_IMPORT: {
+      CASE(OP_CALL_IMPORT) {
         b_obj_closure *closure = AS_CLOSURE(READ_CONSTANT());
         add_module(vm, closure->function->module);
+        write_barrier_all(vm, &frame->closure->function->module->obj);
+        STORE_FRAME();
         call(vm, closure, 0);
-        vm->current_frame = &vm->frames[vm->frame_count - 1];
-        break;
+        LOAD_FRAME();
+        DISPATCH();
       }
 
-      case OP_NATIVE_MODULE: {
+      CASE(OP_NATIVE_MODULE) {
         b_obj_string *module_name = READ_STRING();
         b_value value;
         if (table_get(&vm->modules, OBJ_VAL(module_name), &value)) {
           b_obj_module *module = AS_MODULE(value);
           if(module->preloader != NULL) {
-            ((b_module_loader)module->preloader)(vm);
+            call_module_loader(vm, (b_module_loader)module->preloader);
           }
           module->imported = true;
-          table_set(vm, &vm->current_frame->closure->function->module->values, OBJ_VAL(module_name), value);
+          table_set(vm, &frame->closure->function->module->values, OBJ_VAL(module_name), value);
+          write_barrier_all(vm, &frame->closure->function->module->obj);
           break;
         }
-        runtime_error("module '%s' not found", module_name->chars);
-        break;
+        RUNTIME_ERROR("module '%s' not found", module_name->chars);
+        DISPATCH();
       }
 
-      case OP_SELECT_IMPORT: {
+      CASE(OP_SELECT_IMPORT) {
         b_obj_string *entry_name = READ_STRING();
         b_obj_func *function = AS_CLOSURE(peek(vm, 0))->function;
         b_value value;
         if (table_get(&function->module->values, OBJ_VAL(entry_name), &value)) {
-          table_set(vm, &vm->current_frame->closure->function->module->values, OBJ_VAL(entry_name), value);
+          table_set(vm, &frame->closure->function->module->values, OBJ_VAL(entry_name), value);
+          write_barrier_all(vm, &frame->closure->function->module->obj);
         } else {
-          runtime_error("module %s does not define '%s'", function->module->name, entry_name->chars);
+          RUNTIME_ERROR("module %s does not define '%s'", function->module->name, entry_name->chars);
         }
-        break;
+        DISPATCH();
       }
 
-      case OP_SELECT_NATIVE_IMPORT: {
+      CASE(OP_SELECT_NATIVE_IMPORT) {
         b_obj_string *module_name = AS_STRING(peek(vm, 0));
         b_obj_string *value_name = READ_STRING();
         b_value mod;
@@ -2305,129 +3413,223 @@ b_ptr_result run(b_vm *vm) {
           b_obj_module *module = AS_MODULE(mod);
           b_value value;
           if (table_get(&module->values, OBJ_VAL(value_name), &value)) {
-            table_set(vm, &vm->current_frame->closure->function->module->values, OBJ_VAL(value_name), value);
+            table_set(vm, &frame->closure->function->module->values, OBJ_VAL(value_name), value);
+            write_barrier_all(vm, &frame->closure->function->module->obj);
           } else {
-            runtime_error("module %s does not define '%s'", module->name, value_name->chars);
+            RUNTIME_ERROR("module %s does not define '%s'", module->name, value_name->chars);
           }
         } else{
-          runtime_error("module '%s' not found", module_name->chars);
+          RUNTIME_ERROR("module '%s' not found", module_name->chars);
         }
-        break;
+        DISPATCH();
       }
 
-      case OP_IMPORT_ALL: {
-        table_import_all(vm, &AS_CLOSURE(peek(vm, 0))->function->module->values, &vm->current_frame->closure->function->module->values);
-        break;
+      CASE(OP_IMPORT_ALL) {
+        table_import_all(vm, &AS_CLOSURE(peek(vm, 0))->function->module->values, &frame->closure->function->module->values);
+        write_barrier_all(vm, &frame->closure->function->module->obj);
+        DISPATCH();
       }
 
-      case OP_IMPORT_ALL_NATIVE: {
+      CASE(OP_IMPORT_ALL_NATIVE) {
         b_obj_string *name = AS_STRING(peek(vm, 0));
         b_value mod;
         if (table_get(&vm->modules, OBJ_VAL(name), &mod)) {
-          table_import_all(vm, &AS_MODULE(mod)->values, &vm->current_frame->closure->function->module->values);
+          table_import_all(vm, &AS_MODULE(mod)->values, &frame->closure->function->module->values);
+          write_barrier_all(vm, &frame->closure->function->module->obj);
         }
-        break;
+        DISPATCH();
       }
 
-      case OP_EJECT_IMPORT: {
+      CASE(OP_EJECT_IMPORT) {
         b_obj_func *function = AS_CLOSURE(READ_CONSTANT())->function;
-        table_delete(&vm->current_frame->closure->function->module->values, STRING_VAL(function->module->name));
-        break;
+        table_delete(&frame->closure->function->module->values, STRING_VAL(function->module->name));
+        DISPATCH();
       }
 
-      case OP_EJECT_NATIVE_IMPORT: {
+      CASE(OP_EJECT_NATIVE_IMPORT) {
         b_value mod;
         b_obj_string *name = READ_STRING();
         if (table_get(&vm->modules, OBJ_VAL(name), &mod)) {
-          table_import_all(vm, &AS_MODULE(mod)->values, &vm->current_frame->closure->function->module->values);
-          table_delete(&vm->current_frame->closure->function->module->values, OBJ_VAL(name));
+          table_import_all(vm, &AS_MODULE(mod)->values, &frame->closure->function->module->values);
+          write_barrier_all(vm, &frame->closure->function->module->obj);
+          table_delete(&frame->closure->function->module->values, OBJ_VAL(name));
         }
-        break;
+        DISPATCH();
       }
 
-      case OP_ASSERT: {
+      CASE(OP_ASSERT) {
         b_value message = pop(vm);
         b_value expression = pop(vm);
         if (is_false(expression)) {
+          STORE_FRAME();
           if (!IS_NIL(message)) {
             do_throw_exception(vm, true, value_to_string(vm, message)->chars);
           } else {
             do_throw_exception(vm, true, "");
           }
+          LOAD_FRAME();
         }
-        break;
+        DISPATCH();
       }
 
-      case OP_DIE: {
+      CASE(OP_DIE) {
         if (!IS_INSTANCE(peek(vm, 0)) ||
-            !is_instance_of(AS_INSTANCE(peek(vm, 0))->klass, vm->exception_class->name->chars)) {
-          runtime_error("instance of Exception expected");
+            !is_instance_of(AS_INSTANCE(peek(vm, 0))->klass, vm->exception_class)) {
+          RUNTIME_ERROR("instance of Exception expected");
           break;
         }
 
-        b_value stacktrace = get_stack_trace(vm);
-        b_obj_instance *instance = AS_INSTANCE(peek(vm, 0));
-        table_set(vm, &instance->properties, STRING_L_VAL("stacktrace", 10), stacktrace);
+        STORE_FRAME();
+        set_stack_trace(vm, AS_INSTANCE(peek(vm, 0)));
         if (propagate_exception(vm, false)) {
-          vm->current_frame = &vm->frames[vm->frame_count - 1];
+          LOAD_FRAME();
           break;
         }
 
         EXIT_VM();
       }
 
-      case OP_TRY: {
-        b_obj_string *type = READ_STRING();
-        uint16_t address = READ_SHORT();
-        uint16_t finally_address = READ_SHORT();
-
-        if (address != 0) {
-          b_value value;
-          if (!table_get(&vm->globals, OBJ_VAL(type), &value) || !IS_CLASS(value)) {
-            if(!table_get(&vm->current_frame->closure->function->module->values, OBJ_VAL(type), &value) || !IS_CLASS(value)) {
-              runtime_error("object of type '%s' is not an exception", type->chars);
-              break;
-            }
-          }
-          push_exception_handler(vm, AS_CLASS(value), address, finally_address);
-        } else {
-          push_exception_handler(vm, NULL, address, finally_address);
-        }
-        break;
-      }
-
-      case OP_POP_TRY: {
-        vm->current_frame->handlers_count--;
-        break;
-      }
-
-      case OP_PUBLISH_TRY: {
-        vm->current_frame->handlers_count--;
+      CASE(OP_PUBLISH_TRY) {
+        // the finally block is outside of its own try, so this goes on
+        // to the handlers around it.
+        STORE_FRAME();
         if (propagate_exception(vm, false)) {
-          vm->current_frame = &vm->frames[vm->frame_count - 1];
+          LOAD_FRAME();
           break;
         }
 
         EXIT_VM();
       }
 
-      case OP_SWITCH: {
+      CASE(OP_SWITCH) {
         b_obj_switch *sw = AS_SWITCH(READ_CONSTANT());
         b_value expr = peek(vm, 0);
 
         b_value value;
         if (table_get(&sw->table, expr, &value)) {
-          vm->current_frame->ip += (int) AS_NUMBER(value);
+          ip += (int) AS_NUMBER(value);
         } else if (sw->default_jump != -1) {
-          vm->current_frame->ip += sw->default_jump;
+          ip += sw->default_jump;
         } else {
-          vm->current_frame->ip += sw->exit_jump;
+          ip += sw->exit_jump;
         }
         pop(vm);
-        break;
+        DISPATCH();
+      }
+
+      CASE(OP_ADD_NUM) {
+        QUICK_ARITHMETIC_OP(add_numbers, OP_ADD);
+        DISPATCH();
+      }
+      CASE(OP_SUBTRACT_NUM) {
+        QUICK_ARITHMETIC_OP(subtract_numbers, OP_SUBTRACT);
+        DISPATCH();
+      }
+      CASE(OP_MULTIPLY_NUM) {
+        QUICK_ARITHMETIC_OP(multiply_numbers, OP_MULTIPLY);
+        DISPATCH();
+      }
+      CASE(OP_DIVIDE_NUM) {
+        QUICK_ARITHMETIC_OP(divide_numbers, OP_DIVIDE);
+        DISPATCH();
+      }
+      CASE(OP_GREATER_NUM) {
+        QUICK_BINARY_OP(BOOL_VAL, >, OP_GREATER);
+        DISPATCH();
+      }
+      CASE(OP_LESS_NUM) {
+        QUICK_BINARY_OP(BOOL_VAL, <, OP_LESS);
+        DISPATCH();
+      }
+
+      CASE(OP_GET_LOCALS) {
+        uint16_t first = READ_SHORT();
+        uint16_t second = READ_SHORT();
+        push(vm, frame->slots[first]);
+        push(vm, frame->slots[second]);
+        DISPATCH();
+      }
+      CASE(OP_GET_LOCAL_CONSTANT) {
+        uint16_t slot = READ_SHORT();
+        b_value constant = READ_CONSTANT();
+        push(vm, frame->slots[slot]);
+        push(vm, constant);
+        DISPATCH();
+      }
+      CASE(OP_SET_LOCAL_POP) {
+        uint16_t slot = READ_SHORT();
+        if(IS_EMPTY(peek(vm, 0))) {
+          RUNTIME_ERROR(ERR_CANT_ASSIGN_EMPTY);
+          break;
+        }
+        frame->slots[slot] = pop(vm);
+        DISPATCH();
+      }
+      CASE(OP_POP_JUMP_IF_FALSE) {
+        uint16_t offset = READ_SHORT();
+        if (is_false(pop(vm))) {
+          ip += offset;
+        }
+        DISPATCH();
+      }
+      CASE(OP_LESS_JUMP) {
+        COMPARE_JUMP(<);
+        DISPATCH();
+      }
+      CASE(OP_GREATER_JUMP) {
+        COMPARE_JUMP(>);
+        DISPATCH();
+      }
+      CASE(OP_INVOKE_LOCAL) {
+        uint16_t slot = READ_SHORT();
+        b_obj_string *method = READ_STRING();
+        int arg_count = READ_BYTE();
+        b_inline_cache *cache = READ_CACHE();
+        push(vm, frame->slots[slot]);
+        STORE_FRAME();
+        if (!invoke_cached(vm, method, arg_count, cache)) {
+          EXIT_VM();
+        }
+        LOAD_FRAME();
+        DISPATCH();
+      }
+
+      CASE(OP_REG_MOVE) {
+        uint16_t dst = READ_SHORT();
+        b_value value = READ_REGISTER();
+        uint16_t skip = READ_SHORT();
+        if (!IS_EMPTY(value)) {
+          frame->slots[dst] = value;
+          ip += skip;
+        }
+        DISPATCH();
+      }
+      CASE(OP_REG_ADD) {
+        REGISTER_BINARY_OP(add_numbers);
+        DISPATCH();
+      }
+      CASE(OP_REG_SUBTRACT) {
+        REGISTER_BINARY_OP(subtract_numbers);
+        DISPATCH();
+      }
+      CASE(OP_REG_MULTIPLY) {
+        REGISTER_BINARY_OP(multiply_numbers);
+        DISPATCH();
+      }
+      CASE(OP_REG_DIVIDE) {
+        REGISTER_BINARY_OP(divide_numbers);
+        DISPATCH();
+      }
+      CASE(OP_REG_LESS_JUMP) {
+        REGISTER_COMPARE_JUMP(<);
+        DISPATCH();
+      }
+      CASE(OP_REG_GREATER_JUMP) {
+        REGISTER_COMPARE_JUMP(>);
+        DISPATCH();
       }
 
-      case OP_CHOICE: {
+      CASE(OP_CHOICE) {
         b_value _else = peek(vm, 0);
         b_value _then = peek(vm, 1);
         b_value _condition = peek(vm, 2);
@@ -2438,22 +3640,90 @@ b_ptr_result run(b_vm *vm) {
         } else {
           push(vm, _else);
         }
-        break;
+        DISPATCH();
+      }
+
+      CASE(OP_ITER_PREP) {
+        // the key, the value and the cursor of a for-in loop.
+        push(vm, NIL_VAL);
+        push(vm, NIL_VAL);
+        push(vm, NIL_VAL);
+        DISPATCH();
+      }
+
+      CASE(OP_ITER_NEXT) {
+        ensure_stack(vm, 1);
+        b_value *state = frame->slots + READ_SHORT();
+        uint16_t body = READ_SHORT();
+        uint16_t exit = READ_SHORT();
+
+        switch (iterate(vm, state)) {
+          case ITER_CONTINUE:
+            ip += body;
+            break;
+          case ITER_DONE:
+            ip += exit;
+            break;
+          case ITER_INVOKE:
+            break;
+        }
+        DISPATCH();
+      }
+
+      CASE(OP_GET_ARGS) {
+        uint16_t slot = READ_SHORT();
+        if (IS_EMPTY(frame->slots[slot])) {
+          materialize_args(vm, frame);
+        }
+        push(vm, frame->slots[slot]);
+        DISPATCH();
+      }
+      CASE(OP_ARGS_LENGTH) {
+        uint16_t slot = READ_SHORT();
+        if (IS_EMPTY(frame->slots[slot])) {
+          push(vm, INTEGER_VAL(frame->va_count));
+        } else {
+          // __args__ was assigned something else.
+          push(vm, frame->slots[slot]);
+          STORE_FRAME();
+          if (!invoke(vm, copy_string(vm, "length", 6), 0)) {
+            EXIT_VM();
+          }
+          LOAD_FRAME();
+        }
+        DISPATCH();
       }
 
       default:
+#if USE_COMPUTED_GOTO && !(defined(DEBUG_STACK) && DEBUG_STACK)
+      code_default:
+#endif
         break;
     }
   }
 
+#undef STORE_FRAME
+#undef LOAD_FRAME
+#undef RUNTIME_ERROR
+#undef CASE
+#undef DISPATCH
 #undef READ_BYTE
 #undef READ_SHORT
 #undef READ_CONSTANT
 #undef READ_LCONSTANT
 #undef READ_STRING
+#undef READ_CACHE
 #undef READ_LSTRING
 #undef BINARY_OP
+#undef QUICKEN
+#undef QUICK_BINARY_OP
+#undef ARITHMETIC_OP
+#undef QUICK_ARITHMETIC_OP
+#undef COMPARE_JUMP
 #undef BINARY_MOD_OP
+#undef READ_REGISTER
+#undef REGISTER_BINARY_OP
+#undef REGISTER_COMPARE_JUMP
 }
 
 b_ptr_result interpret(b_vm *vm, b_obj_module *module, const char *source) {
@@ -2486,4 +3756,16 @@ b_ptr_result interpret(b_vm *vm, b_obj_module *module, const char *source) {
   return result;
 }
 
+b_ptr_result interpret_call(b_vm *vm, int arg_count) {
+  if (!call_value(vm, peek(vm, arg_count), arg_count)) {
+    return PTR_RUNTIME_ERR;
+  }
+
+  // natives are done by the time call_value returns.
+  if (vm->frame_count == 0) {
+    return PTR_OK;
+  }
+  return run(vm);
+}
+
 #undef ERR_CANT_ASSIGN_EMPTY
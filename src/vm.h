@@ -3,44 +3,55 @@
 
 typedef struct s_compiler b_compiler;
 
+#include "arena.h"
 #include "blob.h"
 #include "config.h"
 #include "object.h"
 #include "table.h"
 #include "value.h"
 
+#include <math.h>
+
 typedef enum {
   PTR_OK,
   PTR_COMPILE_ERR,
   PTR_RUNTIME_ERR,
 } b_ptr_result;
 
-typedef struct {
-  uint16_t address;
-  uint16_t finally_address;
-  b_obj_class *klass;
-} b_exception_frame;
-
-typedef struct {
+typedef struct b_call_frame {
   b_obj_closure *closure;
   uint8_t *ip;
   b_value *slots;
-  int handlers_count;
-  b_exception_frame handlers[MAX_EXCEPTION_HANDLERS];
+  // variadic arguments the call left on the stack right below slots.
+  // __args__ holds EMPTY until they are copied into a list.
+  int va_count;
 } b_call_frame;
 
+typedef enum {
+  GC_IDLE,
+  GC_MARK, // tracing from the roots a step at a time
+  GC_SWEEP, // freeing what the marking did not reach
+} b_gc_phase;
+
 struct s_vm {
-  b_call_frame frames[FRAMES_MAX];
+  b_call_frame *frames;
   b_call_frame *current_frame;
   int frame_count;
+  int frame_capacity;
 
   b_blob *blob;
   uint8_t *ip;
-  b_value stack[STACK_MAX];
+  b_value *stack;
   b_value *stack_top;
+  int stack_capacity;
   b_obj_up_value *open_up_values;
+  b_obj_fiber *fiber; // the running fiber, NULL on the main stack
 
-  b_obj *objects;
+  b_obj *objects; // old generation, bar the arena objects
+  // allocated since the last collection
+  int young_count;
+  int young_capacity;
+  b_obj **young;
   b_compiler *compiler;
   b_obj_class *exception_class;
   char *root_file;
@@ -49,9 +60,28 @@ struct s_vm {
   int gray_count;
   int gray_capacity;
   int gc_protected;
+  int gc_roots_capacity;
   b_obj **gray_stack;
+  b_obj **gc_roots; // objects native code asked to keep alive
   size_t bytes_allocated;
   size_t next_gc;
+  size_t next_minor_gc;
+  // young objects stored into old ones, and old objects filled in bulk,
+  // since the last collection
+  int remembered_count;
+  int remembered_capacity;
+  b_obj **remembered;
+  bool gc_minor; // a minor collection is marking
+  bool gc_busy;
+  // collections run in steps of gc_step_budget objects, or all at once
+  // when it is 0.
+  b_gc_phase gc_phase;
+  int gc_step_budget;
+  int gc_threads; // markers of a collection that pauses the program
+  bool gc_parallel; // they are marking
+  b_obj *sweep_previous;
+  b_obj *sweep_cursor;
+  b_arena arena; // small objects, swept a page at a time as they are needed
 
   // objects tracker
   b_table modules;
@@ -65,6 +95,7 @@ struct s_vm {
   b_table methods_file;
   b_table methods_bytes;
   b_table methods_range;
+  b_table methods_fiber;
 
   char **std_args;
   int std_args_count;
@@ -76,6 +107,9 @@ struct s_vm {
   bool show_warnings;
   bool should_print_bytecode;
   bool should_exit_after_bytecode;
+  bool should_optimize;
+  bool should_use_registers;
+  bool should_jit;
 
   // miscellaneous
 };
@@ -86,6 +120,31 @@ void free_vm(b_vm *vm);
 
 b_ptr_result interpret(b_vm *vm, b_obj_module *module, const char *source);
 
+// runs the callee sitting on the stack below its arguments to completion
+// on a vm that is not running anything.
+b_ptr_result interpret_call(b_vm *vm, int arg_count);
+
+void grow_stack(b_vm *vm, int needed);
+
+// makes sure the next needed values can be pushed without the stack moving.
+static inline void ensure_stack(b_vm *vm, int needed) {
+  if (vm->stack_top + needed > vm->stack + vm->stack_capacity) {
+    grow_stack(vm, needed);
+  }
+}
+
+b_call_frame *push_frame(b_vm *vm);
+
+// switches to the fiber under the arguments on top of the stack. they are
+// popped along with it and the call returns once the fiber yields or ends.
+void resume_fiber(b_vm *vm, b_obj_fiber *fiber, int arg_count);
+
+// switches back to whoever resumed the running fiber, popping the callee
+// and arguments of the yield call and handing them the value.
+void yield_fiber(b_vm *vm, b_value value, int arg_count);
+
+void grow_gc_roots(b_vm *vm);
+
 void push(b_vm *vm, b_value value);
 
 b_value pop(b_vm *vm);
@@ -95,21 +154,46 @@ b_value pop_n(b_vm *vm, int n);
 b_value peek(b_vm *vm, int distance);
 
 static inline void add_module(b_vm *vm, b_obj_module *module) {
-  table_set(vm, &vm->modules, STRING_VAL(module->file), OBJ_VAL(module));
+  push(vm, STRING_VAL(module->file)); // gc fix
+  table_set(vm, &vm->modules, peek(vm, 0), OBJ_VAL(module));
+  pop(vm);
+
+  push(vm, STRING_VAL(module->name)); // gc fix
   if (vm->frame_count == 0) {
-    table_set(vm, &vm->globals, STRING_VAL(module->name), OBJ_VAL(module));
+    table_set(vm, &vm->globals, peek(vm, 0), OBJ_VAL(module));
   } else {
     table_set(vm,
               &vm->current_frame->closure->function->module->values,
-              STRING_VAL(module->name), OBJ_VAL(module)
+              peek(vm, 0), OBJ_VAL(module)
     );
   }
+  pop(vm);
 }
 
 bool invoke_from_class(b_vm *vm, b_obj_class *klass, b_obj_string *name, int arg_count);
 
 bool is_false(b_value value);
 
+b_entry *find_global_entry(b_obj_module *module, uint16_t slot, b_obj_string *name);
+
+typedef enum {
+  ITER_CONTINUE, // the key and value of the next item are in place
+  ITER_DONE,     // there are no more items
+  ITER_INVOKE,   // not a built-in iterable, use its @itern and @iter methods
+} b_iter_result;
+
+// state points into the stack, so there must be room to push one more
+// value without the stack moving.
+b_iter_result iterate(b_vm *vm, b_value *state);
+
+// the text of an exception's stack trace is only put together the first
+// time 'stacktrace' is read. returns false for any other property.
+bool get_stack_trace_field(b_vm *vm, b_obj_instance *instance, b_obj_string *name, b_value *value);
+
+// true for the field that holds a trace until then. code that looks up or
+// lists fields by name leaves it out.
+bool is_hidden_field(b_value name);
+
 void dict_add_entry(b_vm *vm, b_obj_dict *dict, b_value key, b_value value);
 
 bool dict_get_entry(b_obj_dict *dict, b_value key, b_value *value);
@@ -119,7 +203,7 @@ bool dict_set_entry(b_vm *vm, b_obj_dict *dict, b_value key, b_value value);
 void define_native_method(b_vm *vm, b_table *table, const char *name,
                           b_native_fn function);
 
-bool is_instance_of(b_obj_class *klass1, char *klass2_name);
+bool is_instance_of(b_obj_class *klass1, b_obj_class *klass2);
 
 bool do_throw_exception(b_vm *vm, bool is_assert, const char *format, ...);
 
@@ -136,16 +220,30 @@ b_obj_instance *create_exception(b_vm *vm, b_obj_string *message);
 
 #define throw_exception(v, ...) do_throw_exception(v, false, ##__VA_ARGS__)
 
+static inline int floor_div(double a, double b) {
+  int d = (int) a / (int) b;
+  return d - ((d * b == a) & ((a < 0) ^ (b < 0)));
+}
+
+static inline double modulo(double a, double b) {
+  double r = fmod(a, b);
+  if (r!=0 && ((r<0) != (b<0))) {
+    r += b;
+  }
+  return r;
+}
+
+// protected objects are kept out of the value stack, so a native function
+// that creates many of them never causes the stack under its args to move.
 static inline b_obj *gc_protect(b_vm *vm, b_obj *object) {
-  push(vm, OBJ_VAL(object));
-  vm->gc_protected++;
+  if (vm->gc_protected == vm->gc_roots_capacity) {
+    grow_gc_roots(vm);
+  }
+  vm->gc_roots[vm->gc_protected++] = object;
   return object;
 }
 
 static inline void gc_clear_protection(b_vm *vm) {
-  if (vm->gc_protected > 0) {
-    vm->stack_top -= vm->gc_protected;
-  }
   vm->gc_protected = 0;
 }
 
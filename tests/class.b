@@ -76,6 +76,66 @@ class C < B {
 C().getClosure()()
 
 
+class Circle {
+  var r = 2
+  area() { return 3 * self.r * self.r }
+}
+
+class Square {
+  var side = 3
+  area() { return self.side * self.side }
+}
+
+def total_area(shapes) {
+  var total = 0
+  for shape in shapes {
+    total += shape.area()
+  }
+  return total
+}
+
+def no_area() { return 0 }
+
+var odd = Square()
+odd.area = no_area
+
+echo 'total area = ' + total_area([Circle(), Square(), Circle(), Square()])
+echo 'total area = ' + total_area([Circle(), odd, Square()])
+
+class Point {
+  Point(x, y) {
+    self.x = x
+    self.y = y
+  }
+}
+
+def describe(p) {
+  return '${p.x},${p.y}'
+}
+
+var p1 = Point(1, 2), p2 = Point(3, 4)
+p2.z = 5
+setprop(p1, 'z', 6)
+delprop(p2, 'x')
+echo 'points ${describe(p1)} ${p1.z} ${hasprop(p2, 'x')} ${getprop(p2, 'z')}'
+p2.x = 7
+echo 'points ${describe(p1)} ${describe(p2)}'
+
+# classes are told apart by identity, not by name.
+class Shape {}
+class Polygon < Shape {}
+class Square < Polygon {}
+
+def local_shape() {
+  class Shape {}
+  return Shape
+}
+
+var other = local_shape()
+var sq = Square()
+echo '${instance_of(sq, Shape)} ${instance_of(sq, Polygon)} ${instance_of(Polygon(), Square)} ${instance_of(sq, other)} ${instance_of(other(), Shape)}'
+
+
 class Animal {
   setName() {
     self._echo()
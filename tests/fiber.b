@@ -0,0 +1,48 @@
+def numbers(n) {
+  for i in 1..(n + 1) yield(i)
+}
+
+def squares(source) {
+  var n
+  while (n = source.resume()) != nil {
+    yield(n * n)
+  }
+}
+
+var source = fiber(|| { numbers(100) })
+var pipeline = fiber(squares)
+var total = 0, value = pipeline.resume(source)
+while value != nil {
+  total += value
+  value = pipeline.resume()
+}
+echo '${total} ${pipeline.is_done()}'
+
+var counters = []
+for i in 0..1000 {
+  var counter = fiber(|count| {
+    while true count += yield(count)
+  })
+  counter.resume(i)
+  counters.append(counter)
+}
+var sum = 0
+for counter in counters sum += counter.resume(1)
+echo sum
+
+var failing = fiber(|| {
+  yield('started')
+  die Exception('failed inside')
+})
+echo failing.resume()
+try {
+  failing.resume()
+} catch Exception e {
+  echo '${e.message} ${failing.is_done()}'
+}
+
+try {
+  failing.resume()
+} catch Exception e {
+  echo e.message
+}
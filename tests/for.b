@@ -44,3 +44,21 @@ class Iterable {
 for it in Iterable() {
   echo it
 }
+
+for c in 'añb€' {
+  echo c
+}
+
+var r = 3..0
+for x in r {
+  echo x
+}
+for i, x in r {
+  echo '${i}: ${x}'
+}
+
+var removal = {a: 1, b: 2, c: 3}
+for k, v in removal {
+  if k == 'a' removal.remove('b')
+  echo '${k} -> ${v}'
+}
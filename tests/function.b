@@ -35,3 +35,264 @@ def sin(n) {
 
 echo sin()
 echo 'Sin 10 = ${sin(10)}'
+
+def combine(a, b) {
+  return '${a + b} ${a - b} ${a * b} ${a < b}'
+}
+
+echo combine(6, 3)
+echo combine(true, 3)
+echo combine(6, 3)
+
+def join(a, b) {
+  return a + b
+}
+
+echo join(1, 2)
+echo join('a', 'b')
+echo join(1, 2)
+
+# calls in tail position reuse the caller's frame, so this never overflows
+def is_even(n) {
+  if n == 0 return true
+  return is_odd(n - 1)
+}
+
+def is_odd(n) {
+  if n == 0 return false
+  return is_even(n - 1)
+}
+
+echo is_even(100000)
+echo is_odd(7)
+
+# the stack grows with the calls instead of stopping at a fixed depth
+def depth(n) {
+  if n == 0 return 0
+  return depth(n - 1) + 1
+}
+
+echo depth(20000)
+
+# variadic arguments are read in place until __args__ is used as a list
+def variadic(first, ...) {
+  return '${__args__.length()} ${__args__[0]} ${__args__[-1]}'
+}
+def pass_on(...) { return __args__ }
+def count_on(n, ...) {
+  if n == 0 return __args__.length()
+  return count_on(n - 1, n)
+}
+echo variadic(1, 2, 3, 4)
+echo pass_on(5, 6)
+echo count_on(3, 1, 2, 3)
+
+# the constants a function gains after a collection during its compilation
+# must outlive the ones that follow it.
+def constants() {
+  var total = 0
+  total += 's00000'.length() + 's00001'.length() + 's00002'.length() + 's00003'.length() + 's00004'.length() + 's00005'.length() + 's00006'.length() + 's00007'.length() + 's00008'.length() + 's00009'.length()
+  total += 's00010'.length() + 's00011'.length() + 's00012'.length() + 's00013'.length() + 's00014'.length() + 's00015'.length() + 's00016'.length() + 's00017'.length() + 's00018'.length() + 's00019'.length()
+  total += 's00020'.length() + 's00021'.length() + 's00022'.length() + 's00023'.length() + 's00024'.length() + 's00025'.length() + 's00026'.length() + 's00027'.length() + 's00028'.length() + 's00029'.length()
+  total += 's00030'.length() + 's00031'.length() + 's00032'.length() + 's00033'.length() + 's00034'.length() + 's00035'.length() + 's00036'.length() + 's00037'.length() + 's00038'.length() + 's00039'.length()
+  total += 's00040'.length() + 's00041'.length() + 's00042'.length() + 's00043'.length() + 's00044'.length() + 's00045'.length() + 's00046'.length() + 's00047'.length() + 's00048'.length() + 's00049'.length()
+  total += 's00050'.length() + 's00051'.length() + 's00052'.length() + 's00053'.length() + 's00054'.length() + 's00055'.length() + 's00056'.length() + 's00057'.length() + 's00058'.length() + 's00059'.length()
+  total += 's00060'.length() + 's00061'.length() + 's00062'.length() + 's00063'.length() + 's00064'.length() + 's00065'.length() + 's00066'.length() + 's00067'.length() + 's00068'.length() + 's00069'.length()
+  total += 's00070'.length() + 's00071'.length() + 's00072'.length() + 's00073'.length() + 's00074'.length() + 's00075'.length() + 's00076'.length() + 's00077'.length() + 's00078'.length() + 's00079'.length()
+  total += 's00080'.length() + 's00081'.length() + 's00082'.length() + 's00083'.length() + 's00084'.length() + 's00085'.length() + 's00086'.length() + 's00087'.length() + 's00088'.length() + 's00089'.length()
+  total += 's00090'.length() + 's00091'.length() + 's00092'.length() + 's00093'.length() + 's00094'.length() + 's00095'.length() + 's00096'.length() + 's00097'.length() + 's00098'.length() + 's00099'.length()
+  total += 's00100'.length() + 's00101'.length() + 's00102'.length() + 's00103'.length() + 's00104'.length() + 's00105'.length() + 's00106'.length() + 's00107'.length() + 's00108'.length() + 's00109'.length()
+  total += 's00110'.length() + 's00111'.length() + 's00112'.length() + 's00113'.length() + 's00114'.length() + 's00115'.length() + 's00116'.length() + 's00117'.length() + 's00118'.length() + 's00119'.length()
+  total += 's00120'.length() + 's00121'.length() + 's00122'.length() + 's00123'.length() + 's00124'.length() + 's00125'.length() + 's00126'.length() + 's00127'.length() + 's00128'.length() + 's00129'.length()
+  total += 's00130'.length() + 's00131'.length() + 's00132'.length() + 's00133'.length() + 's00134'.length() + 's00135'.length() + 's00136'.length() + 's00137'.length() + 's00138'.length() + 's00139'.length()
+  total += 's00140'.length() + 's00141'.length() + 's00142'.length() + 's00143'.length() + 's00144'.length() + 's00145'.length() + 's00146'.length() + 's00147'.length() + 's00148'.length() + 's00149'.length()
+  total += 's00150'.length() + 's00151'.length() + 's00152'.length() + 's00153'.length() + 's00154'.length() + 's00155'.length() + 's00156'.length() + 's00157'.length() + 's00158'.length() + 's00159'.length()
+  total += 's00160'.length() + 's00161'.length() + 's00162'.length() + 's00163'.length() + 's00164'.length() + 's00165'.length() + 's00166'.length() + 's00167'.length() + 's00168'.length() + 's00169'.length()
+  total += 's00170'.length() + 's00171'.length() + 's00172'.length() + 's00173'.length() + 's00174'.length() + 's00175'.length() + 's00176'.length() + 's00177'.length() + 's00178'.length() + 's00179'.length()
+  total += 's00180'.length() + 's00181'.length() + 's00182'.length() + 's00183'.length() + 's00184'.length() + 's00185'.length() + 's00186'.length() + 's00187'.length() + 's00188'.length() + 's00189'.length()
+  total += 's00190'.length() + 's00191'.length() + 's00192'.length() + 's00193'.length() + 's00194'.length() + 's00195'.length() + 's00196'.length() + 's00197'.length() + 's00198'.length() + 's00199'.length()
+  total += 's00200'.length() + 's00201'.length() + 's00202'.length() + 's00203'.length() + 's00204'.length() + 's00205'.length() + 's00206'.length() + 's00207'.length() + 's00208'.length() + 's00209'.length()
+  total += 's00210'.length() + 's00211'.length() + 's00212'.length() + 's00213'.length() + 's00214'.length() + 's00215'.length() + 's00216'.length() + 's00217'.length() + 's00218'.length() + 's00219'.length()
+  total += 's00220'.length() + 's00221'.length() + 's00222'.length() + 's00223'.length() + 's00224'.length() + 's00225'.length() + 's00226'.length() + 's00227'.length() + 's00228'.length() + 's00229'.length()
+  total += 's00230'.length() + 's00231'.length() + 's00232'.length() + 's00233'.length() + 's00234'.length() + 's00235'.length() + 's00236'.length() + 's00237'.length() + 's00238'.length() + 's00239'.length()
+  total += 's00240'.length() + 's00241'.length() + 's00242'.length() + 's00243'.length() + 's00244'.length() + 's00245'.length() + 's00246'.length() + 's00247'.length() + 's00248'.length() + 's00249'.length()
+  total += 's00250'.length() + 's00251'.length() + 's00252'.length() + 's00253'.length() + 's00254'.length() + 's00255'.length() + 's00256'.length() + 's00257'.length() + 's00258'.length() + 's00259'.length()
+  total += 's00260'.length() + 's00261'.length() + 's00262'.length() + 's00263'.length() + 's00264'.length() + 's00265'.length() + 's00266'.length() + 's00267'.length() + 's00268'.length() + 's00269'.length()
+  total += 's00270'.length() + 's00271'.length() + 's00272'.length() + 's00273'.length() + 's00274'.length() + 's00275'.length() + 's00276'.length() + 's00277'.length() + 's00278'.length() + 's00279'.length()
+  total += 's00280'.length() + 's00281'.length() + 's00282'.length() + 's00283'.length() + 's00284'.length() + 's00285'.length() + 's00286'.length() + 's00287'.length() + 's00288'.length() + 's00289'.length()
+  total += 's00290'.length() + 's00291'.length() + 's00292'.length() + 's00293'.length() + 's00294'.length() + 's00295'.length() + 's00296'.length() + 's00297'.length() + 's00298'.length() + 's00299'.length()
+  total += 's00300'.length() + 's00301'.length() + 's00302'.length() + 's00303'.length() + 's00304'.length() + 's00305'.length() + 's00306'.length() + 's00307'.length() + 's00308'.length() + 's00309'.length()
+  total += 's00310'.length() + 's00311'.length() + 's00312'.length() + 's00313'.length() + 's00314'.length() + 's00315'.length() + 's00316'.length() + 's00317'.length() + 's00318'.length() + 's00319'.length()
+  total += 's00320'.length() + 's00321'.length() + 's00322'.length() + 's00323'.length() + 's00324'.length() + 's00325'.length() + 's00326'.length() + 's00327'.length() + 's00328'.length() + 's00329'.length()
+  total += 's00330'.length() + 's00331'.length() + 's00332'.length() + 's00333'.length() + 's00334'.length() + 's00335'.length() + 's00336'.length() + 's00337'.length() + 's00338'.length() + 's00339'.length()
+  total += 's00340'.length() + 's00341'.length() + 's00342'.length() + 's00343'.length() + 's00344'.length() + 's00345'.length() + 's00346'.length() + 's00347'.length() + 's00348'.length() + 's00349'.length()
+  total += 's00350'.length() + 's00351'.length() + 's00352'.length() + 's00353'.length() + 's00354'.length() + 's00355'.length() + 's00356'.length() + 's00357'.length() + 's00358'.length() + 's00359'.length()
+  total += 's00360'.length() + 's00361'.length() + 's00362'.length() + 's00363'.length() + 's00364'.length() + 's00365'.length() + 's00366'.length() + 's00367'.length() + 's00368'.length() + 's00369'.length()
+  total += 's00370'.length() + 's00371'.length() + 's00372'.length() + 's00373'.length() + 's00374'.length() + 's00375'.length() + 's00376'.length() + 's00377'.length() + 's00378'.length() + 's00379'.length()
+  total += 's00380'.length() + 's00381'.length() + 's00382'.length() + 's00383'.length() + 's00384'.length() + 's00385'.length() + 's00386'.length() + 's00387'.length() + 's00388'.length() + 's00389'.length()
+  total += 's00390'.length() + 's00391'.length() + 's00392'.length() + 's00393'.length() + 's00394'.length() + 's00395'.length() + 's00396'.length() + 's00397'.length() + 's00398'.length() + 's00399'.length()
+  total += 's00400'.length() + 's00401'.length() + 's00402'.length() + 's00403'.length() + 's00404'.length() + 's00405'.length() + 's00406'.length() + 's00407'.length() + 's00408'.length() + 's00409'.length()
+  total += 's00410'.length() + 's00411'.length() + 's00412'.length() + 's00413'.length() + 's00414'.length() + 's00415'.length() + 's00416'.length() + 's00417'.length() + 's00418'.length() + 's00419'.length()
+  total += 's00420'.length() + 's00421'.length() + 's00422'.length() + 's00423'.length() + 's00424'.length() + 's00425'.length() + 's00426'.length() + 's00427'.length() + 's00428'.length() + 's00429'.length()
+  total += 's00430'.length() + 's00431'.length() + 's00432'.length() + 's00433'.length() + 's00434'.length() + 's00435'.length() + 's00436'.length() + 's00437'.length() + 's00438'.length() + 's00439'.length()
+  total += 's00440'.length() + 's00441'.length() + 's00442'.length() + 's00443'.length() + 's00444'.length() + 's00445'.length() + 's00446'.length() + 's00447'.length() + 's00448'.length() + 's00449'.length()
+  total += 's00450'.length() + 's00451'.length() + 's00452'.length() + 's00453'.length() + 's00454'.length() + 's00455'.length() + 's00456'.length() + 's00457'.length() + 's00458'.length() + 's00459'.length()
+  total += 's00460'.length() + 's00461'.length() + 's00462'.length() + 's00463'.length() + 's00464'.length() + 's00465'.length() + 's00466'.length() + 's00467'.length() + 's00468'.length() + 's00469'.length()
+  total += 's00470'.length() + 's00471'.length() + 's00472'.length() + 's00473'.length() + 's00474'.length() + 's00475'.length() + 's00476'.length() + 's00477'.length() + 's00478'.length() + 's00479'.length()
+  total += 's00480'.length() + 's00481'.length() + 's00482'.length() + 's00483'.length() + 's00484'.length() + 's00485'.length() + 's00486'.length() + 's00487'.length() + 's00488'.length() + 's00489'.length()
+  total += 's00490'.length() + 's00491'.length() + 's00492'.length() + 's00493'.length() + 's00494'.length() + 's00495'.length() + 's00496'.length() + 's00497'.length() + 's00498'.length() + 's00499'.length()
+  total += 's00500'.length() + 's00501'.length() + 's00502'.length() + 's00503'.length() + 's00504'.length() + 's00505'.length() + 's00506'.length() + 's00507'.length() + 's00508'.length() + 's00509'.length()
+  total += 's00510'.length() + 's00511'.length() + 's00512'.length() + 's00513'.length() + 's00514'.length() + 's00515'.length() + 's00516'.length() + 's00517'.length() + 's00518'.length() + 's00519'.length()
+  total += 's00520'.length() + 's00521'.length() + 's00522'.length() + 's00523'.length() + 's00524'.length() + 's00525'.length() + 's00526'.length() + 's00527'.length() + 's00528'.length() + 's00529'.length()
+  total += 's00530'.length() + 's00531'.length() + 's00532'.length() + 's00533'.length() + 's00534'.length() + 's00535'.length() + 's00536'.length() + 's00537'.length() + 's00538'.length() + 's00539'.length()
+  total += 's00540'.length() + 's00541'.length() + 's00542'.length() + 's00543'.length() + 's00544'.length() + 's00545'.length() + 's00546'.length() + 's00547'.length() + 's00548'.length() + 's00549'.length()
+  total += 's00550'.length() + 's00551'.length() + 's00552'.length() + 's00553'.length() + 's00554'.length() + 's00555'.length() + 's00556'.length() + 's00557'.length() + 's00558'.length() + 's00559'.length()
+  total += 's00560'.length() + 's00561'.length() + 's00562'.length() + 's00563'.length() + 's00564'.length() + 's00565'.length() + 's00566'.length() + 's00567'.length() + 's00568'.length() + 's00569'.length()
+  total += 's00570'.length() + 's00571'.length() + 's00572'.length() + 's00573'.length() + 's00574'.length() + 's00575'.length() + 's00576'.length() + 's00577'.length() + 's00578'.length() + 's00579'.length()
+  total += 's00580'.length() + 's00581'.length() + 's00582'.length() + 's00583'.length() + 's00584'.length() + 's00585'.length() + 's00586'.length() + 's00587'.length() + 's00588'.length() + 's00589'.length()
+  total += 's00590'.length() + 's00591'.length() + 's00592'.length() + 's00593'.length() + 's00594'.length() + 's00595'.length() + 's00596'.length() + 's00597'.length() + 's00598'.length() + 's00599'.length()
+  total += 's00600'.length() + 's00601'.length() + 's00602'.length() + 's00603'.length() + 's00604'.length() + 's00605'.length() + 's00606'.length() + 's00607'.length() + 's00608'.length() + 's00609'.length()
+  total += 's00610'.length() + 's00611'.length() + 's00612'.length() + 's00613'.length() + 's00614'.length() + 's00615'.length() + 's00616'.length() + 's00617'.length() + 's00618'.length() + 's00619'.length()
+  total += 's00620'.length() + 's00621'.length() + 's00622'.length() + 's00623'.length() + 's00624'.length() + 's00625'.length() + 's00626'.length() + 's00627'.length() + 's00628'.length() + 's00629'.length()
+  total += 's00630'.length() + 's00631'.length() + 's00632'.length() + 's00633'.length() + 's00634'.length() + 's00635'.length() + 's00636'.length() + 's00637'.length() + 's00638'.length() + 's00639'.length()
+  total += 's00640'.length() + 's00641'.length() + 's00642'.length() + 's00643'.length() + 's00644'.length() + 's00645'.length() + 's00646'.length() + 's00647'.length() + 's00648'.length() + 's00649'.length()
+  total += 's00650'.length() + 's00651'.length() + 's00652'.length() + 's00653'.length() + 's00654'.length() + 's00655'.length() + 's00656'.length() + 's00657'.length() + 's00658'.length() + 's00659'.length()
+  total += 's00660'.length() + 's00661'.length() + 's00662'.length() + 's00663'.length() + 's00664'.length() + 's00665'.length() + 's00666'.length() + 's00667'.length() + 's00668'.length() + 's00669'.length()
+  total += 's00670'.length() + 's00671'.length() + 's00672'.length() + 's00673'.length() + 's00674'.length() + 's00675'.length() + 's00676'.length() + 's00677'.length() + 's00678'.length() + 's00679'.length()
+  total += 's00680'.length() + 's00681'.length() + 's00682'.length() + 's00683'.length() + 's00684'.length() + 's00685'.length() + 's00686'.length() + 's00687'.length() + 's00688'.length() + 's00689'.length()
+  total += 's00690'.length() + 's00691'.length() + 's00692'.length() + 's00693'.length() + 's00694'.length() + 's00695'.length() + 's00696'.length() + 's00697'.length() + 's00698'.length() + 's00699'.length()
+  total += 's00700'.length() + 's00701'.length() + 's00702'.length() + 's00703'.length() + 's00704'.length() + 's00705'.length() + 's00706'.length() + 's00707'.length() + 's00708'.length() + 's00709'.length()
+  total += 's00710'.length() + 's00711'.length() + 's00712'.length() + 's00713'.length() + 's00714'.length() + 's00715'.length() + 's00716'.length() + 's00717'.length() + 's00718'.length() + 's00719'.length()
+  total += 's00720'.length() + 's00721'.length() + 's00722'.length() + 's00723'.length() + 's00724'.length() + 's00725'.length() + 's00726'.length() + 's00727'.length() + 's00728'.length() + 's00729'.length()
+  total += 's00730'.length() + 's00731'.length() + 's00732'.length() + 's00733'.length() + 's00734'.length() + 's00735'.length() + 's00736'.length() + 's00737'.length() + 's00738'.length() + 's00739'.length()
+  total += 's00740'.length() + 's00741'.length() + 's00742'.length() + 's00743'.length() + 's00744'.length() + 's00745'.length() + 's00746'.length() + 's00747'.length() + 's00748'.length() + 's00749'.length()
+  total += 's00750'.length() + 's00751'.length() + 's00752'.length() + 's00753'.length() + 's00754'.length() + 's00755'.length() + 's00756'.length() + 's00757'.length() + 's00758'.length() + 's00759'.length()
+  total += 's00760'.length() + 's00761'.length() + 's00762'.length() + 's00763'.length() + 's00764'.length() + 's00765'.length() + 's00766'.length() + 's00767'.length() + 's00768'.length() + 's00769'.length()
+  total += 's00770'.length() + 's00771'.length() + 's00772'.length() + 's00773'.length() + 's00774'.length() + 's00775'.length() + 's00776'.length() + 's00777'.length() + 's00778'.length() + 's00779'.length()
+  total += 's00780'.length() + 's00781'.length() + 's00782'.length() + 's00783'.length() + 's00784'.length() + 's00785'.length() + 's00786'.length() + 's00787'.length() + 's00788'.length() + 's00789'.length()
+  total += 's00790'.length() + 's00791'.length() + 's00792'.length() + 's00793'.length() + 's00794'.length() + 's00795'.length() + 's00796'.length() + 's00797'.length() + 's00798'.length() + 's00799'.length()
+  total += 's00800'.length() + 's00801'.length() + 's00802'.length() + 's00803'.length() + 's00804'.length() + 's00805'.length() + 's00806'.length() + 's00807'.length() + 's00808'.length() + 's00809'.length()
+  total += 's00810'.length() + 's00811'.length() + 's00812'.length() + 's00813'.length() + 's00814'.length() + 's00815'.length() + 's00816'.length() + 's00817'.length() + 's00818'.length() + 's00819'.length()
+  total += 's00820'.length() + 's00821'.length() + 's00822'.length() + 's00823'.length() + 's00824'.length() + 's00825'.length() + 's00826'.length() + 's00827'.length() + 's00828'.length() + 's00829'.length()
+  total += 's00830'.length() + 's00831'.length() + 's00832'.length() + 's00833'.length() + 's00834'.length() + 's00835'.length() + 's00836'.length() + 's00837'.length() + 's00838'.length() + 's00839'.length()
+  total += 's00840'.length() + 's00841'.length() + 's00842'.length() + 's00843'.length() + 's00844'.length() + 's00845'.length() + 's00846'.length() + 's00847'.length() + 's00848'.length() + 's00849'.length()
+  total += 's00850'.length() + 's00851'.length() + 's00852'.length() + 's00853'.length() + 's00854'.length() + 's00855'.length() + 's00856'.length() + 's00857'.length() + 's00858'.length() + 's00859'.length()
+  total += 's00860'.length() + 's00861'.length() + 's00862'.length() + 's00863'.length() + 's00864'.length() + 's00865'.length() + 's00866'.length() + 's00867'.length() + 's00868'.length() + 's00869'.length()
+  total += 's00870'.length() + 's00871'.length() + 's00872'.length() + 's00873'.length() + 's00874'.length() + 's00875'.length() + 's00876'.length() + 's00877'.length() + 's00878'.length() + 's00879'.length()
+  total += 's00880'.length() + 's00881'.length() + 's00882'.length() + 's00883'.length() + 's00884'.length() + 's00885'.length() + 's00886'.length() + 's00887'.length() + 's00888'.length() + 's00889'.length()
+  total += 's00890'.length() + 's00891'.length() + 's00892'.length() + 's00893'.length() + 's00894'.length() + 's00895'.length() + 's00896'.length() + 's00897'.length() + 's00898'.length() + 's00899'.length()
+  total += 's00900'.length() + 's00901'.length() + 's00902'.length() + 's00903'.length() + 's00904'.length() + 's00905'.length() + 's00906'.length() + 's00907'.length() + 's00908'.length() + 's00909'.length()
+  total += 's00910'.length() + 's00911'.length() + 's00912'.length() + 's00913'.length() + 's00914'.length() + 's00915'.length() + 's00916'.length() + 's00917'.length() + 's00918'.length() + 's00919'.length()
+  total += 's00920'.length() + 's00921'.length() + 's00922'.length() + 's00923'.length() + 's00924'.length() + 's00925'.length() + 's00926'.length() + 's00927'.length() + 's00928'.length() + 's00929'.length()
+  total += 's00930'.length() + 's00931'.length() + 's00932'.length() + 's00933'.length() + 's00934'.length() + 's00935'.length() + 's00936'.length() + 's00937'.length() + 's00938'.length() + 's00939'.length()
+  total += 's00940'.length() + 's00941'.length() + 's00942'.length() + 's00943'.length() + 's00944'.length() + 's00945'.length() + 's00946'.length() + 's00947'.length() + 's00948'.length() + 's00949'.length()
+  total += 's00950'.length() + 's00951'.length() + 's00952'.length() + 's00953'.length() + 's00954'.length() + 's00955'.length() + 's00956'.length() + 's00957'.length() + 's00958'.length() + 's00959'.length()
+  total += 's00960'.length() + 's00961'.length() + 's00962'.length() + 's00963'.length() + 's00964'.length() + 's00965'.length() + 's00966'.length() + 's00967'.length() + 's00968'.length() + 's00969'.length()
+  total += 's00970'.length() + 's00971'.length() + 's00972'.length() + 's00973'.length() + 's00974'.length() + 's00975'.length() + 's00976'.length() + 's00977'.length() + 's00978'.length() + 's00979'.length()
+  total += 's00980'.length() + 's00981'.length() + 's00982'.length() + 's00983'.length() + 's00984'.length() + 's00985'.length() + 's00986'.length() + 's00987'.length() + 's00988'.length() + 's00989'.length()
+  total += 's00990'.length() + 's00991'.length() + 's00992'.length() + 's00993'.length() + 's00994'.length() + 's00995'.length() + 's00996'.length() + 's00997'.length() + 's00998'.length() + 's00999'.length()
+  total += 's01000'.length() + 's01001'.length() + 's01002'.length() + 's01003'.length() + 's01004'.length() + 's01005'.length() + 's01006'.length() + 's01007'.length() + 's01008'.length() + 's01009'.length()
+  total += 's01010'.length() + 's01011'.length() + 's01012'.length() + 's01013'.length() + 's01014'.length() + 's01015'.length() + 's01016'.length() + 's01017'.length() + 's01018'.length() + 's01019'.length()
+  total += 's01020'.length() + 's01021'.length() + 's01022'.length() + 's01023'.length() + 's01024'.length() + 's01025'.length() + 's01026'.length() + 's01027'.length() + 's01028'.length() + 's01029'.length()
+  total += 's01030'.length() + 's01031'.length() + 's01032'.length() + 's01033'.length() + 's01034'.length() + 's01035'.length() + 's01036'.length() + 's01037'.length() + 's01038'.length() + 's01039'.length()
+  total += 's01040'.length() + 's01041'.length() + 's01042'.length() + 's01043'.length() + 's01044'.length() + 's01045'.length() + 's01046'.length() + 's01047'.length() + 's01048'.length() + 's01049'.length()
+  total += 's01050'.length() + 's01051'.length() + 's01052'.length() + 's01053'.length() + 's01054'.length() + 's01055'.length() + 's01056'.length() + 's01057'.length() + 's01058'.length() + 's01059'.length()
+  total += 's01060'.length() + 's01061'.length() + 's01062'.length() + 's01063'.length() + 's01064'.length() + 's01065'.length() + 's01066'.length() + 's01067'.length() + 's01068'.length() + 's01069'.length()
+  total += 's01070'.length() + 's01071'.length() + 's01072'.length() + 's01073'.length() + 's01074'.length() + 's01075'.length() + 's01076'.length() + 's01077'.length() + 's01078'.length() + 's01079'.length()
+  total += 's01080'.length() + 's01081'.length() + 's01082'.length() + 's01083'.length() + 's01084'.length() + 's01085'.length() + 's01086'.length() + 's01087'.length() + 's01088'.length() + 's01089'.length()
+  total += 's01090'.length() + 's01091'.length() + 's01092'.length() + 's01093'.length() + 's01094'.length() + 's01095'.length() + 's01096'.length() + 's01097'.length() + 's01098'.length() + 's01099'.length()
+  total += 's01100'.length() + 's01101'.length() + 's01102'.length() + 's01103'.length() + 's01104'.length() + 's01105'.length() + 's01106'.length() + 's01107'.length() + 's01108'.length() + 's01109'.length()
+  total += 's01110'.length() + 's01111'.length() + 's01112'.length() + 's01113'.length() + 's01114'.length() + 's01115'.length() + 's01116'.length() + 's01117'.length() + 's01118'.length() + 's01119'.length()
+  total += 's01120'.length() + 's01121'.length() + 's01122'.length() + 's01123'.length() + 's01124'.length() + 's01125'.length() + 's01126'.length() + 's01127'.length() + 's01128'.length() + 's01129'.length()
+  total += 's01130'.length() + 's01131'.length() + 's01132'.length() + 's01133'.length() + 's01134'.length() + 's01135'.length() + 's01136'.length() + 's01137'.length() + 's01138'.length() + 's01139'.length()
+  total += 's01140'.length() + 's01141'.length() + 's01142'.length() + 's01143'.length() + 's01144'.length() + 's01145'.length() + 's01146'.length() + 's01147'.length() + 's01148'.length() + 's01149'.length()
+  total += 's01150'.length() + 's01151'.length() + 's01152'.length() + 's01153'.length() + 's01154'.length() + 's01155'.length() + 's01156'.length() + 's01157'.length() + 's01158'.length() + 's01159'.length()
+  total += 's01160'.length() + 's01161'.length() + 's01162'.length() + 's01163'.length() + 's01164'.length() + 's01165'.length() + 's01166'.length() + 's01167'.length() + 's01168'.length() + 's01169'.length()
+  total += 's01170'.length() + 's01171'.length() + 's01172'.length() + 's01173'.length() + 's01174'.length() + 's01175'.length() + 's01176'.length() + 's01177'.length() + 's01178'.length() + 's01179'.length()
+  total += 's01180'.length() + 's01181'.length() + 's01182'.length() + 's01183'.length() + 's01184'.length() + 's01185'.length() + 's01186'.length() + 's01187'.length() + 's01188'.length() + 's01189'.length()
+  total += 's01190'.length() + 's01191'.length() + 's01192'.length() + 's01193'.length() + 's01194'.length() + 's01195'.length() + 's01196'.length() + 's01197'.length() + 's01198'.length() + 's01199'.length()
+  total += 's01200'.length() + 's01201'.length() + 's01202'.length() + 's01203'.length() + 's01204'.length() + 's01205'.length() + 's01206'.length() + 's01207'.length() + 's01208'.length() + 's01209'.length()
+  total += 's01210'.length() + 's01211'.length() + 's01212'.length() + 's01213'.length() + 's01214'.length() + 's01215'.length() + 's01216'.length() + 's01217'.length() + 's01218'.length() + 's01219'.length()
+  total += 's01220'.length() + 's01221'.length() + 's01222'.length() + 's01223'.length() + 's01224'.length() + 's01225'.length() + 's01226'.length() + 's01227'.length() + 's01228'.length() + 's01229'.length()
+  total += 's01230'.length() + 's01231'.length() + 's01232'.length() + 's01233'.length() + 's01234'.length() + 's01235'.length() + 's01236'.length() + 's01237'.length() + 's01238'.length() + 's01239'.length()
+  total += 's01240'.length() + 's01241'.length() + 's01242'.length() + 's01243'.length() + 's01244'.length() + 's01245'.length() + 's01246'.length() + 's01247'.length() + 's01248'.length() + 's01249'.length()
+  total += 's01250'.length() + 's01251'.length() + 's01252'.length() + 's01253'.length() + 's01254'.length() + 's01255'.length() + 's01256'.length() + 's01257'.length() + 's01258'.length() + 's01259'.length()
+  total += 's01260'.length() + 's01261'.length() + 's01262'.length() + 's01263'.length() + 's01264'.length() + 's01265'.length() + 's01266'.length() + 's01267'.length() + 's01268'.length() + 's01269'.length()
+  total += 's01270'.length() + 's01271'.length() + 's01272'.length() + 's01273'.length() + 's01274'.length() + 's01275'.length() + 's01276'.length() + 's01277'.length() + 's01278'.length() + 's01279'.length()
+  total += 's01280'.length() + 's01281'.length() + 's01282'.length() + 's01283'.length() + 's01284'.length() + 's01285'.length() + 's01286'.length() + 's01287'.length() + 's01288'.length() + 's01289'.length()
+  total += 's01290'.length() + 's01291'.length() + 's01292'.length() + 's01293'.length() + 's01294'.length() + 's01295'.length() + 's01296'.length() + 's01297'.length() + 's01298'.length() + 's01299'.length()
+  total += 's01300'.length() + 's01301'.length() + 's01302'.length() + 's01303'.length() + 's01304'.length() + 's01305'.length() + 's01306'.length() + 's01307'.length() + 's01308'.length() + 's01309'.length()
+  total += 's01310'.length() + 's01311'.length() + 's01312'.length() + 's01313'.length() + 's01314'.length() + 's01315'.length() + 's01316'.length() + 's01317'.length() + 's01318'.length() + 's01319'.length()
+  total += 's01320'.length() + 's01321'.length() + 's01322'.length() + 's01323'.length() + 's01324'.length() + 's01325'.length() + 's01326'.length() + 's01327'.length() + 's01328'.length() + 's01329'.length()
+  total += 's01330'.length() + 's01331'.length() + 's01332'.length() + 's01333'.length() + 's01334'.length() + 's01335'.length() + 's01336'.length() + 's01337'.length() + 's01338'.length() + 's01339'.length()
+  total += 's01340'.length() + 's01341'.length() + 's01342'.length() + 's01343'.length() + 's01344'.length() + 's01345'.length() + 's01346'.length() + 's01347'.length() + 's01348'.length() + 's01349'.length()
+  total += 's01350'.length() + 's01351'.length() + 's01352'.length() + 's01353'.length() + 's01354'.length() + 's01355'.length() + 's01356'.length() + 's01357'.length() + 's01358'.length() + 's01359'.length()
+  total += 's01360'.length() + 's01361'.length() + 's01362'.length() + 's01363'.length() + 's01364'.length() + 's01365'.length() + 's01366'.length() + 's01367'.length() + 's01368'.length() + 's01369'.length()
+  total += 's01370'.length() + 's01371'.length() + 's01372'.length() + 's01373'.length() + 's01374'.length() + 's01375'.length() + 's01376'.length() + 's01377'.length() + 's01378'.length() + 's01379'.length()
+  total += 's01380'.length() + 's01381'.length() + 's01382'.length() + 's01383'.length() + 's01384'.length() + 's01385'.length() + 's01386'.length() + 's01387'.length() + 's01388'.length() + 's01389'.length()
+  total += 's01390'.length() + 's01391'.length() + 's01392'.length() + 's01393'.length() + 's01394'.length() + 's01395'.length() + 's01396'.length() + 's01397'.length() + 's01398'.length() + 's01399'.length()
+  total += 's01400'.length() + 's01401'.length() + 's01402'.length() + 's01403'.length() + 's01404'.length() + 's01405'.length() + 's01406'.length() + 's01407'.length() + 's01408'.length() + 's01409'.length()
+  total += 's01410'.length() + 's01411'.length() + 's01412'.length() + 's01413'.length() + 's01414'.length() + 's01415'.length() + 's01416'.length() + 's01417'.length() + 's01418'.length() + 's01419'.length()
+  total += 's01420'.length() + 's01421'.length() + 's01422'.length() + 's01423'.length() + 's01424'.length() + 's01425'.length() + 's01426'.length() + 's01427'.length() + 's01428'.length() + 's01429'.length()
+  total += 's01430'.length() + 's01431'.length() + 's01432'.length() + 's01433'.length() + 's01434'.length() + 's01435'.length() + 's01436'.length() + 's01437'.length() + 's01438'.length() + 's01439'.length()
+  total += 's01440'.length() + 's01441'.length() + 's01442'.length() + 's01443'.length() + 's01444'.length() + 's01445'.length() + 's01446'.length() + 's01447'.length() + 's01448'.length() + 's01449'.length()
+  total += 's01450'.length() + 's01451'.length() + 's01452'.length() + 's01453'.length() + 's01454'.length() + 's01455'.length() + 's01456'.length() + 's01457'.length() + 's01458'.length() + 's01459'.length()
+  total += 's01460'.length() + 's01461'.length() + 's01462'.length() + 's01463'.length() + 's01464'.length() + 's01465'.length() + 's01466'.length() + 's01467'.length() + 's01468'.length() + 's01469'.length()
+  total += 's01470'.length() + 's01471'.length() + 's01472'.length() + 's01473'.length() + 's01474'.length() + 's01475'.length() + 's01476'.length() + 's01477'.length() + 's01478'.length() + 's01479'.length()
+  total += 's01480'.length() + 's01481'.length() + 's01482'.length() + 's01483'.length() + 's01484'.length() + 's01485'.length() + 's01486'.length() + 's01487'.length() + 's01488'.length() + 's01489'.length()
+  total += 's01490'.length() + 's01491'.length() + 's01492'.length() + 's01493'.length() + 's01494'.length() + 's01495'.length() + 's01496'.length() + 's01497'.length() + 's01498'.length() + 's01499'.length()
+  total += 's01500'.length() + 's01501'.length() + 's01502'.length() + 's01503'.length() + 's01504'.length() + 's01505'.length() + 's01506'.length() + 's01507'.length() + 's01508'.length() + 's01509'.length()
+  total += 's01510'.length() + 's01511'.length() + 's01512'.length() + 's01513'.length() + 's01514'.length() + 's01515'.length() + 's01516'.length() + 's01517'.length() + 's01518'.length() + 's01519'.length()
+  total += 's01520'.length() + 's01521'.length() + 's01522'.length() + 's01523'.length() + 's01524'.length() + 's01525'.length() + 's01526'.length() + 's01527'.length() + 's01528'.length() + 's01529'.length()
+  total += 's01530'.length() + 's01531'.length() + 's01532'.length() + 's01533'.length() + 's01534'.length() + 's01535'.length() + 's01536'.length() + 's01537'.length() + 's01538'.length() + 's01539'.length()
+  total += 's01540'.length() + 's01541'.length() + 's01542'.length() + 's01543'.length() + 's01544'.length() + 's01545'.length() + 's01546'.length() + 's01547'.length() + 's01548'.length() + 's01549'.length()
+  total += 's01550'.length() + 's01551'.length() + 's01552'.length() + 's01553'.length() + 's01554'.length() + 's01555'.length() + 's01556'.length() + 's01557'.length() + 's01558'.length() + 's01559'.length()
+  total += 's01560'.length() + 's01561'.length() + 's01562'.length() + 's01563'.length() + 's01564'.length() + 's01565'.length() + 's01566'.length() + 's01567'.length() + 's01568'.length() + 's01569'.length()
+  total += 's01570'.length() + 's01571'.length() + 's01572'.length() + 's01573'.length() + 's01574'.length() + 's01575'.length() + 's01576'.length() + 's01577'.length() + 's01578'.length() + 's01579'.length()
+  total += 's01580'.length() + 's01581'.length() + 's01582'.length() + 's01583'.length() + 's01584'.length() + 's01585'.length() + 's01586'.length() + 's01587'.length() + 's01588'.length() + 's01589'.length()
+  total += 's01590'.length() + 's01591'.length() + 's01592'.length() + 's01593'.length() + 's01594'.length() + 's01595'.length() + 's01596'.length() + 's01597'.length() + 's01598'.length() + 's01599'.length()
+  total += 's01600'.length() + 's01601'.length() + 's01602'.length() + 's01603'.length() + 's01604'.length() + 's01605'.length() + 's01606'.length() + 's01607'.length() + 's01608'.length() + 's01609'.length()
+  total += 's01610'.length() + 's01611'.length() + 's01612'.length() + 's01613'.length() + 's01614'.length() + 's01615'.length() + 's01616'.length() + 's01617'.length() + 's01618'.length() + 's01619'.length()
+  total += 's01620'.length() + 's01621'.length() + 's01622'.length() + 's01623'.length() + 's01624'.length() + 's01625'.length() + 's01626'.length() + 's01627'.length() + 's01628'.length() + 's01629'.length()
+  total += 's01630'.length() + 's01631'.length() + 's01632'.length() + 's01633'.length() + 's01634'.length() + 's01635'.length() + 's01636'.length() + 's01637'.length() + 's01638'.length() + 's01639'.length()
+  total += 's01640'.length() + 's01641'.length() + 's01642'.length() + 's01643'.length() + 's01644'.length() + 's01645'.length() + 's01646'.length() + 's01647'.length() + 's01648'.length() + 's01649'.length()
+  total += 's01650'.length() + 's01651'.length() + 's01652'.length() + 's01653'.length() + 's01654'.length() + 's01655'.length() + 's01656'.length() + 's01657'.length() + 's01658'.length() + 's01659'.length()
+  total += 's01660'.length() + 's01661'.length() + 's01662'.length() + 's01663'.length() + 's01664'.length() + 's01665'.length() + 's01666'.length() + 's01667'.length() + 's01668'.length() + 's01669'.length()
+  total += 's01670'.length() + 's01671'.length() + 's01672'.length() + 's01673'.length() + 's01674'.length() + 's01675'.length() + 's01676'.length() + 's01677'.length() + 's01678'.length() + 's01679'.length()
+  total += 's01680'.length() + 's01681'.length() + 's01682'.length() + 's01683'.length() + 's01684'.length() + 's01685'.length() + 's01686'.length() + 's01687'.length() + 's01688'.length() + 's01689'.length()
+  total += 's01690'.length() + 's01691'.length() + 's01692'.length() + 's01693'.length() + 's01694'.length() + 's01695'.length() + 's01696'.length() + 's01697'.length() + 's01698'.length() + 's01699'.length()
+  total += 's01700'.length() + 's01701'.length() + 's01702'.length() + 's01703'.length() + 's01704'.length() + 's01705'.length() + 's01706'.length() + 's01707'.length() + 's01708'.length() + 's01709'.length()
+  total += 's01710'.length() + 's01711'.length() + 's01712'.length() + 's01713'.length() + 's01714'.length() + 's01715'.length() + 's01716'.length() + 's01717'.length() + 's01718'.length() + 's01719'.length()
+  total += 's01720'.length() + 's01721'.length() + 's01722'.length() + 's01723'.length() + 's01724'.length() + 's01725'.length() + 's01726'.length() + 's01727'.length() + 's01728'.length() + 's01729'.length()
+  total += 's01730'.length() + 's01731'.length() + 's01732'.length() + 's01733'.length() + 's01734'.length() + 's01735'.length() + 's01736'.length() + 's01737'.length() + 's01738'.length() + 's01739'.length()
+  total += 's01740'.length() + 's01741'.length() + 's01742'.length() + 's01743'.length() + 's01744'.length() + 's01745'.length() + 's01746'.length() + 's01747'.length() + 's01748'.length() + 's01749'.length()
+  total += 's01750'.length() + 's01751'.length() + 's01752'.length() + 's01753'.length() + 's01754'.length() + 's01755'.length() + 's01756'.length() + 's01757'.length() + 's01758'.length() + 's01759'.length()
+  total += 's01760'.length() + 's01761'.length() + 's01762'.length() + 's01763'.length() + 's01764'.length() + 's01765'.length() + 's01766'.length() + 's01767'.length() + 's01768'.length() + 's01769'.length()
+  total += 's01770'.length() + 's01771'.length() + 's01772'.length() + 's01773'.length() + 's01774'.length() + 's01775'.length() + 's01776'.length() + 's01777'.length() + 's01778'.length() + 's01779'.length()
+  total += 's01780'.length() + 's01781'.length() + 's01782'.length() + 's01783'.length() + 's01784'.length() + 's01785'.length() + 's01786'.length() + 's01787'.length() + 's01788'.length() + 's01789'.length()
+  total += 's01790'.length() + 's01791'.length() + 's01792'.length() + 's01793'.length() + 's01794'.length() + 's01795'.length() + 's01796'.length() + 's01797'.length() + 's01798'.length() + 's01799'.length()
+  total += 's01800'.length() + 's01801'.length() + 's01802'.length() + 's01803'.length() + 's01804'.length() + 's01805'.length() + 's01806'.length() + 's01807'.length() + 's01808'.length() + 's01809'.length()
+  total += 's01810'.length() + 's01811'.length() + 's01812'.length() + 's01813'.length() + 's01814'.length() + 's01815'.length() + 's01816'.length() + 's01817'.length() + 's01818'.length() + 's01819'.length()
+  total += 's01820'.length() + 's01821'.length() + 's01822'.length() + 's01823'.length() + 's01824'.length() + 's01825'.length() + 's01826'.length() + 's01827'.length() + 's01828'.length() + 's01829'.length()
+  total += 's01830'.length() + 's01831'.length() + 's01832'.length() + 's01833'.length() + 's01834'.length() + 's01835'.length() + 's01836'.length() + 's01837'.length() + 's01838'.length() + 's01839'.length()
+  total += 's01840'.length() + 's01841'.length() + 's01842'.length() + 's01843'.length() + 's01844'.length() + 's01845'.length() + 's01846'.length() + 's01847'.length() + 's01848'.length() + 's01849'.length()
+  total += 's01850'.length() + 's01851'.length() + 's01852'.length() + 's01853'.length() + 's01854'.length() + 's01855'.length() + 's01856'.length() + 's01857'.length() + 's01858'.length() + 's01859'.length()
+  total += 's01860'.length() + 's01861'.length() + 's01862'.length() + 's01863'.length() + 's01864'.length() + 's01865'.length() + 's01866'.length() + 's01867'.length() + 's01868'.length() + 's01869'.length()
+  total += 's01870'.length() + 's01871'.length() + 's01872'.length() + 's01873'.length() + 's01874'.length() + 's01875'.length() + 's01876'.length() + 's01877'.length() + 's01878'.length() + 's01879'.length()
+  total += 's01880'.length() + 's01881'.length() + 's01882'.length() + 's01883'.length() + 's01884'.length() + 's01885'.length() + 's01886'.length() + 's01887'.length() + 's01888'.length() + 's01889'.length()
+  total += 's01890'.length() + 's01891'.length() + 's01892'.length() + 's01893'.length() + 's01894'.length() + 's01895'.length() + 's01896'.length() + 's01897'.length() + 's01898'.length() + 's01899'.length()
+  total += 's01900'.length() + 's01901'.length() + 's01902'.length() + 's01903'.length() + 's01904'.length() + 's01905'.length() + 's01906'.length() + 's01907'.length() + 's01908'.length() + 's01909'.length()
+  total += 's01910'.length() + 's01911'.length() + 's01912'.length() + 's01913'.length() + 's01914'.length() + 's01915'.length() + 's01916'.length() + 's01917'.length() + 's01918'.length() + 's01919'.length()
+  total += 's01920'.length() + 's01921'.length() + 's01922'.length() + 's01923'.length() + 's01924'.length() + 's01925'.length() + 's01926'.length() + 's01927'.length() + 's01928'.length() + 's01929'.length()
+  total += 's01930'.length() + 's01931'.length() + 's01932'.length() + 's01933'.length() + 's01934'.length() + 's01935'.length() + 's01936'.length() + 's01937'.length() + 's01938'.length() + 's01939'.length()
+  total += 's01940'.length() + 's01941'.length() + 's01942'.length() + 's01943'.length() + 's01944'.length() + 's01945'.length() + 's01946'.length() + 's01947'.length() + 's01948'.length() + 's01949'.length()
+  total += 's01950'.length() + 's01951'.length() + 's01952'.length() + 's01953'.length() + 's01954'.length() + 's01955'.length() + 's01956'.length() + 's01957'.length() + 's01958'.length() + 's01959'.length()
+  total += 's01960'.length() + 's01961'.length() + 's01962'.length() + 's01963'.length() + 's01964'.length() + 's01965'.length() + 's01966'.length() + 's01967'.length() + 's01968'.length() + 's01969'.length()
+  total += 's01970'.length() + 's01971'.length() + 's01972'.length() + 's01973'.length() + 's01974'.length() + 's01975'.length() + 's01976'.length() + 's01977'.length() + 's01978'.length() + 's01979'.length()
+  total += 's01980'.length() + 's01981'.length() + 's01982'.length() + 's01983'.length() + 's01984'.length() + 's01985'.length() + 's01986'.length() + 's01987'.length() + 's01988'.length() + 's01989'.length()
+  total += 's01990'.length() + 's01991'.length() + 's01992'.length() + 's01993'.length() + 's01994'.length() + 's01995'.length() + 's01996'.length() + 's01997'.length() + 's01998'.length() + 's01999'.length()
+  return total
+}
+var garbage = []
+for i in 0..200000 garbage.append([i])
+echo constants()
@@ -0,0 +1,38 @@
+# values handed to objects that already survived a collection must live
+# through the collections after it.
+class Box {}
+
+def make_counter() {
+  var last
+  return |i| {
+    last = 'item ${i}'
+    return last
+  }
+}
+
+var keep = [], lookup = {}, box = Box(), counter = make_counter(), last
+for i in 0..200000 {
+  var item = [i, 'item ${i}']
+  if i % 1000 == 0 {
+    keep.append(item)
+    lookup['k${i}'] = item
+    box.last = item
+  }
+  last = counter(i)
+}
+
+var total = 0
+for item in keep total += item[0]
+echo '${keep.length()} ${total} ${lookup["k199000"][1]} ${box.last[1]} ${last}'
+
+# strings the collector dropped from the intern table must not hide the
+# live ones after them.
+var records = {}
+for i in 0..50000 {
+  records['k${i}'] = [i, 'v${i}', {a: i}]
+}
+var sum = 0
+for i in 0..50000 {
+  sum += records['k${i}'][0]
+}
+echo sum
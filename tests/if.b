@@ -16,3 +16,16 @@ if 1 > 5 {
 if 1 > 5 or 2 < 5 echo 'Ok'
 
 if 1 > 5 and 2 < 5 { echo 'Ok 2' } else { echo 'No' }
+
+
+def sign(n) {
+  if n > 0 {
+    return 'positive'
+    echo 'never printed'
+  }
+  while false echo 'never looped'
+  return 'not positive'
+}
+var MAX = 2 ** 8 - 1
+if false echo 'debug'
+else echo '${MAX} ${"ab" + "cd"} ${-(3 // 2)} ${!""} ${sign(1)} ${sign(-1)}'
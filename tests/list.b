@@ -29,3 +29,10 @@ var list2 = [
 
 echo list2[0][2]++
 echo list2
+
+# one call site seeing different kinds of receivers
+var sizes = []
+for value in ['text', [1, 2], {a: 1}, bytes(3), 'x', [1, 2, 3]] {
+  sizes.append(value.length())
+}
+echo sizes
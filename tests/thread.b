@@ -0,0 +1,52 @@
+import thread
+
+def square(jobs, results) {
+  var job
+  while (job = jobs.receive()) != nil {
+    results.send([job, job * job])
+  }
+}
+
+var Channel = thread.Channel
+class Mailbox < Channel {}
+
+def reply(channel, value) {
+  channel.send(value)
+}
+
+if thread.is_main {
+  var jobs = thread.Channel(), results = thread.Channel()
+  var workers = []
+  for i in 0..3 {
+    var worker = thread.Thread(square, jobs, results)
+    worker.start()
+    workers.append(worker)
+  }
+
+  for i in 1..101 jobs.send(i)
+  jobs.close()
+
+  var total = 0
+  for i in 1..101 total += results.receive()[1]
+  var joined = true
+  for worker in workers joined = joined and worker.join()
+  echo '${total} ${joined}'
+
+  # values are copied into the other thread and back
+  var back = thread.Channel()
+  var t = thread.Thread(reply, back, {a: [1, 2.5, 'x'], b: nil, c: 140737488355328})
+  t.start()
+  echo back.receive()
+  t.join()
+
+  try {
+    back.send(@() {})
+  } catch Exception e {
+    echo e.message
+  }
+
+  # subclasses of Channel are channels too
+  var mailbox = Mailbox()
+  mailbox.send('mail')
+  echo mailbox.receive()
+}
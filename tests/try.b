@@ -36,6 +36,69 @@ def run() {
 }
 run()
 
+# handlers are looked up from where the exception was thrown, so the
+# caller's try still sees it after calls, loops and returns.
+class Odd < Exception {
+  Odd(n) {
+    parent('odd ${n}')
+  }
+}
+
+def check(n) {
+  if n % 2 == 1 die Odd(n)
+  return n
+}
+
+def first_odd(list) {
+  try {
+    check(list[0])
+    return first_odd(list[1,])
+  } catch Odd e {
+    return e.message
+  }
+}
+
+var caught = 0
+for i in 0..1000 {
+  try {
+    try {
+      check(i)
+    } finally {
+      caught = caught + 1
+    }
+  } catch Exception e {
+    caught = caught + 1000
+  }
+}
+echo '\n${first_odd([2, 4, 7, 8])} ${caught}'
+
+# the trace is kept from where the exception was thrown until it is read,
+# and a rethrow records the new place.
+def fail() {
+  die Exception('failed')
+}
+
+var failure
+try {
+  fail()
+} catch Exception e {
+  failure = e
+}
+var first_trace = failure.stacktrace
+try {
+  die failure
+} catch Exception e {
+  echo '${first_trace.count("fail()")} ${e.stacktrace.count("fail()")} ${e.stacktrace.count("@.script")}'
+}
+
+# the frames kept for a trace are not a field of the exception
+import reflect
+try {
+  fail()
+} catch Exception e {
+  echo '${reflect.has_prop(e, " trace ")} ${reflect.get_prop(e, " trace ") == nil} ${reflect.get_class_metadata(Exception).properties}'
+}
+
 try {
   echo '\nTry block called'
 } finally {
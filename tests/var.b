@@ -6,3 +6,18 @@ echo b
 
 var c = true
 echo c
+
+var total = 0
+def add(n) {
+  total += n
+}
+for i in 0..5 {
+  add(i)
+}
+var total = total * 2
+echo 'total is ${total}'
+
+# whole numbers stay exact and overflow into doubles
+var big = 140737488355327
+var names = {1: 'one'}
+echo '${big + 1} ${big * 2} ${-big - 2} ${0 * -1} ${1 == 1.0} ${names[1.0]} ${7 / 2}'
@@ -12,3 +12,14 @@ while x >= 0 {
   echo 'x = ${x}'
   x = x - 1
 }
+
+def count_up(n) {
+  var s = 0, i = 0
+  while i < n {
+    if i == n / 2 s = s + ' text'
+    else s = s + 1
+    i = i + 1
+  }
+  return s
+}
+echo count_up(3000).length()